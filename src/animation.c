@@ -8,6 +8,7 @@
 #include "animation.h"
 
 #include "audio/sound.h"
+#include "gamecontext.h"
 #include "map.h"
 #include "sprites.h"
 #include "structure.h"
@@ -15,22 +16,8 @@
 #include "timer.h"
 #include "tools.h"
 
-enum {
-	ANIMATION_MAX = 112
-};
-
-typedef struct Animation {
-	uint32 tickNext;                        /*!< Which tick this Animation should be called again. */
-	uint16 tileLayout;                      /*!< Tile layout of the Animation. */
-	uint8 houseID;                          /*!< House of the item being animated. */
-	uint8 current;                          /*!< At which command we currently are in the Animation. */
-	uint8 iconGroup;                        /*!< Which iconGroup the sprites of the Animation belongs. */
-	const AnimationCommandStruct *commands; /*!< List of commands for this Animation. */
-	CellStruct tile;                            /*!< Top-left tile of Animation. */
-} Animation;
-
-static Animation g_animations[ANIMATION_MAX];
-static uint32 s_animationTimer; /*!< Timer for animations. */
+#define g_animations     (g_gameContext->animations)
+#define s_animationTimer (g_gameContext->animationTimer)
 
 /**
  * Stop with this Animation.
@@ -116,11 +116,11 @@ static bool Drivers_SoundMusic_Init(bool enable)
 #endif
 	memcpy(music, sound, sizeof(Driver));
 
-#if defined(_WIN32)
+#if !defined(TOS)
 	MPU_StartThread(1000000 / 120);
 #else
 	Timer_Add(MPU_Interrupt, 1000000 / 120, false);
-#endif
+#endif /* TOS */
 
 	size = MPU_GetDataSize();
 
@@ -268,15 +268,16 @@ void Driver_Voice_Play(const uint8 *data, int16 priority)
 
 	if (priority < l_currentPriority) return;
 
-	Driver_Voice_Stop();
-
-	if (data == NULL) return;
+	if (data == NULL) {
+		Driver_Voice_Stop();
+		return;
+	}
 
 	l_currentPriority = priority;
 
-	if (data == NULL) return;
-
-	DSP_Play(data);
+	/* Depending on the DSP, the new voice either replaces the playing voice
+	 *  or is mixed with it */
+	DSP_Play(data, priority);
 }
 
 void Driver_Voice_Stop(void)
@@ -376,11 +377,11 @@ static void Drivers_SoundMusic_Uninit(void)
 			buffer->index = 0xFFFF;
 		}
 
-#if defined(_WIN32)
+#if !defined(TOS)
 		MPU_StopThread();
 #else
 		Timer_Remove(MPU_Interrupt);
-#endif
+#endif /* TOS */
 
 		free(buffer->buffer);
 		buffer->buffer = NULL;
@@ -439,6 +440,10 @@ void Driver_LoadFile(const char *musicName, Driver *driver)
 void Driver_UnloadFile(Driver *driver)
 {
 	if (driver->contentMalloced) {
+#if !defined(TOS)
+		/* The sequencer thread may still be playing from it */
+		MPU_Sync();
+#endif /* TOS */
 		free(driver->content);
 	}
 
@@ -75,12 +75,14 @@ bool DSP_Init(void)
 	return true;
 }
 
-void DSP_Play(const uint8 *data)
+void DSP_Play(const uint8 *data, int16 priority)
 {
 	uint32 len;
 	uint32 freq;
 	snd_pcm_hw_params_t *dspParams = NULL;
 
+	VARIABLE_NOT_USED(priority);
+
 	DSP_Stop();
 
 	data += READ_LE_UINT16(data + 20);	/* skip Create Voice File header */
@@ -90,12 +90,14 @@ static uint32 DSP_ConvertAudio(uint32 freq, const uint8 * src, uint32 len)
 	return newlen;
 }
 
-void DSP_Play(const uint8 *data)
+void DSP_Play(const uint8 *data, int16 priority)
 {
 	uint32 len;
 	uint32 freq;
 	uint32 sampleLen;
 
+	VARIABLE_NOT_USED(priority);
+
 	/* skip Create Voice File header */
 	data += READ_LE_UINT16(data + 20);
 
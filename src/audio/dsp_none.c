@@ -18,9 +18,10 @@ bool DSP_Init(void)
 	return false;
 }
 
-void DSP_Play(const uint8 *data)
+void DSP_Play(const uint8 *data, int16 priority)
 {
 	VARIABLE_NOT_USED(data);
+	VARIABLE_NOT_USED(priority);
 }
 
 uint8 DSP_GetStatus(void)
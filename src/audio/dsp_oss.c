@@ -61,13 +61,15 @@ bool DSP_Init(void)
 	return true;
 }
 
-void DSP_Play(const uint8 *data)
+void DSP_Play(const uint8 *data, int16 priority)
 {
 	int i;
 	uint32 len;
 	int freq;
 	ssize_t n;
 
+	VARIABLE_NOT_USED(priority);
+
 	DSP_Stop();
 
 	data += READ_LE_UINT16(data + 20);	/* skip Create Voice File header */
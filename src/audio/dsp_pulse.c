@@ -209,7 +209,7 @@ void DSP_Uninit(void)
 	s_mainloop = NULL;
 }
 
-void DSP_Play(const uint8 *data)
+void DSP_Play(const uint8 *data, int16 priority)
 {
 	/*pa_sample_spec sample_spec;
 	pa_stream * stream;*/
@@ -217,6 +217,8 @@ void DSP_Play(const uint8 *data)
 	uint32 len;
 	/*pa_buffer_attr attr;*/
 
+	VARIABLE_NOT_USED(priority);
+
 	data += READ_LE_UINT16(data + 20);	/* Skip VOC header */
 
 	if (data[0] != 1) return;	/* if not a Sound Data block, return */
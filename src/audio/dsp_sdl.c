@@ -1,63 +1,260 @@
 /** @file src/audio/dsp_sdl.c SDL implementation of the DSP. */
 
-#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 #include <SDL.h>
 #include "types.h"
 #include "../os/endian.h"
 
 #include "dsp.h"
 
+#define DSP_CHANNELS 8                                      /*!< Amount of samples which can play at the same time. */
+#define DSP_QUEUE_SIZE 16                                   /*!< Size of the queue to the audio callback; must be a power of 2. */
+#define DSP_SAMPLES_MAX 32                                  /*!< Maximum amount of samples not freed yet; must be a power of 2. */
 
-static uint8 *s_buffer;
-static uint32 s_bufferLen;
-static uint8 s_status;
-static uint8 *s_data;
-static uint32 s_dataLen;
+/**
+ * In Dune2, the frequency of the VOC files are all over the place. SDL really
+ *  dislikes it when we close/open the audio driver a lot. So, the mixer
+ *  converts all samples to one frequency while mixing them.
+ */
+typedef struct DSPSample {
+	uint32 length;                                          /*!< Amount of 8 bit unsigned samples, directly following this header. */
+	uint32 step;                                            /*!< Step through the samples per sample played, as 16.16 fixed point. */
+	int16 priority;                                         /*!< Priority of the sample, as given to Driver_Voice_Play(). */
+} DSPSample;
+
+#define DSP_SAMPLE_DATA(sample) ((const uint8 *)((sample) + 1))
+
+/**
+ * A channel of the mixer. Only used by the audio callback.
+ */
+typedef struct DSPChannel {
+	DSPSample *sample;                                      /*!< The sample playing, or NULL if the channel is free. */
+	uint32 position;                                        /*!< Position in the sample. */
+	uint32 fraction;                                        /*!< Fraction of the position, as 16 bit fixed point. */
+	uint32 started;                                         /*!< When the sample started, to find the oldest sample. */
+	int16 priority;                                         /*!< Priority of the sample playing. */
+} DSPChannel;
+
+/**
+ * A queue with a single writer and a single reader, which need no lock. The
+ *  writer only changes head, the reader only changes tail.
+ */
+typedef struct DSPQueue {
+	DSPSample *volatile *items;                             /*!< The items. */
+	uint32 size;                                            /*!< Amount of items; a power of 2. */
+	volatile uint32 head;                                   /*!< Amount of items ever written. */
+	volatile uint32 tail;                                   /*!< Amount of items ever read. */
+} DSPQueue;
+
+#if defined(SDL_MemoryBarrierRelease)
+	#define DSP_MemoryBarrierRelease() SDL_MemoryBarrierRelease()
+	#define DSP_MemoryBarrierAcquire() SDL_MemoryBarrierAcquire()
+#else
+	/* SDL 1.2 has no memory barriers; volatile is all we have */
+	#define DSP_MemoryBarrierRelease()
+	#define DSP_MemoryBarrierAcquire()
+#endif /* SDL_MemoryBarrierRelease */
+
+static DSPSample *volatile s_commandItems[DSP_QUEUE_SIZE];
+static DSPSample *volatile s_finishedItems[DSP_SAMPLES_MAX];
+static DSPQueue s_commands = { s_commandItems, DSP_QUEUE_SIZE, 0, 0 };   /*!< Samples to play, from the game to the audio callback. */
+static DSPQueue s_finished = { s_finishedItems, DSP_SAMPLES_MAX, 0, 0 }; /*!< Samples done playing, from the audio callback to the game to free. */
+
+static DSPChannel s_channels[DSP_CHANNELS];
+static volatile uint8 s_channelsActive = 0;                 /*!< Amount of channels playing, as seen by the audio callback. */
+static uint32 s_channelsStarted = 0;
+static volatile uint32 s_stopHead = 0;                      /*!< Head of the command queue at the last DSP_Stop(); all commands before it are dropped. */
+static uint32 s_stopHandled = 0;                            /*!< Value of s_stopHead the audio callback handled last. */
+static uint16 s_samplesCount = 0;                           /*!< Amount of samples allocated and not freed yet. */
+static bool s_init = false;
 
 static SDL_AudioSpec s_spec;
 
+static bool DSP_Queue_Push(DSPQueue *queue, DSPSample *item)
+{
+	uint32 head = queue->head;
+
+	if (head - queue->tail == queue->size) return false;
+
+	queue->items[head & (queue->size - 1)] = item;
+	DSP_MemoryBarrierRelease();
+	queue->head = head + 1;
+	return true;
+}
+
+static bool DSP_Queue_Pop(DSPQueue *queue, DSPSample **item)
+{
+	uint32 tail = queue->tail;
+
+	if (queue->head == tail) return false;
+	DSP_MemoryBarrierAcquire();
+
+	*item = queue->items[tail & (queue->size - 1)];
+	DSP_MemoryBarrierRelease();
+	queue->tail = tail + 1;
+	return true;
+}
+
+/**
+ * Hand a sample back to the game, to be freed.
+ */
+static void DSP_Channel_Free(DSPChannel *channel)
+{
+	/* As there are never more than DSP_SAMPLES_MAX samples, this cannot fail */
+	DSP_Queue_Push(&s_finished, channel->sample);
+	channel->sample = NULL;
+}
+
+/**
+ * Start playing a sample on a free channel, or else on the channel with the
+ *  lowest priority; of those, the one which plays the longest already. When
+ *  all channels play a sample with a higher priority, the sample is dropped.
+ */
+static void DSP_Channel_Start(DSPSample *sample)
+{
+	DSPChannel *channel = NULL;
+	uint8 i;
+
+	for (i = 0; i < DSP_CHANNELS; i++) {
+		DSPChannel *c = &s_channels[i];
+
+		if (c->sample == NULL) {
+			channel = c;
+			break;
+		}
+		if (channel == NULL || c->priority < channel->priority || (c->priority == channel->priority && c->started < channel->started)) channel = c;
+	}
+
+	if (channel->sample != NULL) {
+		if (channel->priority > sample->priority) {
+			/* As there are never more than DSP_SAMPLES_MAX samples, this cannot fail */
+			DSP_Queue_Push(&s_finished, sample);
+			return;
+		}
+		DSP_Channel_Free(channel);
+	}
+
+	channel->sample   = sample;
+	channel->position = 0;
+	channel->fraction = 0;
+	channel->started  = s_channelsStarted++;
+	channel->priority = sample->priority;
+}
+
 static void DSP_Callback(void *userdata, Uint8 *stream, int len)
 {
+	uint32 stopHead = s_stopHead;
+	uint32 tail = s_commands.tail;
+	uint32 head = s_commands.head;
+	uint8 active = 0;
+	int i;
+
 	VARIABLE_NOT_USED(userdata);
 
-	if (s_status == 0 || s_bufferLen == 0 || s_buffer == NULL) {
-		/* no more sample to play : */
-		memset(stream, 0x80, len);	/* fill buffer with silence */
-		SDL_PauseAudio(1);	/* stop playback */
-		return;
+	DSP_MemoryBarrierAcquire();
+
+	if (stopHead != s_stopHandled) {
+		for (i = 0; i < DSP_CHANNELS; i++) {
+			if (s_channels[i].sample != NULL) DSP_Channel_Free(&s_channels[i]);
+		}
+		s_stopHandled = stopHead;
+	}
+
+	for (; tail != head; tail++) {
+		DSPSample *sample = s_commands.items[tail & (s_commands.size - 1)];
+
+		/* Samples queued before the last stop are never started */
+		if ((int32)(stopHead - tail) > 0) {
+			DSP_Queue_Push(&s_finished, sample);
+			continue;
+		}
+
+		DSP_Channel_Start(sample);
+	}
+
+	/* Mix around silence, which is 0x80 */
+	for (i = 0; i < len; i++) stream[i] = 0x80;
+
+	for (i = 0; i < DSP_CHANNELS; i++) {
+		DSPChannel *c = &s_channels[i];
+		const uint8 *data;
+		int j;
+
+		if (c->sample == NULL) continue;
+
+		data = DSP_SAMPLE_DATA(c->sample);
+		for (j = 0; j < len && c->position < c->sample->length; j++) {
+			int value = stream[j] + data[c->position] - 0x80;
+
+			if (value < 0x00) value = 0x00;
+			if (value > 0xFF) value = 0xFF;
+			stream[j] = (uint8)value;
+
+			c->fraction += c->sample->step;
+			c->position += c->fraction >> 16;
+			c->fraction &= 0xFFFF;
+		}
+
+		if (c->position >= c->sample->length) {
+			DSP_Channel_Free(c);
+			continue;
+		}
+		active++;
 	}
 
-	if (len <= (int)s_bufferLen) {
-		memcpy(stream, s_buffer, len);
-		s_bufferLen -= len;
-		s_buffer += len;
-	} else {
-		memcpy(stream, s_buffer, s_bufferLen);
-		memset(stream + s_bufferLen, 0x80, len - s_bufferLen);	/* fill buffer end with silence */
-		s_bufferLen = 0;
-		s_buffer = NULL;
-		s_status = 0;
+	/* Only mark the commands as read now, so DSP_GetStatus() cannot miss a
+	 *  sample between leaving the queue and being counted as playing */
+	s_channelsActive = active;
+	DSP_MemoryBarrierRelease();
+	s_commands.tail = tail;
+}
+
+/**
+ * Free all samples the audio callback is done with.
+ */
+static void DSP_FreeFinished(void)
+{
+	DSPSample *sample;
+
+	while (DSP_Queue_Pop(&s_finished, &sample)) {
+		free(sample);
+		s_samplesCount--;
 	}
 }
 
 void DSP_Stop(void)
 {
-	SDL_PauseAudio(1);
+	if (!s_init) return;
+
+	DSP_FreeFinished();
 
-	s_bufferLen = 0;
-	s_buffer = NULL;
-	s_status = 0;
+	/* Not a command in the queue, so a full queue cannot drop the stop */
+	s_stopHead = s_commands.head;
+	DSP_MemoryBarrierRelease();
 }
 
 void DSP_Uninit(void)
 {
+	DSPSample *sample;
+	uint8 i;
+
 	if (SDL_WasInit(SDL_INIT_AUDIO) == 0) return;
 
-	DSP_Stop();
 	SDL_CloseAudio();
 
-	free(s_data); s_data = NULL;
-	s_dataLen = 0;
+	/* The callback no longer runs; free all samples, wherever they are */
+	if (s_init) {
+		DSP_FreeFinished();
+		while (DSP_Queue_Pop(&s_commands, &sample)) free(sample);
+		for (i = 0; i < DSP_CHANNELS; i++) {
+			free(s_channels[i].sample);
+			s_channels[i].sample = NULL;
+		}
+		s_samplesCount = 0;
+		s_channelsActive = 0;
+		s_init = false;
+	}
 
 	SDL_QuitSubSystem(SDL_INIT_AUDIO);
 }
@@ -72,84 +269,69 @@ bool DSP_Init(void)
 	s_spec.samples  = 512;
 	s_spec.callback = DSP_Callback;
 
-	s_bufferLen = 0;
-	s_buffer = NULL;
-	s_status = 0;
-	s_data = NULL;
-	s_dataLen = 0;
+	memset(s_channels, 0, sizeof(s_channels));
+	s_channelsActive = 0;
+	s_samplesCount = 0;
 
 	if (SDL_OpenAudio(&s_spec, &s_spec) != 0) return false;
 
+	s_init = true;
+
+	/* The mixer plays silence when there is nothing to play */
+	SDL_PauseAudio(0);
+
 	return (SDL_GetAudioStatus() != 0);
 }
 
 /**
- * In Dune2, the frequency of the VOC files are all over the place. SDL really
- *  dislikes it when we close/open the audio driver a lot. So, we convert all
- *  audio to one frequency, which resolves all issues. Sadly, our knowledge of
- *  audio is not really good, so this is a linear scaler.
+ * Play a VOC sample, mixed with the samples playing already. When all
+ *  channels are in use, the sample with the lowest priority stops, or the
+ *  new sample is dropped if its priority is lower than all others.
+ * @param data The VOC data; it is copied, so can be reused directly after.
+ * @param priority The priority of the sample.
  */
-static void DSP_ConvertAudio(uint32 freq)
+void DSP_Play(const uint8 *data, int16 priority)
 {
-	uint32 newlen = s_bufferLen * s_spec.freq / freq;
-	uint8 *r;
-	uint8 *w;
-	uint32 i, j;
-
-	assert((int)freq < s_spec.freq);
-
-	if (s_dataLen < newlen) {
-		s_data = realloc(s_data, newlen);
-		s_dataLen = newlen;
-	}
-
-	w = s_data + newlen - 1;
-	r = s_data + s_bufferLen - 1;
-	j = 0;
-	for (i = 0; i < s_bufferLen; i++) {
-		do {
-			*w-- = *r;
-			j++;
-		} while (j <= i * s_spec.freq / freq);
-		r--;
-	}
-	r++;
-	while (j < i * s_spec.freq / freq) {
-		*w-- = *r;
-		j++;
-	}
-	w++;
+	DSPSample *sample;
+	uint32 freq;
+	uint32 len;
 
-	assert(w == s_data);
-	assert(r == s_data);
+	if (!s_init) return;
 
-	s_bufferLen = newlen;
-}
-
-void DSP_Play(const uint8 *data)
-{
-	DSP_Stop();
+	DSP_FreeFinished();
 
 	data += READ_LE_UINT16(data + 20);
 
 	if (*data != 1) return;
 
-	s_bufferLen = (READ_LE_UINT32(data) >> 8) - 2;
+	len  = (READ_LE_UINT32(data) >> 8) - 2;
+	freq = 1000000 / (256 - data[4]);
+	if (freq > 0xFFFF) freq = 0xFFFF;
 
-	if (s_dataLen < s_bufferLen) {
-		s_data = realloc(s_data, s_bufferLen);
-		s_dataLen = s_bufferLen;
-	}
+	if (s_samplesCount >= DSP_SAMPLES_MAX) return;
 
-	memcpy(s_data, data + 6, s_bufferLen);
-	DSP_ConvertAudio(1000000 / (256 - data[4]));
+	sample = (DSPSample *)malloc(sizeof(DSPSample) + len);
+	if (sample == NULL) return;
 
-	s_buffer = s_data;
-	s_status = 2;
-	SDL_PauseAudio(0);
+	sample->length = len;
+	sample->step   = (freq << 16) / s_spec.freq;
+	sample->priority = priority;
+	memcpy(sample + 1, data + 6, len);
+
+	if (!DSP_Queue_Push(&s_commands, sample)) {
+		free(sample);
+		return;
+	}
+	s_samplesCount++;
 }
 
 uint8 DSP_GetStatus(void)
 {
-	return (SDL_GetAudioStatus() != 0) ? s_status : 0;
+	if (!s_init) return 0;
+
+	/* Samples still in the queue are as good as playing */
+	if (s_commands.head != s_commands.tail) return 2;
+	DSP_MemoryBarrierAcquire();
+
+	return (s_channelsActive != 0) ? 2 : 0;
 }
@@ -55,13 +55,15 @@ static void CALLBACK DSP_Callback(HWAVEOUT hwo, UINT uMsg, DWORD_PTR dwInstance,
 	s_playing = false;
 }
 
-void DSP_Play(const uint8 *data)
+void DSP_Play(const uint8 *data, int16 priority)
 {
 	uint32 len;
 	WAVEFORMATEX waveFormat;
 	DWORD freq;
 	MMRESULT res;
 
+	VARIABLE_NOT_USED(priority);
+
 	DSP_Stop();
 
 	data += ((const uint16 *)data)[10];
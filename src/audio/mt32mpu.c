@@ -16,11 +16,12 @@
 
 #include "midi.h"
 
-#if defined(_WIN32)
+#if !defined(TOS)
 static Semaphore s_mpu_sem = NULL;
 static Thread s_mpu_thread = NULL;
 static uint32 s_mpu_usec = 0;
-#endif /* _WIN32 */
+static bool s_mpu_threadRunning = false;                    /*!< Whether commands go through the queue to the sequencer thread. */
+#endif /* TOS */
 
 /* Dune II is using AIL middleware for sound and music :
  * AIL = IBM Audio Interface Library by John Miles
@@ -88,6 +89,49 @@ static bool s_mpu_initialized;
 
 static bool s_mpuIgnore = false;
 
+/**
+ * Type of a command for the sequencer thread.
+ */
+typedef enum MPUCommandType {
+	MPU_COMMAND_SETDATA   = 0,                              /*!< MPU_SetData(). */
+	MPU_COMMAND_PLAY      = 1,                              /*!< MPU_Play(). */
+	MPU_COMMAND_STOP      = 2,                              /*!< MPU_Stop(). */
+	MPU_COMMAND_CLEARDATA = 3,                              /*!< MPU_ClearData(). */
+	MPU_COMMAND_SETVOLUME = 4                               /*!< MPU_SetVolume(). */
+} MPUCommandType;
+
+/**
+ * A command from the game to the sequencer thread.
+ */
+typedef struct MPUCommand {
+	uint8 type;                                             /*!< The MPUCommandType. */
+	uint8 index;                                            /*!< The sequence the command is for. */
+	uint16 volume;                                          /*!< MPU_COMMAND_SETVOLUME: the volume target. */
+	uint16 time;                                            /*!< MPU_COMMAND_SETVOLUME: the time to reach the target. */
+	MSData *data;                                           /*!< MPU_COMMAND_SETDATA: the sequence data. */
+	const uint8 *EVNT;                                      /*!< MPU_COMMAND_SETDATA: the EVNT position in the sound file. */
+} MPUCommand;
+
+#if !defined(TOS)
+#define MPU_QUEUE_SIZE 64                                   /*!< Size of the command queue; must be a power of 2. */
+
+#if defined(_MSC_VER)
+	#define MPU_MemoryBarrier() MemoryBarrier()
+#elif defined(__GNUC__)
+	#define MPU_MemoryBarrier() __sync_synchronize()
+#else
+	#define MPU_MemoryBarrier()
+#endif /* _MSC_VER */
+
+/* The game only changes the head, the sequencer thread only the tail, so
+ *  the queue needs no lock */
+static MPUCommand s_mpu_commands[MPU_QUEUE_SIZE];
+static volatile uint16 s_mpu_commandsHead = 0;              /*!< Amount of commands ever queued. */
+static volatile uint16 s_mpu_commandsTail = 0;              /*!< Amount of commands ever handled. */
+#endif /* TOS */
+
+static bool s_mpu_slotUsed[8];                              /*!< Sequences in use as seen by the game, which can run ahead of the sequencer thread. */
+
 static void MPU_Send(uint8 status, uint8 data1, uint8 data2)
 {
 	s_mpuIgnore = true;
@@ -407,6 +451,8 @@ static void MPU_ResetSequence(MSData *data)
 	}
 }
 
+static void MPU_ClearDataNow(uint16 index);
+
 /**
  * XMIDI.ASM - XMIDI_meta
  */
@@ -432,7 +478,7 @@ static uint16 MPU_XMIDIMeta(MSData *data)
 			MPU_ResetSequence(data);	/* reset_sequence */
 
 			data->playing = 2; /* 2 = SEQ_DONE */
-			if (data->delayedClear) MPU_ClearData(s_mpu_msdataCurrent);	/* release-on-completion pending => release_seq */
+			if (data->delayedClear) MPU_ClearDataNow(s_mpu_msdataCurrent);	/* release-on-completion pending => release_seq */
 			break;
 
 		case 0x58: {	/* time sig */
@@ -766,54 +812,71 @@ static void MPU_InitData(MSData *data)
 	data->timePerBeat = 0x7A1200;	/* 8000000 */
 }
 
-uint16 MPU_SetData(uint8 *file, uint16 index, void *msdata)
+static void MPU_StopAllNotes(MSData *data)
 {
-	MSData *data = msdata;
-	uint32 header;
-	uint32 size;
-	uint16 i;
+	uint8 i;
 
-	if (file == NULL) return 0xFFFF;
+	for (i = 0; i < MAX_NOTES; i++) {
+		uint8 note;
+		uint8 chan;
 
-	for (i = 0; i < 8; i++) {
-		if (s_mpu_msdata[i] == NULL) break;
-	}
-	if (i == 8) return 0xFFFF;
+		chan = data->noteOnChans[i];
+		if (chan == 0xFF) continue;
 
-	file = MPU_FindSoundStart(file, index);
-	if (file == NULL) return 0xFFFF;
+		data->noteOnChans[i] = 0xFF;
+		note = data->noteOnNotes[i];
+		chan = data->chanMaps[chan];
 
-	s_mpu_msdata[i] = data;
-	data->EVNT = NULL;
+		/* Note Off */
+		MPU_Send(0x80 | chan, note, 0);
+	}
 
-	header = READ_BE_UINT32(file);
-	size   = 12;
-	while (header != CC_EVNT) {
-		file += size;
-		header = READ_BE_UINT32(file);
-		size   = READ_BE_UINT32(file + 4) + 8;
+	data->noteOnCount = 0;
+}
+
+static void MPU_SetDataNow(uint16 index, MSData *data, const uint8 *EVNT)
+{
+	/* A sequence still playing till its end, while the game already released it */
+	if (s_mpu_msdata[index] != NULL) {
+		MPU_StopAllNotes(s_mpu_msdata[index]);
+		MPU_ResetSequence(s_mpu_msdata[index]);
+		s_mpu_msdataSize--;
 	}
 
-	data->EVNT = file;
+	data->EVNT = EVNT;
 	data->playing = 0;
 	data->delayedClear = false;
 
-	s_mpu_msdataSize++;
-
 	MPU_InitData(data);
 
-	return i;
+	s_mpu_msdata[index] = data;
+	s_mpu_msdataSize++;
 }
 
-void MPU_Play(uint16 index)
+static void MPU_StopNow(uint16 index)
 {
 	MSData *data;
 
-	if (index == 0xFFFF) return;
+	if (s_mpu_msdata[index] == NULL) return;
+
+	data = s_mpu_msdata[index];
+
+	if (data->playing != 1) return;
+
+	MPU_StopAllNotes(data);
+	MPU_ResetSequence(data);
+
+	data->playing = 0;
+}
+
+static void MPU_PlayNow(uint16 index)
+{
+	MSData *data;
 
 	data = s_mpu_msdata[index];
+	if (data == NULL) return;
 
-	if (data->playing == 1) MPU_Stop(index);
+	if (data->playing == 1) MPU_StopNow(index);
 
 	MPU_InitData(data);
 
@@ -822,54 +885,205 @@ void MPU_Play(uint16 index)
 	data->playing = 1;
 }
 
-static void MPU_StopAllNotes(MSData *data)
+/**
+ * XMIDI.ASM - release_seq
+ */
+static void MPU_ClearDataNow(uint16 index)
 {
-	uint8 i;
+	MSData *data;
 
-	for (i = 0; i < MAX_NOTES; i++) {
-		uint8 note;
-		uint8 chan;
+	if (s_mpu_msdata[index] == NULL) return;
 
-		chan = data->noteOnChans[i];
-		if (chan == 0xFF) continue;
+	data = s_mpu_msdata[index];
 
-		data->noteOnChans[i] = 0xFF;
-		note = data->noteOnNotes[i];
-		chan = data->chanMaps[chan];
+	if (data->playing == 1) {
+		data->delayedClear = true;
+	} else {
+		s_mpu_msdata[index] = NULL;
+		s_mpu_msdataSize--;
+	}
+}
 
-		/* Note Off */
-		MPU_Send(0x80 | chan, note, 0);
+/**
+ * XMIDI.ASM - set_rel_volume
+ * Set relative volume
+ * @param volume Target volume (%) to reach
+ * @param time Time to reach target volume (in milliseconds)
+ */
+static void MPU_SetVolumeNow(uint16 index, uint16 volume, uint16 time)
+{
+	MSData *data;
+	int16 diff;
+
+	data = s_mpu_msdata[index];
+	if (data == NULL) return;
+
+	data->globalVolumeTarget = volume;	/* volume target */
+
+	if (time == 0) {
+		/* immediate */
+		data->globalVolume = volume;
+		MPU_ApplyVolume(data);
+		return;
 	}
 
-	data->noteOnCount = 0;
+	diff = data->globalVolumeTarget - data->globalVolume;
+	if (diff == 0) return;
+
+	data->globalVolumeIncr = 10 * (uint32)time / (uint16)abs(diff);	/* volume increment per 100us period */
+	if (data->globalVolumeIncr == 0) data->globalVolumeIncr = 1;
+	data->globalVolumeAcc = 0;	/* vol_accum */
 }
 
-void MPU_Stop(uint16 index)
+/**
+ * Handle a command, on the thread owning the sequences.
+ */
+static void MPU_Command_Execute(const MPUCommand *command)
 {
-	MSData *data;
+	switch (command->type) {
+		case MPU_COMMAND_SETDATA:   MPU_SetDataNow(command->index, command->data, command->EVNT); break;
+		case MPU_COMMAND_PLAY:      MPU_PlayNow(command->index); break;
+		case MPU_COMMAND_STOP:      MPU_StopNow(command->index); break;
+		case MPU_COMMAND_CLEARDATA: MPU_ClearDataNow(command->index); break;
+		case MPU_COMMAND_SETVOLUME: MPU_SetVolumeNow(command->index, command->volume, command->time); break;
+		default: break;
+	}
+}
 
-	if (index == 0xFFFF) return;
-	if (s_mpu_msdata[index] == NULL) return;
+/**
+ * Hand a command to the sequencer thread, or handle it directly when the
+ *  thread does not run. When the queue is full, wait for the thread to make
+ *  room, which it does every tick.
+ */
+static void MPU_Command_Queue(MPUCommandType type, uint16 index, MSData *data, const uint8 *EVNT, uint16 volume, uint16 time)
+{
+	MPUCommand direct;
+	MPUCommand *command = &direct;
+#if !defined(TOS)
+	uint16 head = s_mpu_commandsHead;
+
+	if (s_mpu_threadRunning) {
+		while ((uint16)(head - s_mpu_commandsTail) == MPU_QUEUE_SIZE) msleep(1);
+		command = &s_mpu_commands[head & (MPU_QUEUE_SIZE - 1)];
+	}
+#endif /* TOS */
+
+	command->type   = type;
+	command->index  = (uint8)index;
+	command->volume = volume;
+	command->time   = time;
+	command->data   = data;
+	command->EVNT   = EVNT;
+
+#if !defined(TOS)
+	if (s_mpu_threadRunning) {
+		MPU_MemoryBarrier();
+		s_mpu_commandsHead = head + 1;
+		return;
+	}
+#endif /* TOS */
 
-	data = s_mpu_msdata[index];
+	MPU_Command_Execute(command);
+}
 
-	if (data->playing != 1) return;
+#if !defined(TOS)
+/**
+ * Handle all queued commands; called by the sequencer thread.
+ */
+static void MPU_Command_ExecuteAll(void)
+{
+	uint16 tail = s_mpu_commandsTail;
+	uint16 head = s_mpu_commandsHead;
 
-	MPU_StopAllNotes(data);
-	MPU_ResetSequence(data);
+	MPU_MemoryBarrier();
 
-	data->playing = 0;
+	for (; tail != head; tail++) MPU_Command_Execute(&s_mpu_commands[tail & (MPU_QUEUE_SIZE - 1)]);
+
+	MPU_MemoryBarrier();
+	s_mpu_commandsTail = tail;
+}
+#endif /* TOS */
+
+uint16 MPU_SetData(uint8 *file, uint16 index, void *msdata)
+{
+	uint32 header;
+	uint32 size;
+	uint16 i;
+
+	if (file == NULL) return 0xFFFF;
+
+	for (i = 0; i < 8; i++) {
+		if (!s_mpu_slotUsed[i]) break;
+	}
+	if (i == 8) return 0xFFFF;
+
+	file = MPU_FindSoundStart(file, index);
+	if (file == NULL) return 0xFFFF;
+
+	header = READ_BE_UINT32(file);
+	size   = 12;
+	while (header != CC_EVNT) {
+		file += size;
+		header = READ_BE_UINT32(file);
+		size   = READ_BE_UINT32(file + 4) + 8;
+	}
+
+	s_mpu_slotUsed[i] = true;
+	MPU_Command_Queue(MPU_COMMAND_SETDATA, i, (MSData *)msdata, file, 0, 0);
+
+	return i;
+}
+
+void MPU_Play(uint16 index)
+{
+	if (index == 0xFFFF) return;
+
+	MPU_Command_Queue(MPU_COMMAND_PLAY, index, NULL, NULL, 0, 0);
+}
+
+void MPU_Stop(uint16 index)
+{
+	if (index == 0xFFFF) return;
+	if (!s_mpu_slotUsed[index]) return;
+
+	MPU_Command_Queue(MPU_COMMAND_STOP, index, NULL, NULL, 0, 0);
 }
 
 uint16 AIL_sequence_status(uint16 index)
 {
 	MSData *data;
+	uint16 status;
+#if !defined(TOS)
+	uint16 tail;
+#endif /* TOS */
 
 	if (index == 0xFFFF) return 0xFFFF;
 
+#if !defined(TOS)
+	tail = s_mpu_commandsTail;
+	MPU_MemoryBarrier();
+#endif /* TOS */
+
 	data = s_mpu_msdata[index];
+	status = (data == NULL) ? 0 : data->playing;
+
+#if !defined(TOS)
+	/* Commands the sequencer thread did not handle yet are as good as done */
+	for (; tail != s_mpu_commandsHead; tail++) {
+		const MPUCommand *command = &s_mpu_commands[tail & (MPU_QUEUE_SIZE - 1)];
 
-	return data->playing;
+		if (command->index != index) continue;
+
+		switch (command->type) {
+			case MPU_COMMAND_SETDATA: status = 0; break;
+			case MPU_COMMAND_PLAY:    status = 1; break;
+			case MPU_COMMAND_STOP:    if (status == 1) status = 0; break;
+			default: break;
+		}
+	}
+#endif /* TOS */
+
+	return status;
 }
 
 uint16 MPU_GetDataSize(void)
@@ -877,19 +1091,37 @@ uint16 MPU_GetDataSize(void)
 	return sizeof(MSData);
 }
 
-#if defined(_WIN32)
+#if !defined(TOS)
+/**
+ * The sequencer thread. It wakes up at fixed deadlines instead of sleeping
+ *  a fixed time after each tick, so the time a tick takes and the wake-up
+ *  latency do not add up to a slower tempo. When it is far behind, as
+ *  happens when the process was suspended, it skips the ticks missed
+ *  instead of playing them all at once.
+ */
 static ThreadStatus WINAPI MPU_ThreadProc(void *data)
 {
+	uint32 deadline;
+
 	VARIABLE_NOT_USED(data);
 	Semaphore_Lock(s_mpu_sem);
+
+	deadline = Thread_GetTime();
 	while (!Semaphore_TryLock(s_mpu_sem)) {
-		msleep(s_mpu_usec / 1000);
+		deadline += s_mpu_usec;
+		Thread_SleepUntil(deadline);
+
+		if ((int32)(Thread_GetTime() - deadline) > (int32)(s_mpu_usec * 8)) deadline = Thread_GetTime();
+
+		MPU_Command_ExecuteAll();
 		MPU_Interrupt();
 	}
+	MPU_Command_ExecuteAll();
+
 	Semaphore_Unlock(s_mpu_sem);
 	return 0;
 }
-#endif /* _WIN32 */
+#endif /* TOS */
 
 bool MPU_Init(void)
 {
@@ -897,7 +1129,7 @@ bool MPU_Init(void)
 
 	if (!midi_init()) return false;
 
-#if defined(_WIN32)
+#if !defined(TOS)
 	s_mpu_sem = Semaphore_Create(0);
 	if (s_mpu_sem == NULL) {
 		Error("Failed to create semaphore\n");
@@ -910,11 +1142,12 @@ bool MPU_Init(void)
 		Semaphore_Destroy(s_mpu_sem);
 		return false;
 	}
-#endif /* _WIN32 */
+#endif /* TOS */
 
 	s_mpu_msdataSize = 0;
 	s_mpu_msdataCurrent = 0;
 	memset(s_mpu_msdata, 0, sizeof(s_mpu_msdata));
+	memset(s_mpu_slotUsed, 0, sizeof(s_mpu_slotUsed));
 
 	memset(s_mpu_controls,   0xFF, sizeof(s_mpu_controls));
 	memset(s_mpu_programs,   0xFF, sizeof(s_mpu_programs));
@@ -971,8 +1204,8 @@ void MPU_Uninit(void)
 
 	if (!s_mpu_initialized) return;
 
-	for (i = 0; i < s_mpu_msdataSize; i++) {
-		if (s_mpu_msdata[i] == NULL) continue;
+	for (i = 0; i < lengthof(s_mpu_msdata); i++) {
+		if (!s_mpu_slotUsed[i]) continue;
 		MPU_Stop(i);
 		MPU_ClearData(i);
 	}
@@ -985,73 +1218,60 @@ void MPU_Uninit(void)
 	midi_uninit();
 	s_mpuIgnore = false;
 
-#if defined(_WIN32)
+#if !defined(TOS)
 	Semaphore_Destroy(s_mpu_sem);
-#endif /* _WIN32 */
+#endif /* TOS */
 }
 
 /**
- * XMIDI.ASM - release_seq
+ * Release a sequence. When it is still playing, it is released when it ends.
  */
 void MPU_ClearData(uint16 index)
 {
-	MSData *data;
-
 	if (index == 0xFFFF) return;
-	if (s_mpu_msdata[index] == NULL) return;
-
-	data = s_mpu_msdata[index];
+	if (!s_mpu_slotUsed[index]) return;
 
-	if (data->playing == 1) {
-		data->delayedClear = true;
-	} else {
-		s_mpu_msdata[index] = NULL;
-		s_mpu_msdataSize--;
-	}
+	s_mpu_slotUsed[index] = false;
+	MPU_Command_Queue(MPU_COMMAND_CLEARDATA, index, NULL, NULL, 0, 0);
 }
 
 /**
- * XMIDI.ASM - set_rel_volume
  * Set relative volume
  * @param volume Target volume (%) to reach
  * @param time Time to reach target volume (in milliseconds)
  */
 void MPU_SetVolume(uint16 index, uint16 volume, uint16 time)
 {
-	MSData *data;
-	int16 diff;
-
 	if (index == 0xFFFF) return;
 
-	data = s_mpu_msdata[index];
-
-	data->globalVolumeTarget = volume;	/* volume target */
-
-	if (time == 0) {
-		/* immediate */
-		data->globalVolume = volume;
-		MPU_ApplyVolume(data);
-		return;
-	}
-
-	diff = data->globalVolumeTarget - data->globalVolume;
-	if (diff == 0) return;
-
-	data->globalVolumeIncr = 10 * (uint32)time / (uint16)abs(diff);	/* volume increment per 100us period */
-	if (data->globalVolumeIncr == 0) data->globalVolumeIncr = 1;
-	data->globalVolumeAcc = 0;	/* vol_accum */
+	MPU_Command_Queue(MPU_COMMAND_SETVOLUME, index, NULL, NULL, volume, time);
 }
 
-#if defined(_WIN32)
+#if !defined(TOS)
 void MPU_StartThread(uint32 usec)
 {
 	s_mpu_usec = usec;
+	s_mpu_threadRunning = true;
 	Semaphore_Unlock(s_mpu_sem);
 }
 
+/**
+ * Stop the sequencer thread, after it handled all queued commands. From then
+ *  on commands are handled directly again.
+ */
 void MPU_StopThread(void)
 {
 	Semaphore_Unlock(s_mpu_sem);
 	Thread_Wait(s_mpu_thread, NULL);
+	s_mpu_threadRunning = false;
+}
+
+/**
+ * Wait till the sequencer thread handled all queued commands. Call this
+ *  before freeing a sound file a stopped sequence was reading from.
+ */
+void MPU_Sync(void)
+{
+	while (s_mpu_threadRunning && s_mpu_commandsTail != s_mpu_commandsHead) msleep(1);
 }
-#endif /* _WIN32 */
+#endif /* TOS */
@@ -13,9 +13,10 @@ extern bool MPU_Init(void);
 extern void MPU_Uninit(void);
 extern void MPU_ClearData(uint16 index);
 extern void MPU_SetVolume(uint16 index, uint16 volume, uint16 time);
-#if defined(_WIN32)
+#if !defined(TOS)
 extern void MPU_StartThread(uint32 usec);
 extern void MPU_StopThread(void);
-#endif /* _WIN32 */
+extern void MPU_Sync(void);
+#endif /* TOS */
 
 #endif /* MT32MPU_H */
@@ -9,6 +9,7 @@
 #include "sound.h"
 
 #include "driver.h"
+#include "../gamecontext.h"
 #include "mt32mpu.h"
 #include "../config.h"
 #include "../file.h"
@@ -80,14 +81,105 @@ ROM:00020BF0 7265 706F 7274 696E 6720+                    dc.b 'reporting      '
 ROM:00020C00 706C 616E 6574 2073 6869+                    dc.b 'planet shimmer ',0 
 */
 
-static void *g_voiceData[NUM_VOICES];            /*!< Preloaded Voices sound data */
-static uint32 g_voiceDataSize[NUM_VOICES];       /*!< Preloaded Voices sound data size in byte */
+#define VOICE_CACHE_SIZE (512 * 1024)            /*!< Amount of bytes of voices to keep loaded. */
+
+static void *g_voiceData[NUM_VOICES];            /*!< Loaded Voices sound data */
+static uint32 g_voiceDataSize[NUM_VOICES];       /*!< Loaded Voices sound data size in byte */
+static char s_voiceFilename[NUM_VOICES][16];     /*!< File to load each Voice of the current voice set from, or empty if not in the set. */
+static uint32 s_voiceLastUsed[NUM_VOICES];       /*!< When each Voice was last used, to unload the least recently used first. */
+static uint32 s_voiceUsed = 0;                   /*!< Amount of times a Voice was used. */
+static uint32 s_voiceCacheSize = 0;              /*!< Amount of bytes of Voices loaded. */
+static uint16 s_voicePlaying = 0xFFFF;           /*!< Voice last given to the driver. */
 static const char *s_currentMusic = NULL;        /*!< Currently loaded music file. */
 static uint16 s_spokenWords[NUM_SPEECH_PARTS];   /*!< Buffer with speech to play. */
 static int16 s_currentVoicePriority;            /*!< Priority of the currently playing Speech */
 
 static void *Sound_LoadVoc(const char *filename, uint32 *retFileSize);
 
+/**
+ * Unload a voice, but keep it in the voice set.
+ * @param voice The voice to unload.
+ */
+static void Voice_Unload(uint16 voice)
+{
+	if (g_voiceData[voice] == NULL) return;
+
+	free(g_voiceData[voice]);
+	g_voiceData[voice] = NULL;
+	s_voiceCacheSize -= g_voiceDataSize[voice];
+}
+
+/**
+ * Remove a voice from the voice set, unloading it if needed.
+ * @param voice The voice to remove.
+ */
+static void Voice_Remove(uint16 voice)
+{
+	Voice_Unload(voice);
+	s_voiceFilename[voice][0] = '\0';
+}
+
+/**
+ * Get the data of a voice of the current voice set, loading it on first use.
+ *  When more than VOICE_CACHE_SIZE bytes of voices are loaded, the least
+ *  recently used voices are unloaded again.
+ * @param voice The voice to get the data of.
+ * @return The data, or NULL if the voice is not in the current voice set.
+ */
+static void *Voice_GetData(uint16 voice)
+{
+	if (g_voiceData[voice] == NULL) {
+		char *filename = s_voiceFilename[voice];
+
+		if (filename[0] == '\0') return NULL;
+
+		/* XXX - In the 1.07us datafiles, a few files are named differently:
+		 *
+		 *  moveout.voc
+		 *  overout.voc
+		 *  report1.voc
+		 *  report2.voc
+		 *  report3.voc
+		 *
+		 * They come without letter in front of them. To make things a bit
+		 *  easier, just check if the file exists, then remove the first
+		 *  letter and see if it works then.
+		 */
+		if (g_table_voices[voice].string[0] == '+' && !File_Exists(filename)) {
+			memmove(filename, filename + 1, strlen(filename));
+		}
+
+		g_voiceData[voice] = Sound_LoadVoc(filename, &g_voiceDataSize[voice]);
+		if (g_voiceData[voice] == NULL) {
+			/* Do not try again */
+			filename[0] = '\0';
+			return NULL;
+		}
+		s_voiceCacheSize += g_voiceDataSize[voice];
+	}
+
+	s_voiceLastUsed[voice] = ++s_voiceUsed;
+
+	while (s_voiceCacheSize > VOICE_CACHE_SIZE) {
+		uint16 oldest = 0xFFFF;
+		uint16 i;
+
+		for (i = 0; i < NUM_VOICES; i++) {
+			if (g_voiceData[i] == NULL || i == voice) continue;
+
+			/* Some drivers play directly from the data */
+			if (i == s_voicePlaying && Driver_Voice_IsPlaying()) continue;
+
+			if (oldest == 0xFFFF || s_voiceLastUsed[i] < s_voiceLastUsed[oldest]) oldest = i;
+		}
+		if (oldest == 0xFFFF) break;
+
+		Voice_Unload(oldest);
+	}
+
+	return g_voiceData[voice];
+}
+
 static void Play_Score(int16 index, uint16 volume)
 {
 	Driver *music = g_driverMusic;
@@ -208,9 +300,10 @@ void Voice_PlayAtTile(int16 voiceID, CellStruct position)
 
 	index = g_table_voiceMapping[voiceID];
 
-	if (g_enableVoices != 0 && index != 0xFFFF && g_voiceData[index] != NULL && g_table_voices[index].priority >= s_currentVoicePriority) {
+	if (g_enableVoices != 0 && index != 0xFFFF && g_table_voices[index].priority >= s_currentVoicePriority && Voice_GetData(index) != NULL) {
 		s_currentVoicePriority = g_table_voices[index].priority;
 		memmove(g_readBuffer, g_voiceData[index], g_voiceDataSize[index]);
+		s_voicePlaying = 0xFFFF;
 
 		Driver_Voice_Play(g_readBuffer, s_currentVoicePriority);
 	} else {
@@ -232,7 +325,7 @@ void Voice_Play(int16 voiceID)
 }
 
 /**
- * Load voices.
+ * Load voices. The voices are only read from disk on first use.
  * voiceSet 0xFFFE is for Game Intro.
  * voiceSet 0xFFFF is for Game End.
  * @param voiceSet Voice set to load : either a HouseID, or special values 0xFFFE or 0xFFFF.
@@ -252,29 +345,25 @@ void Voice_LoadVoices(uint16 voiceSet)
 					if (voiceSet != 0xFFFF && voiceSet != 0xFFFE) break;
 				}
 
-				free(g_voiceData[voice]);
-				g_voiceData[voice] = NULL;
+				Voice_Remove(voice);
 				break;
 
 			case '+':
 				if (voiceSet != 0xFFFF && voiceSet != 0xFFFE) break;
 
-				free(g_voiceData[voice]);
-				g_voiceData[voice] = NULL;
+				Voice_Remove(voice);
 				break;
 
 			case '-':
 				if (voiceSet == 0xFFFF) break;
 
-				free(g_voiceData[voice]);
-				g_voiceData[voice] = NULL;
+				Voice_Remove(voice);
 				break;
 
 			case '/':
 				if (voiceSet != 0xFFFE) break;
 
-				free(g_voiceData[voice]);
-				g_voiceData[voice] = NULL;
+				Voice_Remove(voice);
 				break;
 
 			case '?':
@@ -292,11 +381,10 @@ void Voice_LoadVoices(uint16 voiceSet)
 	if (currentVoiceSet == voiceSet) return;
 
 	for (voice = 0; voice < NUM_VOICES; voice++) {
-		char filename[16];
 		const char *str = g_table_voices[voice].string;
 		switch (*str) {
 			case '%':
-				if (g_voiceData[voice] != NULL ||
+				if (s_voiceFilename[voice][0] != '\0' ||
 						currentVoiceSet == voiceSet || voiceSet == 0xFFFF || voiceSet == 0xFFFE) break;
 
 				switch (g_config.Language) {
@@ -304,59 +392,39 @@ void Voice_LoadVoices(uint16 voiceSet)
 					case LANGUAGE_GERMAN: prefixChar = 'G'; break;
 					default: prefixChar = g_table_HouseType[voiceSet].prefixChar;
 				}
-				snprintf(filename, sizeof(filename), str, prefixChar);
-
-				g_voiceData[voice] = Sound_LoadVoc(filename, &g_voiceDataSize[voice]);
+				snprintf(s_voiceFilename[voice], sizeof(s_voiceFilename[voice]), str, prefixChar);
 				break;
 
 			case '+':
-				if (voiceSet == 0xFFFF || g_voiceData[voice] != NULL) break;
+				if (voiceSet == 0xFFFF || s_voiceFilename[voice][0] != '\0') break;
 
 				switch (g_config.Language) {
 					case LANGUAGE_FRENCH:  prefixChar = 'F'; break;
 					case LANGUAGE_GERMAN:  prefixChar = 'G'; break;
 					default: prefixChar = 'Z'; break;
 				}
-				snprintf(filename, sizeof(filename), str + 1, prefixChar);
-
-				/* XXX - In the 1.07us datafiles, a few files are named differently:
-				 *
-				 *  moveout.voc
-				 *  overout.voc
-				 *  report1.voc
-				 *  report2.voc
-				 *  report3.voc
-				 *
-				 * They come without letter in front of them. To make things a bit
-				 *  easier, just check if the file exists, then remove the first
-				 *  letter and see if it works then.
-				 */
-				if (!File_Exists(filename)) {
-					memmove(filename, filename + 1, strlen(filename));
-				}
-
-				g_voiceData[voice] = Sound_LoadVoc(filename, &g_voiceDataSize[voice]);
+				snprintf(s_voiceFilename[voice], sizeof(s_voiceFilename[voice]), str + 1, prefixChar);
 				break;
 
 			case '-':
-				if (voiceSet != 0xFFFF || g_voiceData[voice] != NULL) break;
+				if (voiceSet != 0xFFFF || s_voiceFilename[voice][0] != '\0') break;
 
-				g_voiceData[voice] = Sound_LoadVoc(str + 1, &g_voiceDataSize[voice]);
+				strncpy(s_voiceFilename[voice], str + 1, sizeof(s_voiceFilename[voice]) - 1);
 				break;
 
 			case '/':
 				if (voiceSet != 0xFFFE) break;
 
-				g_voiceData[voice] = Sound_LoadVoc(str + 1, &g_voiceDataSize[voice]);
+				strncpy(s_voiceFilename[voice], str + 1, sizeof(s_voiceFilename[voice]) - 1);
 				break;
 
 			case '?':
 				break;
 
 			default:
-				if (g_voiceData[voice] != NULL) break;
+				if (s_voiceFilename[voice][0] != '\0') break;
 
-				g_voiceData[voice] = Sound_LoadVoc(str, &g_voiceDataSize[voice]);
+				strncpy(s_voiceFilename[voice], str, sizeof(s_voiceFilename[voice]) - 1);
 				break;
 		}
 	}
@@ -371,8 +439,7 @@ void Voice_UnloadVoices(void)
 	uint16 voice;
 
 	for (voice = 0; voice < NUM_VOICES; voice++) {
-		free(g_voiceData[voice]);
-		g_voiceData[voice] = NULL;
+		Voice_Remove(voice);
 	}
 }
 
@@ -386,7 +453,8 @@ void Sound_StartSound(uint16 index)
 
 	s_currentVoicePriority = g_table_voices[index].priority;
 
-	if (g_voiceData[index] != NULL) {
+	if (Voice_GetData(index) != NULL) {
+		s_voicePlaying = index;
 		Driver_Voice_Play(g_voiceData[index], 0xFF);
 	} else {
 		char filenameBuffer[16];
@@ -0,0 +1,642 @@
+/** @file src/batch.c Simulate games without screen, sound or input, in worker processes. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if !defined(_WIN32) && !defined(TOS)
+	#include <unistd.h>
+	#include <sys/types.h>
+	#include <sys/resource.h>
+	#include <sys/wait.h>
+#endif /* !_WIN32 && !TOS */
+#include "types.h"
+#include "os/error.h"
+#include "os/strings.h"
+
+#include "batch.h"
+
+#include "animation.h"
+#include "config.h"
+#include "explosion.h"
+#include "file.h"
+#include "gamecontext.h"
+#include "gfx.h"
+#include "gui/font.h"
+#include "gui/gui.h"
+#include "house.h"
+#include "inifile.h"
+#include "map.h"
+#include "opendune.h"
+#include "pool/pool.h"
+#include "pool/house.h"
+#include "profile.h"
+#include "scenario.h"
+#include "snapshot.h"
+#include "structure.h"
+#include "team.h"
+#include "timer.h"
+#include "tools.h"
+#include "unit.h"
+
+/**
+ * How a batch job ended.
+ */
+typedef enum BatchStatus {
+	BATCH_STATUS_FAILED     = 0,                            /*!< The worker died before it reported a result. */
+	BATCH_STATUS_UNFINISHED = 1,                            /*!< The game did not end within the ticks of the job. */
+	BATCH_STATUS_WON        = 2,                            /*!< The House of the job won. */
+	BATCH_STATUS_LOST       = 3                             /*!< The House of the job lost. */
+} BatchStatus;
+
+/**
+ * What a batch job does besides simulating the game.
+ */
+typedef enum BatchMode {
+	BATCH_MODE_IDLE = 0,                                    /*!< The House of the job gives no orders. */
+	BATCH_MODE_AI   = 1,                                    /*!< The AI plays the House of the job too. */
+	BATCH_MODE_DRAW = 2,                                    /*!< As BATCH_MODE_AI, and the screen is drawn every tick while the viewport sweeps over the map. */
+
+	BATCH_MODE_MAX  = 3
+} BatchMode;
+
+/**
+ * A game to simulate.
+ */
+typedef struct BatchJob {
+	uint8  houseID;                                         /*!< The House the game is played for. */
+	uint16 scenarioID;                                      /*!< The scenario to play. */
+	uint16 campaignID;                                      /*!< The campaign the scenario belongs to; it changes the difficulty. */
+	uint32 seed;                                            /*!< Seed for the random generators, or 0 to keep the ones of the scenario. */
+	uint32 ticks;                                           /*!< Maximum amount of game ticks to simulate. */
+	uint8  mode;                                            /*!< What to do besides simulating, see BatchMode. */
+} BatchJob;
+
+/**
+ * The outcome of a game, as the worker sends it to the parent.
+ */
+typedef struct BatchResult {
+	uint8  status;                                          /*!< How the game ended, see BatchStatus. */
+	uint32 ticks;                                           /*!< Amount of game ticks simulated. */
+	uint32 frames;                                          /*!< Amount of times the screen was drawn. */
+	uint32 wallTime;                                        /*!< Time the simulation took in microseconds. */
+	uint32 teamTime;                                        /*!< Time spent in GameLoop_Team() in microseconds. */
+	uint32 unitTime;                                        /*!< Time spent in GameLoop_Unit() in microseconds. */
+	uint32 structureTime;                                   /*!< Time spent in GameLoop_Structure() in microseconds. */
+	uint32 houseTime;                                       /*!< Time spent in GameLoop_House() in microseconds. */
+	uint32 drawTime;                                        /*!< Time spent in GUI_DrawScreen() in microseconds. */
+	uint32 peakRSS;                                         /*!< Peak resident set size of the worker in KiB, or 0 if unknown. */
+	uint16 killedAllied;                                    /*!< Units lost, as in the end stats. */
+	uint16 killedEnemy;                                     /*!< Units killed, as in the end stats. */
+	uint16 destroyedAllied;                                 /*!< Buildings lost, as in the end stats. */
+	uint16 destroyedEnemy;                                  /*!< Buildings destroyed, as in the end stats. */
+	uint16 harvestedAllied;                                 /*!< Spice harvested, as in the end stats. */
+	uint16 harvestedEnemy;                                  /*!< Spice harvested by the enemy, as in the end stats. */
+	uint16 score;                                           /*!< Score, as in the end stats. */
+} BatchResult;
+
+static const char * const s_batchStatusNames[] = { "failed", "unfinished", "won", "lost" };
+static const char * const s_batchModeNames[BATCH_MODE_MAX] = { "idle", "ai", "draw" };
+
+/**
+ * Read the jobs from a file. Every line is a job:
+ *  house scenario campaign seed ticks mode
+ *  where house is the name of a House, mode is one of "idle", "ai" or "draw"
+ *  (see BatchMode), and everything after a '#' is a comment.
+ * @param filename The file to read.
+ * @param jobs Where to store the jobs; free() them after use.
+ * @return The amount of jobs read, or -1 on error.
+ */
+static int Batch_ReadJobs(const char *filename, BatchJob **jobs)
+{
+	FILE *fp;
+	char line[256];
+	int count = 0;
+	int size = 0;
+	int lineNumber = 0;
+	bool ok = true;
+
+	*jobs = NULL;
+
+	fp = fopen(filename, "r");
+	if (fp == NULL) {
+		Error("Can't open batch job file '%s'\n", filename);
+		return -1;
+	}
+
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		char house[16];
+		char mode[8];
+		char scenarioFile[14];
+		unsigned int scenarioID;
+		unsigned int campaignID;
+		unsigned long seed;
+		unsigned long ticks;
+		char *comment;
+		BatchJob *job;
+		uint8 houseID;
+		uint8 modeID;
+
+		lineNumber++;
+
+		comment = strchr(line, '#');
+		if (comment != NULL) *comment = '\0';
+
+		if (sscanf(line, "%15s", house) != 1) continue;
+		if (sscanf(line, "%15s %u %u %lu %lu %7s", house, &scenarioID, &campaignID, &seed, &ticks, mode) != 6) {
+			Error("%s:%d: expected 'house scenario campaign seed ticks mode'\n", filename, lineNumber);
+			ok = false;
+			break;
+		}
+
+		for (houseID = 0; houseID < HOUSE_MAX; houseID++) {
+			if (strcasecmp(house, g_table_HouseType[houseID].name) == 0) break;
+		}
+		if (houseID == HOUSE_MAX) {
+			Error("%s:%d: unknown house '%s'\n", filename, lineNumber, house);
+			ok = false;
+			break;
+		}
+
+		/* Read_Scenario_INI() cannot fail quietly, so check up front */
+		snprintf(scenarioFile, sizeof(scenarioFile), "SCEN%c%03u.INI", g_table_HouseType[houseID].name[0], scenarioID);
+		if (scenarioID > 999 || !File_Exists(scenarioFile)) {
+			Error("%s:%d: no scenario %u for %s\n", filename, lineNumber, scenarioID, g_table_HouseType[houseID].name);
+			ok = false;
+			break;
+		}
+
+		for (modeID = 0; modeID < BATCH_MODE_MAX; modeID++) {
+			if (strcasecmp(mode, s_batchModeNames[modeID]) == 0) break;
+		}
+		if (modeID == BATCH_MODE_MAX) {
+			Error("%s:%d: unknown mode '%s'; use 'idle', 'ai' or 'draw'\n", filename, lineNumber, mode);
+			ok = false;
+			break;
+		}
+
+		if (count == size) {
+			BatchJob *newJobs;
+
+			size = (size == 0) ? 16 : size * 2;
+			newJobs = (BatchJob *)realloc(*jobs, size * sizeof(BatchJob));
+			if (newJobs == NULL) {
+				Error("Out of memory reading batch jobs\n");
+				ok = false;
+				break;
+			}
+			*jobs = newJobs;
+		}
+
+		job = &(*jobs)[count++];
+		job->houseID    = houseID;
+		job->scenarioID = (uint16)scenarioID;
+		job->campaignID = (uint16)campaignID;
+		job->seed       = (uint32)seed;
+		job->ticks      = (uint32)ticks;
+		job->mode       = modeID;
+	}
+
+	fclose(fp);
+
+	if (!ok) {
+		free(*jobs);
+		*jobs = NULL;
+		return -1;
+	}
+
+	return count;
+}
+
+/**
+ * Move the viewport one tile further over the map; it goes right and left
+ *  in turns, one row down at every edge, and starts at the top again after
+ *  the bottom row.
+ * @param right Whether the viewport is going right; updated at the edges.
+ */
+static void Batch_Scroll(bool *right)
+{
+	uint16 oldPosition = g_viewportPosition;
+
+	if (Map_MoveDirection(*right ? 2 : 6) != oldPosition) return;
+
+	*right = !*right;
+	if (Map_MoveDirection(4) != oldPosition) return;
+
+	Map_SetViewportPosition(0);
+}
+
+/**
+ * Simulate a game. Like GameLoop_Main() does while playing, but one game tick
+ *  per iteration, as fast as possible, and only drawing in BATCH_MODE_DRAW.
+ *  The game runs in a GameContext of its own, so no state of an earlier job
+ *  leaks into it when the jobs run one after the other in this process.
+ * @param job The game to simulate.
+ * @param result Where to store how the game went.
+ */
+static void Batch_Simulate(const BatchJob *job, BatchResult *result)
+{
+	uint32 startTime = Profile_GetTime();
+	GameContext *context;
+	GameContext *oldContext;
+	uint16 harvestedAllied;
+	uint16 harvestedEnemy;
+	bool finished = false;
+	bool scrollRight = true;
+	uint32 tick;
+	uint32 now;
+
+	context = GameContext_Create();
+	if (context == NULL) {
+		Warning("Not enough memory to simulate the game\n");
+		result->status = BATCH_STATUS_FAILED;
+		return;
+	}
+	oldContext = GameContext_SetCurrent(context);
+	Snapshot_ResetCheck();
+
+	g_campaignID = job->campaignID;
+	g_playerHouseID = job->houseID;
+
+	Game_LoadScenario(job->houseID, job->scenarioID);
+
+	g_gameMode = GM_NORMAL;
+	g_selectionType = SELECTIONTYPE_STRUCTURE;
+	g_viewport_forceRedraw = true;
+
+	if (job->seed != 0) {
+		Tools_Random_Seed(job->seed);
+		Tools_RandomLCG_Seed((uint16)job->seed);
+	}
+
+	if (job->mode != BATCH_MODE_IDLE) {
+		PoolFindStruct find;
+
+		find.houseID = HOUSE_INVALID;
+		find.index   = 0xFFFF;
+		find.type    = 0xFFFF;
+
+		/* Nobody is there to see the AI, so it has to be active from the start */
+		while (true) {
+			House *h = House_Find(&find);
+			if (h == NULL) break;
+
+			h->flags.human = false;
+			h->flags.isAIActive = true;
+		}
+	}
+
+	for (tick = 0; tick < job->ticks && !finished; tick++) {
+		g_timerGUI++;
+		g_timerGame++;
+
+		now = Profile_GetTime();
+		GameLoop_Team();
+		result->teamTime += Profile_GetTime() - now;
+
+		now = Profile_GetTime();
+		GameLoop_Unit();
+		result->unitTime += Profile_GetTime() - now;
+
+		now = Profile_GetTime();
+		GameLoop_Structure();
+		result->structureTime += Profile_GetTime() - now;
+
+		now = Profile_GetTime();
+		GameLoop_House();
+		result->houseTime += Profile_GetTime() - now;
+
+		if (job->mode == BATCH_MODE_DRAW) {
+			Batch_Scroll(&scrollRight);
+
+			now = Profile_GetTime();
+			GUI_DrawScreen(SCREEN_0);
+			result->drawTime += Profile_GetTime() - now;
+			result->frames++;
+		} else {
+			/* GUI_DrawScreen() does these while playing */
+			Explosion_Tick();
+			Animation_Tick();
+		}
+
+		/* Like GameLoop_LevelEnd(), check every 300 ticks */
+		if ((tick % 300) == 299) finished = GameLoop_IsLevelFinished();
+
+		Snapshot_Check();
+	}
+
+	harvestedAllied = g_scenario.harvestedAllied;
+	harvestedEnemy  = g_scenario.harvestedEnemy;
+
+	result->status          = finished ? (GameLoop_IsLevelWon() ? BATCH_STATUS_WON : BATCH_STATUS_LOST) : BATCH_STATUS_UNFINISHED;
+	result->ticks           = tick;
+	result->killedAllied    = g_scenario.killedAllied;
+	result->killedEnemy     = g_scenario.killedEnemy;
+	result->destroyedAllied = g_scenario.destroyedAllied;
+	result->destroyedEnemy  = g_scenario.destroyedEnemy;
+	result->score           = GUI_EndStats_GetScore(g_scenario.score, &harvestedAllied, &harvestedEnemy, g_playerHouseID);
+	result->harvestedAllied = harvestedAllied;
+	result->harvestedEnemy  = harvestedEnemy;
+	result->wallTime        = Profile_GetTime() - startTime;
+
+	Snapshot_ResetCheck();
+	GameContext_SetCurrent(oldContext);
+	GameContext_Free(context);
+
+#if !defined(_WIN32) && !defined(TOS)
+	{
+		struct rusage usage;
+
+		if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+			/* OSX reports it in bytes, the others in KiB */
+			result->peakRSS = (uint32)(usage.ru_maxrss / 1024);
+#else
+			result->peakRSS = (uint32)usage.ru_maxrss;
+#endif /* __APPLE__ */
+		}
+	}
+#endif /* !_WIN32 && !TOS */
+}
+
+/**
+ * Get how many times something happened per second of wall time.
+ * @param amount How many times it happened.
+ * @param time The wall time in microseconds.
+ * @return The rate, or 0 if no time passed.
+ */
+static double Batch_GetRate(uint32 amount, uint32 time)
+{
+	if (time == 0) return 0.0;
+	return (double)amount * 1000000.0 / (double)time;
+}
+
+/**
+ * Write the report, as JSON if the filename ends with ".json", else as CSV.
+ *  Times are in microseconds, except for the wall time, which is in ms.
+ * @param fp Where to write to.
+ * @param json True to write JSON, false for CSV.
+ * @param jobs The jobs.
+ * @param results The result of every job.
+ * @param count The amount of jobs.
+ */
+static void Batch_WriteReport(FILE *fp, bool json, const BatchJob *jobs, const BatchResult *results, int count)
+{
+	int i;
+
+	if (json) {
+		fprintf(fp, "[\n");
+	} else {
+		fprintf(fp, "job,house,scenario,campaign,seed,mode,result,ticks,frames,wall_ms,ticks_per_s,frames_per_s,"
+		            "team_us,unit_us,structure_us,house_us,draw_us,peak_rss_kb,"
+		            "killed_allied,killed_enemy,destroyed_allied,destroyed_enemy,harvested_allied,harvested_enemy,score\n");
+	}
+
+	for (i = 0; i < count; i++) {
+		const BatchJob *j = &jobs[i];
+		const BatchResult *r = &results[i];
+
+		if (json) {
+			fprintf(fp, "\t{\"job\": %d, \"house\": \"%s\", \"scenario\": %u, \"campaign\": %u, \"seed\": %lu, \"mode\": \"%s\", "
+			            "\"result\": \"%s\", \"ticks\": %lu, \"frames\": %lu, \"wall_ms\": %lu, \"ticks_per_s\": %.1f, \"frames_per_s\": %.1f, "
+			            "\"team_us\": %lu, \"unit_us\": %lu, \"structure_us\": %lu, \"house_us\": %lu, \"draw_us\": %lu, \"peak_rss_kb\": %lu, "
+			            "\"killed_allied\": %u, \"killed_enemy\": %u, \"destroyed_allied\": %u, \"destroyed_enemy\": %u, "
+			            "\"harvested_allied\": %u, \"harvested_enemy\": %u, \"score\": %u}%s\n",
+				i + 1, g_table_HouseType[j->houseID].name, j->scenarioID, j->campaignID, (unsigned long)j->seed, s_batchModeNames[j->mode],
+				s_batchStatusNames[r->status], (unsigned long)r->ticks, (unsigned long)r->frames, (unsigned long)(r->wallTime / 1000),
+				Batch_GetRate(r->ticks, r->wallTime), Batch_GetRate(r->frames, r->wallTime),
+				(unsigned long)r->teamTime, (unsigned long)r->unitTime, (unsigned long)r->structureTime, (unsigned long)r->houseTime, (unsigned long)r->drawTime, (unsigned long)r->peakRSS,
+				r->killedAllied, r->killedEnemy, r->destroyedAllied, r->destroyedEnemy,
+				r->harvestedAllied, r->harvestedEnemy, r->score, (i + 1 < count) ? "," : "");
+		} else {
+			fprintf(fp, "%d,%s,%u,%u,%lu,%s,%s,%lu,%lu,%lu,%.1f,%.1f,%lu,%lu,%lu,%lu,%lu,%lu,%u,%u,%u,%u,%u,%u,%u\n",
+				i + 1, g_table_HouseType[j->houseID].name, j->scenarioID, j->campaignID, (unsigned long)j->seed, s_batchModeNames[j->mode],
+				s_batchStatusNames[r->status], (unsigned long)r->ticks, (unsigned long)r->frames, (unsigned long)(r->wallTime / 1000),
+				Batch_GetRate(r->ticks, r->wallTime), Batch_GetRate(r->frames, r->wallTime),
+				(unsigned long)r->teamTime, (unsigned long)r->unitTime, (unsigned long)r->structureTime, (unsigned long)r->houseTime, (unsigned long)r->drawTime, (unsigned long)r->peakRSS,
+				r->killedAllied, r->killedEnemy, r->destroyedAllied, r->destroyedEnemy,
+				r->harvestedAllied, r->harvestedEnemy, r->score);
+		}
+	}
+
+	if (json) fprintf(fp, "]\n");
+}
+
+#if !defined(_WIN32) && !defined(TOS)
+/**
+ * A worker process running a job.
+ */
+typedef struct BatchWorker {
+	pid_t pid;                                              /*!< The process, or 0 if this worker is free. */
+	int fd;                                                 /*!< Read end of the pipe the result comes through. */
+	int job;                                                /*!< The job the worker runs. */
+} BatchWorker;
+
+/**
+ * Start a worker process for a job. The worker inherits everything loaded
+ *  already, simulates the game and writes the BatchResult to a pipe.
+ * @param worker The worker to start.
+ * @param jobs The jobs.
+ * @param job The job to run.
+ * @return True if and only if the worker is running.
+ */
+static bool Batch_StartWorker(BatchWorker *worker, const BatchJob *jobs, int job)
+{
+	int fds[2];
+	pid_t pid;
+
+	if (pipe(fds) != 0) return false;
+
+	/* Don't let the worker flush what is buffered for the parent */
+	fflush(stdout);
+	fflush(stderr);
+
+	pid = fork();
+	if (pid < 0) {
+		close(fds[0]);
+		close(fds[1]);
+		return false;
+	}
+
+	if (pid == 0) {
+		BatchResult result;
+		const uint8 *data = (const uint8 *)&result;
+		size_t left = sizeof(result);
+
+		close(fds[0]);
+
+		memset(&result, 0, sizeof(result));
+		Batch_Simulate(&jobs[job], &result);
+
+		while (left != 0) {
+			ssize_t written = write(fds[1], data, left);
+			if (written <= 0) break;
+			data += written;
+			left -= written;
+		}
+		_exit(0);
+	}
+
+	close(fds[1]);
+
+	worker->pid = pid;
+	worker->fd  = fds[0];
+	worker->job = job;
+	return true;
+}
+
+/**
+ * Collect the result of a worker which finished.
+ * @param worker The worker.
+ * @param results The results of all jobs.
+ */
+static void Batch_FinishWorker(BatchWorker *worker, BatchResult *results)
+{
+	BatchResult result;
+	uint8 *data = (uint8 *)&result;
+	size_t left = sizeof(result);
+
+	while (left != 0) {
+		ssize_t got = read(worker->fd, data, left);
+		if (got <= 0) break;
+		data += got;
+		left -= got;
+	}
+	close(worker->fd);
+
+	if (left != 0) {
+		Warning("Batch job %d failed\n", worker->job + 1);
+		memset(&result, 0, sizeof(result));
+		result.status = BATCH_STATUS_FAILED;
+	}
+
+	results[worker->job] = result;
+	worker->pid = 0;
+}
+#endif /* !_WIN32 && !TOS */
+
+/**
+ * Run a list of games without screen, sound or input, and write a report of
+ *  how they went. Every game runs in its own worker process; the
+ *  "batchworkers" setting limits how many run at the same time, by default
+ *  one per processor. Without fork() the games run one after the other in
+ *  this process.
+ * @param jobFilename The file with the jobs, see Batch_ReadJobs().
+ * @param reportFilename The file to write the report to, or NULL for stdout.
+ * @return True if and only if all jobs were run and the report was written.
+ */
+bool Batch_Run(const char *jobFilename, const char *reportFilename)
+{
+	BatchJob *jobs;
+	BatchResult *results;
+	int count;
+	int failed = 0;
+	int i;
+	FILE *fp = stdout;
+	bool json = false;
+#if !defined(_WIN32) && !defined(TOS)
+	BatchWorker *workers;
+	int workerCount;
+	int next = 0;
+	int running = 0;
+#endif /* !_WIN32 && !TOS */
+
+	count = Batch_ReadJobs(jobFilename, &jobs);
+	if (count < 0) return false;
+
+	results = (BatchResult *)calloc(count + 1, sizeof(BatchResult));
+	if (results == NULL) {
+		Error("Out of memory starting the batch\n");
+		free(jobs);
+		return false;
+	}
+
+	/* Load everything once; the workers inherit it */
+	g_headless = true;
+	g_gameConfig.hints = 0;
+
+	if (!Init_Fonts()) {
+		Error("Can't load the fonts; are the Dune2 data files in the data directory?\n");
+		free(jobs);
+		free(results);
+		return false;
+	}
+	GFX_Init();
+	Font_Select(FontNew8Ptr);
+	GameLoop_Init();
+
+#if defined(_WIN32) || defined(TOS)
+	for (i = 0; i < count; i++) {
+		Batch_Simulate(&jobs[i], &results[i]);
+		if (results[i].status == BATCH_STATUS_FAILED) failed++;
+	}
+#else
+	workerCount = IniFile_GetInteger("batchworkers", 0);
+#if defined(_SC_NPROCESSORS_ONLN)
+	if (workerCount <= 0) workerCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif /* _SC_NPROCESSORS_ONLN */
+	if (workerCount <= 0) workerCount = 1;
+
+	workers = (BatchWorker *)calloc(workerCount, sizeof(BatchWorker));
+	if (workers == NULL) {
+		Error("Out of memory starting the batch\n");
+		free(jobs);
+		free(results);
+		return false;
+	}
+
+	while (next < count || running != 0) {
+		pid_t pid;
+
+		/* Keep all workers busy */
+		for (i = 0; i < workerCount && next < count; i++) {
+			if (workers[i].pid != 0) continue;
+
+			if (!Batch_StartWorker(&workers[i], jobs, next)) {
+				Warning("Can't start a worker for batch job %d\n", next + 1);
+				results[next].status = BATCH_STATUS_FAILED;
+				failed++;
+				next++;
+				continue;
+			}
+			next++;
+			running++;
+		}
+
+		if (running == 0) continue;
+
+		pid = wait(NULL);
+		if (pid < 0) break;
+
+		for (i = 0; i < workerCount; i++) {
+			if (workers[i].pid != pid) continue;
+
+			Batch_FinishWorker(&workers[i], results);
+			if (results[workers[i].job].status == BATCH_STATUS_FAILED) failed++;
+			running--;
+			break;
+		}
+	}
+
+	free(workers);
+#endif /* _WIN32 || TOS */
+
+	if (reportFilename != NULL) {
+		size_t length = strlen(reportFilename);
+
+		json = (length >= 5 && strcasecmp(reportFilename + length - 5, ".json") == 0);
+		fp = fopen(reportFilename, "w");
+		if (fp == NULL) {
+			Error("Can't write batch report '%s'\n", reportFilename);
+			free(jobs);
+			free(results);
+			return false;
+		}
+	}
+
+	Batch_WriteReport(fp, json, jobs, results, count);
+	if (fp != stdout) fclose(fp);
+
+	free(jobs);
+	free(results);
+	return (failed == 0);
+}
@@ -0,0 +1,8 @@
+/** @file src/batch.h Batch simulation definitions. */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+extern bool Batch_Run(const char *jobFilename, const char *reportFilename);
+
+#endif /* BATCH_H */
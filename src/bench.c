@@ -0,0 +1,825 @@
+/** @file src/bench.c Benchmarks of the pixel kernels, each on its own. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "types.h"
+#include "os/common.h"
+#include "os/endian.h"
+#include "os/error.h"
+#include "os/math.h"
+#include "os/strings.h"
+
+#include "bench.h"
+
+#include "codec/format40.h"
+#include "codec/format80.h"
+#include "file.h"
+#include "gfx.h"
+#include "gui/font.h"
+#include "gui/gui.h"
+#include "house.h"
+#include "opendune.h"
+#include "profile.h"
+#include "sprites.h"
+#include "unit.h"
+#if !defined(TOS)
+	#include "video/hqx.h"
+	#include "video/scalebit.h"
+#endif /* TOS */
+
+#define BENCH_PIXELS     (SCREEN_WIDTH * SCREEN_HEIGHT)     /*!< Size of a screen, and of the synthetic image. */
+#define BENCH_BUFFER     (BENCH_PIXELS * 4 * 4 * 4)         /*!< Size of the output buffer; enough for hq4x. */
+#define BENCH_INPUT      (BENCH_PIXELS * 3 + 3)             /*!< Size of the input buffer; enough for the worst synthetic stream. */
+#define BENCH_EVICT      (32 * 1024 * 1024)                 /*!< Bytes to write to push the buffers out of the caches. */
+#define BENCH_WARM_TIME  200000                             /*!< Minimal time in microseconds to run a kernel with warm caches. */
+#define BENCH_WARM_RUNS  3                                  /*!< Minimal amount of runs with warm caches. */
+#define BENCH_COLD_RUNS  16                                 /*!< Amount of runs with cold caches. */
+#define BENCH_TILES      16                                 /*!< Amount of different tiles GFX_DrawSprite() draws. */
+#define BENCH_TILE_SIZE  (16 * 16 / 2)                      /*!< Size of a tile of 16x16 pixels, with 2 pixels per byte. */
+#define BENCH_SHAPES     60                                 /*!< Amount of sprites Draw_Shape() draws, in a grid of 32x32 cells. */
+#define BENCH_SHAPE_KINDS 12                                /*!< Amount of different synthetic sprites for Draw_Shape(). */
+
+/**
+ * How the output of a kernel compares to the expected output.
+ */
+typedef enum BenchCheck {
+	BENCH_CHECK_SKIPPED  = 0,                               /*!< The input is not available; the kernel did not run. */
+	BENCH_CHECK_NONE     = 1,                               /*!< The input comes from the data files, so nothing is known to compare with. */
+	BENCH_CHECK_OK       = 2,                               /*!< The output is as expected. */
+	BENCH_CHECK_MISMATCH = 3                                /*!< The output differs from what is expected. */
+} BenchCheck;
+
+/**
+ * A kernel to benchmark, together with its input.
+ */
+typedef struct BenchCase {
+	const char *kernel;                                     /*!< Name of the kernel. */
+	const char *input;                                      /*!< Name of the input. */
+	bool (*setup)(void);                                    /*!< Prepare the input and the output; returns false if the input is not available. */
+	void (*run)(void);                                      /*!< Run the kernel once. */
+	uint32 golden;                                          /*!< Hash of the output after one run, or 0 if the input comes from the data files. */
+} BenchCase;
+
+/**
+ * The outcome of benchmarking a kernel.
+ */
+typedef struct BenchResult {
+	uint8  check;                                           /*!< How the output compares, see BenchCheck. */
+	uint32 pixels;                                          /*!< Pixels written by one run. */
+	uint32 hash;                                            /*!< Hash of the output after one run. */
+	uint32 warmRuns;                                        /*!< Amount of runs with warm caches. */
+	double warmTime;                                        /*!< Time per pixel with warm caches in ns. */
+	uint32 coldRuns;                                        /*!< Amount of runs with cold caches. */
+	double coldTime;                                        /*!< Time per pixel with cold caches in ns. */
+} BenchResult;
+
+static const char * const s_benchCheckNames[] = { "skipped", "none", "ok", "mismatch" };
+
+static uint32 s_benchRandom;                                /*!< State of Bench_Random(). */
+static uint8 *s_benchImage = NULL;                          /*!< A synthetic screen, with flat areas, noise, edges and transparent pixels. */
+static uint8 *s_benchInput = NULL;                          /*!< The encoded input of the codecs. */
+static uint8 *s_benchFile = NULL;                           /*!< A file from the data files. */
+static uint8 *s_benchBuffer = NULL;                         /*!< Output of the kernels which don't draw on a screen. */
+static uint8 *s_benchEvict = NULL;                          /*!< Memory written to push everything else out of the caches. */
+static const uint8 *s_benchSource;                          /*!< The encoded input of the current case. */
+static const uint8 *s_benchOutput;                          /*!< The output of the current case. */
+static uint32 s_benchOutputSize;                            /*!< Size of the output of the current case in bytes. */
+static bool s_benchOutputWords;                             /*!< Whether the output of the current case is in native endian 32 bit words. */
+static uint32 s_benchPixels;                                /*!< Pixels written by one run of the current case. */
+static const uint16 *s_benchTiles;                          /*!< The sprite IDs of the tiles GFX_DrawSprite() draws in the current case. */
+static const uint8 *s_benchShapes[BENCH_SHAPES];            /*!< The sprites Draw_Shape() draws in the current case. */
+static const uint8 *s_benchRemap;                           /*!< The remap table of Draw_Shape() in the current case. */
+static uint8 *s_benchIconPixels = NULL;                     /*!< The tiles of ICON.ICN, if loaded. */
+static uint8 *s_benchIconTable = NULL;                      /*!< The palette index of every tile of ICON.ICN, if loaded. */
+static uint8 *s_benchIconPalettes = NULL;                   /*!< The palettes of the tiles of ICON.ICN, if loaded. */
+#if !defined(TOS)
+static uint32_t s_benchPalette[256];                        /*!< The palette of the hqx scalers, as the video driver makes it. */
+#endif /* TOS */
+
+/**
+ * Get a pseudo random number, the same on every platform and build.
+ * @return A number between 0 and 0x7FFF.
+ */
+static uint16 Bench_Random(void)
+{
+	s_benchRandom = s_benchRandom * 1103515245 + 12345;
+	return (uint16)((s_benchRandom >> 16) & 0x7FFF);
+}
+
+/**
+ * Hash data with FNV-1a.
+ * @param data The data.
+ * @param size The size of the data in bytes.
+ * @param words Whether the data are 32 bit words, which are hashed in little endian order.
+ * @return The hash.
+ */
+static uint32 Bench_Hash(const uint8 *data, uint32 size, bool words)
+{
+	uint32 hash = 0x811C9DC5;
+	uint32 i;
+
+	if (words) {
+		const uint32 *w = (const uint32 *)data;
+
+		for (i = 0; i < size / 4; i++) {
+			uint8 b;
+
+			for (b = 0; b < 4; b++) {
+				hash ^= (w[i] >> (b * 8)) & 0xFF;
+				hash *= 0x01000193;
+			}
+		}
+		return hash;
+	}
+
+	for (i = 0; i < size; i++) {
+		hash ^= data[i];
+		hash *= 0x01000193;
+	}
+	return hash;
+}
+
+/**
+ * Make the synthetic screen: 16x16 blocks of landscape like colours with some
+ *  noise, hard diagonal edges and transparent holes, like sprites on a map.
+ */
+static void Bench_MakeImage(void)
+{
+	static const uint8 baseColours[6] = { 0x20, 0x38, 0x50, 0x68, 0x90, 0xC0 };
+	uint16 x;
+	uint16 y;
+
+	s_benchRandom = 1;
+
+	for (y = 0; y < SCREEN_HEIGHT; y++) {
+		for (x = 0; x < SCREEN_WIDTH; x++) {
+			uint16 block = (x >> 4) + (y >> 4) * (SCREEN_WIDTH >> 4);
+			uint8 colour = baseColours[(block * 7) % 6];
+
+			if ((Bench_Random() & 7) == 0) colour += 1 + (Bench_Random() & 1);
+			if (((x + y) % 37) < 2) colour = 0xFF;
+			if ((block % 5) == 0 && (x & 15) > 3 && (x & 15) < 12 && (y & 15) > 3 && (y & 15) < 12) colour = 0;
+
+			s_benchImage[y * SCREEN_WIDTH + x] = colour;
+		}
+	}
+}
+
+/**
+ * Encode a synthetic screen as 'format80', with a mix of the commands which
+ *  is alike the one in the data files.
+ */
+static void Bench_MakeLCW(void)
+{
+	uint8 *s = s_benchInput;
+	uint32 written = 0;
+
+	s_benchRandom = 2;
+
+	while (written < BENCH_PIXELS) {
+		uint16 kind = Bench_Random() % 100;
+		uint16 size;
+		uint16 offset;
+
+		if (written < 64 || kind < 30) {
+			/* Short copy */
+			size = 1 + Bench_Random() % 63;
+			*s++ = 0x80 | size;
+			for (offset = 0; offset < size; offset++) *s++ = s_benchImage[(written + offset) % BENCH_PIXELS];
+		} else if (kind < 60) {
+			/* Short move, relative */
+			size = 3 + Bench_Random() % 8;
+			offset = 1 + Bench_Random() % (uint16)min(written, 0xFFFU);
+			*s++ = ((size - 3) << 4) | (offset >> 8);
+			*s++ = offset & 0xFF;
+		} else if (kind < 75) {
+			/* Short move, absolute; only from what is decoded already */
+			size = 3 + Bench_Random() % 59;
+			offset = (uint16)(Bench_Random() % (written - size));
+			*s++ = 0xC0 | (size - 3);
+			*s++ = offset & 0xFF;
+			*s++ = offset >> 8;
+		} else if (kind < 85 && written > 1024) {
+			/* Long move, absolute; only from what is decoded already */
+			size = 64 + Bench_Random() % 512;
+			offset = (uint16)(Bench_Random() % (written - size));
+			*s++ = 0xFF;
+			*s++ = size & 0xFF;
+			*s++ = size >> 8;
+			*s++ = offset & 0xFF;
+			*s++ = offset >> 8;
+		} else {
+			/* Long set */
+			size = 16 + Bench_Random() % 400;
+			*s++ = 0xFE;
+			*s++ = size & 0xFF;
+			*s++ = size >> 8;
+			*s++ = s_benchImage[written % BENCH_PIXELS];
+		}
+
+		written += size;
+	}
+
+	*s++ = 0x80;
+}
+
+/**
+ * Encode a synthetic delta between two frames as 'format40', with the short
+ *  and long forms of every command.
+ */
+static void Bench_MakeXORDelta(void)
+{
+	uint8 *s = s_benchInput;
+	uint32 left = BENCH_PIXELS;
+
+	s_benchRandom = 3;
+
+	while (left != 0) {
+		uint16 kind = Bench_Random() % 100;
+		uint16 size;
+		uint16 i;
+
+		if (kind < 30) {
+			/* Skip bytes */
+			size = (uint16)min(left, (uint32)(1 + Bench_Random() % 127));
+			*s++ = 0x80 | size;
+		} else if (kind < 55) {
+			/* XOR with string */
+			size = (uint16)min(left, (uint32)(1 + Bench_Random() % 127));
+			*s++ = (uint8)size;
+			for (i = 0; i < size; i++) *s++ = (uint8)Bench_Random();
+		} else if (kind < 75) {
+			/* XOR with value */
+			size = (uint16)min(left, (uint32)(1 + Bench_Random() % 255));
+			*s++ = 0;
+			*s++ = (uint8)size;
+			*s++ = (uint8)Bench_Random();
+		} else if (kind < 85) {
+			/* Long skip */
+			size = (uint16)min(left, (uint32)(128 + Bench_Random() % 1024));
+			*s++ = 0x80;
+			*s++ = size & 0xFF;
+			*s++ = size >> 8;
+		} else if (kind < 92) {
+			/* Long XOR with string */
+			size = (uint16)min(left, (uint32)(128 + Bench_Random() % 512));
+			*s++ = 0x80;
+			*s++ = size & 0xFF;
+			*s++ = 0x80 | (size >> 8);
+			for (i = 0; i < size; i++) *s++ = (uint8)Bench_Random();
+		} else {
+			/* Long XOR with value */
+			size = (uint16)min(left, (uint32)(128 + Bench_Random() % 1024));
+			*s++ = 0x80;
+			*s++ = size & 0xFF;
+			*s++ = 0xC0 | (size >> 8);
+			*s++ = (uint8)Bench_Random();
+		}
+
+		left -= size;
+	}
+
+	*s++ = 0x80;
+	*s++ = 0;
+	*s++ = 0;
+}
+
+/**
+ * Make BENCH_TILES synthetic tiles for GFX_DrawSprite(), of 16x16 pixels,
+ *  each with a palette of its own. The palettes only use the house colours
+ *  which are recoloured both with and without g_dune2_enhanced, so the output
+ *  is the same either way.
+ */
+static void Bench_MakeTiles(void)
+{
+	uint8 *pixels   = s_benchInput;
+	uint8 *table    = pixels + BENCH_TILES * BENCH_TILE_SIZE;
+	uint8 *palettes = table + BENCH_TILES;
+	uint16 i;
+
+	s_benchRandom = 4;
+
+	for (i = 0; i < BENCH_TILES * BENCH_TILE_SIZE; i++) pixels[i] = (uint8)Bench_Random();
+	for (i = 0; i < BENCH_TILES; i++) table[i] = (uint8)i;
+
+	for (i = 0; i < BENCH_TILES * 16; i++) {
+		uint8 colour = (uint8)Bench_Random();
+
+		if (colour > 0x96 && colour <= 0xA0) colour -= 0x10;
+		palettes[i] = ((i & 0xF) == 0) ? 0 : colour;
+	}
+}
+
+/**
+ * Make BENCH_SHAPE_KINDS synthetic sprites for Draw_Shape(), with runs of
+ *  transparent pixels; every other one has house colours. They are not
+ *  'format80' encoded, as LCW_Uncomp() is benchmarked on its own. A remap
+ *  table follows the sprites.
+ */
+static void Bench_MakeShapes(void)
+{
+	const uint8 *shapes[BENCH_SHAPE_KINDS];
+	uint8 *s = s_benchInput;
+	uint16 i;
+
+	s_benchRandom = 5;
+
+	for (i = 0; i < BENCH_SHAPE_KINDS; i++) {
+		bool houseColours = (i & 1) != 0;
+		uint16 width  = 16 + Bench_Random() % 17;
+		uint16 height = 16 + Bench_Random() % 17;
+		uint8 *header = s;
+		uint8 *data;
+		uint16 x;
+		uint16 y;
+
+		shapes[i] = header;
+
+		WRITE_LE_UINT16(s, houseColours ? 0x3 : 0x2);
+		s[2] = (uint8)height;
+		WRITE_LE_UINT16(s + 3, width);
+		s[5] = (uint8)height;
+		s += 10;
+
+		if (houseColours) {
+			for (x = 0; x < 16; x++) *s++ = (uint8)(0x90 + x);
+		}
+
+		data = s;
+		for (y = 0; y < height; y++) {
+			x = 0;
+			while (x < width) {
+				uint16 size;
+
+				if ((Bench_Random() & 3) != 0) {
+					*s++ = (uint8)(1 + Bench_Random() % (houseColours ? 15 : 255));
+					x++;
+					continue;
+				}
+
+				/* Run of transparent pixels; never past the end of the row */
+				size = min(width - x, 1 + Bench_Random() % 8);
+				*s++ = 0;
+				*s++ = (uint8)size;
+				x += size;
+			}
+		}
+
+		WRITE_LE_UINT16(header + 6, (uint16)(s - header));
+		WRITE_LE_UINT16(header + 8, (uint16)(s - data));
+	}
+
+	for (i = 0; i < BENCH_SHAPES; i++) s_benchShapes[i] = shapes[i % BENCH_SHAPE_KINDS];
+
+	s_benchRemap = s;
+	for (i = 0; i < 256; i++) *s++ = (uint8)Bench_Random();
+}
+
+/**
+ * Use a buffer as output of the current case.
+ * @param output The output.
+ * @param size The size of the output in bytes.
+ * @param pixels The amount of pixels written by one run.
+ */
+static void Bench_SetOutput(const uint8 *output, uint32 size, uint32 pixels)
+{
+	s_benchOutput      = output;
+	s_benchOutputSize  = size;
+	s_benchOutputWords = false;
+	s_benchPixels      = pixels;
+}
+
+static bool Bench_Setup_LCW(void)
+{
+	Bench_MakeLCW();
+	s_benchSource = s_benchInput;
+	Bench_SetOutput(s_benchBuffer, BENCH_PIXELS, BENCH_PIXELS);
+	return true;
+}
+
+static bool Bench_Setup_LCW_CPS(void)
+{
+	if (!File_Exists("SCREEN.CPS")) return false;
+
+	free(s_benchFile);
+	s_benchFile = Read_FileWholeFile("SCREEN.CPS");
+
+	/* Only LCW encoded images are of interest */
+	if (s_benchFile[2] != 0x4) return false;
+
+	s_benchSource = s_benchFile + 10 + READ_LE_UINT16(s_benchFile + 8);
+	Bench_SetOutput(s_benchBuffer, BENCH_PIXELS, BENCH_PIXELS);
+	return true;
+}
+
+static void Bench_Run_LCW(void)
+{
+	LCW_Uncomp(s_benchBuffer, s_benchSource, BENCH_PIXELS);
+}
+
+static bool Bench_Setup_XORDelta(void)
+{
+	Bench_MakeXORDelta();
+	memcpy(s_benchBuffer, s_benchImage, BENCH_PIXELS);
+	Bench_SetOutput(s_benchBuffer, BENCH_PIXELS, BENCH_PIXELS);
+	return true;
+}
+
+static void Bench_Run_XORDelta(void)
+{
+	Apply_XOR_Delta(s_benchBuffer, s_benchInput);
+}
+
+static bool Bench_Setup_ScreenCopy(void)
+{
+	memcpy(Get_Page(SCREEN_1), s_benchImage, BENCH_PIXELS);
+	memset(Get_Page(SCREEN_2), 0x11, BENCH_PIXELS);
+
+	/* GFX_Screen_Copy2() refuses a full width or height */
+	Bench_SetOutput(Get_Page(SCREEN_2), BENCH_PIXELS, (SCREEN_WIDTH - 1) * (SCREEN_HEIGHT - 1));
+	return true;
+}
+
+static void Bench_Run_ScreenCopy(void)
+{
+	GFX_Screen_Copy2(0, 0, 0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1, SCREEN_1, SCREEN_2, false);
+}
+
+static void Bench_Run_ScreenCopySkipNull(void)
+{
+	GFX_Screen_Copy2(0, 0, 0, 0, SCREEN_WIDTH - 1, SCREEN_HEIGHT - 1, SCREEN_1, SCREEN_2, true);
+}
+
+/**
+ * Make GFX_DrawSprite() use the given tiles.
+ * @param pixels The pixels of the tiles.
+ * @param table The palette index of every tile.
+ * @param palettes The palettes.
+ */
+static void Bench_SelectTiles(uint8 *pixels, uint8 *table, uint8 *palettes)
+{
+	g_spritePixels = pixels;
+	g_iconRTBL     = table;
+	g_iconRPAL     = palettes;
+
+	/* The tiles of ICON.ICN are 16x16 pixels too */
+	GFX_Init_SpriteInfo(2, 2);
+
+	memset(Get_Page(SCREEN_1), 0, BENCH_PIXELS);
+	Bench_SetOutput(Get_Page(SCREEN_1), BENCH_PIXELS, BENCH_PIXELS - (SCREEN_HEIGHT % 16) * SCREEN_WIDTH);
+}
+
+static bool Bench_Setup_DrawSprite(void)
+{
+	static const uint16 tiles[BENCH_TILES] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+
+	Bench_MakeTiles();
+	Bench_SelectTiles(s_benchInput, s_benchInput + BENCH_TILES * BENCH_TILE_SIZE, s_benchInput + BENCH_TILES * (BENCH_TILE_SIZE + 1));
+	s_benchTiles = tiles;
+	return true;
+}
+
+static bool Bench_Setup_DrawSprite_ICN(void)
+{
+	if (s_benchIconPixels == NULL || g_iconMap == NULL) return false;
+
+	Bench_SelectTiles(s_benchIconPixels, s_benchIconTable, s_benchIconPalettes);
+	s_benchTiles = g_iconMap + g_iconMap[ICM_ICONGROUP_LANDSCAPE];
+	return true;
+}
+
+static void Bench_Run_DrawSprite(void)
+{
+	Screen oldScreenID = _Set_LogicPage(SCREEN_1);
+	uint16 x;
+	uint16 y;
+
+	/* Fill the screen with tiles, as the viewport does */
+	for (y = 0; y < SCREEN_HEIGHT / 16; y++) {
+		for (x = 0; x < SCREEN_WIDTH / 16; x++) {
+			GFX_DrawSprite(s_benchTiles[(x + y) % BENCH_TILES], x << 4, y << 4, y % HOUSE_MAX);
+		}
+	}
+
+	_Set_LogicPage(oldScreenID);
+}
+
+/**
+ * Draw the sprites of the current case, in a grid of 32x32 cells.
+ * @param flags The flags for Draw_Shape(); 0 or 0x100.
+ * @return The amount of pixels the sprites cover.
+ */
+static uint32 Bench_DrawShapes(uint16 flags)
+{
+	uint32 pixels = 0;
+	uint16 i;
+
+	for (i = 0; i < BENCH_SHAPES; i++) {
+		const uint8 *sprite = s_benchShapes[i];
+		int16 x = (i % 10) * 32;
+		int16 y = (i / 10) * 32;
+
+		if (sprite == NULL) continue;
+		pixels += READ_LE_UINT16(sprite + 3) * sprite[2];
+
+		if (flags == 0) {
+			Draw_Shape(SCREEN_1, sprite, x, y, 0, 0);
+		} else {
+			Draw_Shape(SCREEN_1, sprite, x, y, 0, 0x100, s_benchRemap, 1);
+		}
+	}
+
+	return pixels;
+}
+
+/**
+ * Use the screen as output of the Draw_Shape() cases.
+ */
+static void Bench_SetShapesOutput(void)
+{
+	memset(Get_Page(SCREEN_1), 0, BENCH_PIXELS);
+	Bench_SetOutput(Get_Page(SCREEN_1), BENCH_PIXELS, Bench_DrawShapes(0));
+	memset(Get_Page(SCREEN_1), 0, BENCH_PIXELS);
+}
+
+static bool Bench_Setup_DrawShape(void)
+{
+	Bench_MakeShapes();
+	Bench_SetShapesOutput();
+	return true;
+}
+
+static bool Bench_Setup_DrawShape_SHP(void)
+{
+	uint16 i;
+
+	if (g_sprites == NULL) return false;
+
+	/* The ground sprite of every Unit type */
+	for (i = 0; i < BENCH_SHAPES; i++) s_benchShapes[i] = g_sprites[g_table_unitInfo[i % UNIT_MAX].groundSpriteID];
+	s_benchRemap = g_paletteMapping1;
+
+	Bench_SetShapesOutput();
+	return true;
+}
+
+static void Bench_Run_DrawShape(void)
+{
+	Bench_DrawShapes(0);
+}
+
+static void Bench_Run_DrawShapeRemap(void)
+{
+	Bench_DrawShapes(0x100);
+}
+
+#if !defined(TOS)
+/**
+ * Use the output buffer for an image scaled from the synthetic screen.
+ * @param factor How much the image is scaled.
+ * @param bytesPerPixel Size of an output pixel.
+ */
+static void Bench_SetScaledOutput(uint16 factor, uint16 bytesPerPixel)
+{
+	uint32 pixels = BENCH_PIXELS * factor * factor;
+
+	Bench_SetOutput(s_benchBuffer, pixels * bytesPerPixel, pixels);
+	s_benchOutputWords = (bytesPerPixel == 4);
+}
+
+static bool Bench_Setup_Scale2x(void) { Bench_SetScaledOutput(2, 1); return true; }
+static bool Bench_Setup_Scale3x(void) { Bench_SetScaledOutput(3, 1); return true; }
+static bool Bench_Setup_Scale4x(void) { Bench_SetScaledOutput(4, 1); return true; }
+static bool Bench_Setup_HQ2x(void)    { Bench_SetScaledOutput(2, 4); return true; }
+static bool Bench_Setup_HQ3x(void)    { Bench_SetScaledOutput(3, 4); return true; }
+static bool Bench_Setup_HQ4x(void)    { Bench_SetScaledOutput(4, 4); return true; }
+
+static void Bench_Run_Scale2x(void) { scale(2, s_benchBuffer, SCREEN_WIDTH * 2, s_benchImage, SCREEN_WIDTH, 1, SCREEN_WIDTH, SCREEN_HEIGHT); }
+static void Bench_Run_Scale3x(void) { scale(3, s_benchBuffer, SCREEN_WIDTH * 3, s_benchImage, SCREEN_WIDTH, 1, SCREEN_WIDTH, SCREEN_HEIGHT); }
+static void Bench_Run_Scale4x(void) { scale(4, s_benchBuffer, SCREEN_WIDTH * 4, s_benchImage, SCREEN_WIDTH, 1, SCREEN_WIDTH, SCREEN_HEIGHT); }
+static void Bench_Run_HQ2x(void)    { hq2x_8to32_rb(s_benchImage, SCREEN_WIDTH, (uint32_t *)s_benchBuffer, SCREEN_WIDTH * 2 * 4, SCREEN_WIDTH, SCREEN_HEIGHT, s_benchPalette); }
+static void Bench_Run_HQ3x(void)    { hq3x_8to32_rb(s_benchImage, SCREEN_WIDTH, (uint32_t *)s_benchBuffer, SCREEN_WIDTH * 3 * 4, SCREEN_WIDTH, SCREEN_HEIGHT, s_benchPalette); }
+static void Bench_Run_HQ4x(void)    { hq4x_8to32_rb(s_benchImage, SCREEN_WIDTH, (uint32_t *)s_benchBuffer, SCREEN_WIDTH * 4 * 4, SCREEN_WIDTH, SCREEN_HEIGHT, s_benchPalette); }
+#endif /* TOS */
+
+/** The kernels to benchmark. The golden hashes only change when a kernel, or the synthetic input, changes on purpose. */
+static const BenchCase s_benchCases[] = {
+	{ "LCW_Uncomp",            "synthetic",  Bench_Setup_LCW,            Bench_Run_LCW,                0x85E881CF },
+	{ "LCW_Uncomp",            "SCREEN.CPS", Bench_Setup_LCW_CPS,        Bench_Run_LCW,                0x00000000 },
+	{ "Apply_XOR_Delta",       "synthetic",  Bench_Setup_XORDelta,       Bench_Run_XORDelta,           0x7568F3BD },
+	{ "GFX_Screen_Copy2",      "synthetic",  Bench_Setup_ScreenCopy,     Bench_Run_ScreenCopy,         0x124A08D1 },
+	{ "GFX_Screen_Copy2/skip", "synthetic",  Bench_Setup_ScreenCopy,     Bench_Run_ScreenCopySkipNull, 0xB4AE8A11 },
+	{ "GFX_DrawSprite",        "synthetic",  Bench_Setup_DrawSprite,     Bench_Run_DrawSprite,         0xDA5DFEFB },
+	{ "GFX_DrawSprite",        "ICON.ICN",   Bench_Setup_DrawSprite_ICN, Bench_Run_DrawSprite,         0x00000000 },
+	{ "Draw_Shape",            "synthetic",  Bench_Setup_DrawShape,      Bench_Run_DrawShape,          0x6326AB7D },
+	{ "Draw_Shape",            "UNITS*.SHP", Bench_Setup_DrawShape_SHP,  Bench_Run_DrawShape,          0x00000000 },
+	{ "Draw_Shape/remap",      "synthetic",  Bench_Setup_DrawShape,      Bench_Run_DrawShapeRemap,     0xFC8C66E4 },
+	{ "Draw_Shape/remap",      "UNITS*.SHP", Bench_Setup_DrawShape_SHP,  Bench_Run_DrawShapeRemap,     0x00000000 },
+#if !defined(TOS)
+	{ "scale/2x",              "synthetic",  Bench_Setup_Scale2x,        Bench_Run_Scale2x,            0x0A16D682 },
+	{ "scale/3x",              "synthetic",  Bench_Setup_Scale3x,        Bench_Run_Scale3x,            0xF2A71284 },
+	{ "scale/4x",              "synthetic",  Bench_Setup_Scale4x,        Bench_Run_Scale4x,            0xE643B76A },
+	{ "hq2x_8to32_rb",         "synthetic",  Bench_Setup_HQ2x,           Bench_Run_HQ2x,               0x50C98DC7 },
+	{ "hq3x_8to32_rb",         "synthetic",  Bench_Setup_HQ3x,           Bench_Run_HQ3x,               0x8BE83997 },
+	{ "hq4x_8to32_rb",         "synthetic",  Bench_Setup_HQ4x,           Bench_Run_HQ4x,               0x3D1E0D71 },
+#endif /* TOS */
+};
+
+/**
+ * Push the buffers of the kernels out of the caches, by writing more memory
+ *  than the caches hold.
+ */
+static void Bench_EvictCaches(void)
+{
+	static uint8 value = 0;
+
+	memset(s_benchEvict, ++value, BENCH_EVICT);
+}
+
+/**
+ * Benchmark a kernel. It first runs once, to check its output; then as often
+ *  as fits in BENCH_WARM_TIME with warm caches; then BENCH_COLD_RUNS times,
+ *  each time after evicting the caches.
+ * @param c The kernel and its input.
+ * @param result Where to store the outcome.
+ */
+static void Bench_Case(const BenchCase *c, BenchResult *result)
+{
+	uint32 start;
+	uint32 total;
+
+	memset(result, 0, sizeof(BenchResult));
+
+	if (!c->setup()) {
+		result->check = BENCH_CHECK_SKIPPED;
+		return;
+	}
+
+	c->run();
+
+	result->pixels = s_benchPixels;
+	result->hash   = Bench_Hash(s_benchOutput, s_benchOutputSize, s_benchOutputWords);
+	if (c->golden == 0) {
+		result->check = BENCH_CHECK_NONE;
+	} else {
+		result->check = (result->hash == c->golden) ? BENCH_CHECK_OK : BENCH_CHECK_MISMATCH;
+	}
+
+	if (s_benchPixels == 0) return;
+
+	start = Profile_GetTime();
+	do {
+		c->run();
+		result->warmRuns++;
+		total = Profile_GetTime() - start;
+	} while (result->warmRuns < BENCH_WARM_RUNS || total < BENCH_WARM_TIME);
+	result->warmTime = (double)total * 1000.0 / ((double)result->warmRuns * s_benchPixels);
+
+	if (s_benchEvict == NULL) return;
+
+	total = 0;
+	for (; result->coldRuns < BENCH_COLD_RUNS; result->coldRuns++) {
+		Bench_EvictCaches();
+
+		start = Profile_GetTime();
+		c->run();
+		total += Profile_GetTime() - start;
+	}
+	result->coldTime = (double)total * 1000.0 / ((double)result->coldRuns * s_benchPixels);
+}
+
+/**
+ * Write the report, as JSON if the filename ends with ".json", else as CSV.
+ * @param fp Where to write to.
+ * @param json True to write JSON, false for CSV.
+ * @param results The result of every case.
+ */
+static void Bench_WriteReport(FILE *fp, bool json, const BenchResult *results)
+{
+	uint16 i;
+
+	if (json) {
+		fprintf(fp, "[\n");
+	} else {
+		fprintf(fp, "kernel,input,check,hash,pixels,warm_runs,warm_ns_per_pixel,cold_runs,cold_ns_per_pixel\n");
+	}
+
+	for (i = 0; i < lengthof(s_benchCases); i++) {
+		const BenchCase *c = &s_benchCases[i];
+		const BenchResult *r = &results[i];
+
+		if (json) {
+			fprintf(fp, "\t{\"kernel\": \"%s\", \"input\": \"%s\", \"check\": \"%s\", \"hash\": \"%08lX\", \"pixels\": %lu, "
+			            "\"warm_runs\": %lu, \"warm_ns_per_pixel\": %.3f, \"cold_runs\": %lu, \"cold_ns_per_pixel\": %.3f}%s\n",
+				c->kernel, c->input, s_benchCheckNames[r->check], (unsigned long)r->hash, (unsigned long)r->pixels,
+				(unsigned long)r->warmRuns, r->warmTime, (unsigned long)r->coldRuns, r->coldTime,
+				((size_t)i + 1 < lengthof(s_benchCases)) ? "," : "");
+		} else {
+			fprintf(fp, "%s,%s,%s,%08lX,%lu,%lu,%.3f,%lu,%.3f\n",
+				c->kernel, c->input, s_benchCheckNames[r->check], (unsigned long)r->hash, (unsigned long)r->pixels,
+				(unsigned long)r->warmRuns, r->warmTime, (unsigned long)r->coldRuns, r->coldTime);
+		}
+	}
+
+	if (json) fprintf(fp, "]\n");
+}
+
+/**
+ * Benchmark every pixel kernel on its own, and write a report of the time
+ *  they take per pixel, with warm and with cold caches. Synthetic inputs are
+ *  the same on every platform, so their output is checked against a known
+ *  hash; inputs from the data files are used if those are available.
+ * @param reportFilename The file to write the report to, or NULL for stdout.
+ * @return True if and only if no output was different from what is expected.
+ */
+bool Bench_Run(const char *reportFilename)
+{
+	BenchResult results[lengthof(s_benchCases)];
+	bool ok = true;
+	uint16 i;
+	FILE *fp = stdout;
+	bool json = false;
+
+	s_benchImage  = (uint8 *)malloc(BENCH_PIXELS);
+	s_benchInput  = (uint8 *)malloc(BENCH_INPUT);
+	s_benchBuffer = (uint8 *)malloc(BENCH_BUFFER);
+	s_benchEvict  = (uint8 *)malloc(BENCH_EVICT);
+
+	if (s_benchImage == NULL || s_benchInput == NULL || s_benchBuffer == NULL) {
+		Error("Out of memory starting the benchmarks\n");
+		ok = false;
+		goto out;
+	}
+	if (s_benchEvict == NULL) Warning("Not enough memory to evict the caches; only measuring with warm caches\n");
+
+	Bench_MakeImage();
+
+	g_headless = true;
+	GFX_Init();
+
+	if (Init_Fonts()) {
+		Font_Select(FontNew8Ptr);
+		GameLoop_Init();
+		Sprites_LoadTiles();
+	} else {
+		Warning("Can't load the fonts; only benchmarking synthetic inputs\n");
+	}
+
+#if !defined(TOS)
+	hqxInit();
+
+	for (i = 0; i < 256; i++) {
+		/* Like Video_SetPalette() does, for a palette with all kinds of colours */
+		uint8 r = i & 0x3F;
+		uint8 g = (i * 7) & 0x3F;
+		uint8 b = (i * 13) & 0x3F;
+
+		s_benchPalette[i] = 0xFF000000 | (((r * 0x41) << 12) & 0x00FF0000) | (((g * 0x41) << 4) & 0x0000FF00) | ((b * 0x41) >> 4);
+	}
+#endif /* TOS */
+
+	/* The synthetic tiles take the place of those of ICON.ICN while benchmarking */
+	s_benchIconPixels   = g_spritePixels;
+	s_benchIconTable    = g_iconRTBL;
+	s_benchIconPalettes = g_iconRPAL;
+
+	for (i = 0; i < lengthof(s_benchCases); i++) {
+		Bench_Case(&s_benchCases[i], &results[i]);
+		if (results[i].check == BENCH_CHECK_MISMATCH) {
+			Warning("%s on %s gives a different output than expected\n", s_benchCases[i].kernel, s_benchCases[i].input);
+			ok = false;
+		}
+	}
+
+	g_spritePixels = s_benchIconPixels;
+	g_iconRTBL     = s_benchIconTable;
+	g_iconRPAL     = s_benchIconPalettes;
+
+#if !defined(TOS)
+	hqxUnInit();
+#endif /* TOS */
+
+	if (reportFilename != NULL) {
+		size_t length = strlen(reportFilename);
+
+		json = (length >= 5 && strcasecmp(reportFilename + length - 5, ".json") == 0);
+		fp = fopen(reportFilename, "w");
+		if (fp == NULL) {
+			Error("Can't write benchmark report '%s'\n", reportFilename);
+			ok = false;
+			goto out;
+		}
+	}
+
+	Bench_WriteReport(fp, json, results);
+	if (fp != stdout) fclose(fp);
+
+out:
+	free(s_benchImage); s_benchImage = NULL;
+	free(s_benchInput); s_benchInput = NULL;
+	free(s_benchBuffer); s_benchBuffer = NULL;
+	free(s_benchEvict); s_benchEvict = NULL;
+	free(s_benchFile); s_benchFile = NULL;
+	return ok;
+}
@@ -0,0 +1,8 @@
+/** @file src/bench.h Pixel kernel benchmark definitions. */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+extern bool Bench_Run(const char *reportFilename);
+
+#endif /* BENCH_H */
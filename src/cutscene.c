@@ -16,6 +16,7 @@
 #include "audio/sound.h"
 #include "config.h"
 #include "file.h"
+#include "gamecontext.h"
 #include "gfx.h"
 #include "gui/font.h"
 #include "gui/gui.h"
@@ -9,6 +9,7 @@
 
 #include "animation.h"
 #include "audio/sound.h"
+#include "gamecontext.h"
 #include "house.h"
 #include "map.h"
 #include "sprites.h"
@@ -21,8 +22,8 @@
 #include "video/video.h"
 
 
-static Explosion g_explosions[EXPLOSION_MAX];               /*!< Explosions. */
-static uint32 s_explosionTimer = 0;                         /*!< Timeout value for next explosion activity. */
+#define g_explosions     (g_gameContext->explosions)
+#define s_explosionTimer (g_gameContext->explosionTimer)
 
 
 /**
@@ -15,6 +15,9 @@
 #include "os/math.h"
 #include "os/strings.h"
 #include "os/readdir.h"
+#if !defined(TOS)
+#include "os/thread.h"
+#endif /* TOS */
 
 #include "file.h"
 
@@ -172,6 +175,8 @@ FILE *fopendatadir(enum SearchDirectory dir, const char *name, const char *mode)
  */
 typedef struct File {
 	FILE *fp;
+	const uint8 *buffer;                                    /*!< The content when read from memory, else NULL. */
+	FileInfo *info;                                         /*!< The FileInfo when read from memory, else NULL. */
 	uint32 size;
 	uint32 start;
 	uint32 position;
@@ -179,6 +184,31 @@ typedef struct File {
 
 static File FileHandleTable[FILE_MAX];
 
+#define File_IsOpen(f) ((f)->fp != NULL || (f)->buffer != NULL)
+
+#if !defined(TOS)
+enum {
+	FILE_PRELOAD_MAX     = 64,                              /*!< Maximum amount of files being preloaded. */
+	FILE_PRELOAD_THREADS = 2                                /*!< Amount of threads reading preloaded files. */
+};
+
+/**
+ * A file being read in the background.
+ */
+typedef struct FilePreload {
+	FileInfo *info;                                         /*!< The file, or NULL if the slot is free. */
+	FileInfo *pakInfo;                                      /*!< The PAK file containing the file, or NULL. */
+	uint8 *buffer;                                          /*!< The content once read, or NULL if reading failed. */
+	bool started;                                           /*!< True once a thread is reading the file. */
+	Semaphore done;                                         /*!< Unlocked by the thread once the file is read. */
+} FilePreload;
+
+static FilePreload s_filePreload[FILE_PRELOAD_MAX];
+static Semaphore s_filePreloadLock = NULL;                  /*!< Protects s_filePreload against concurrent access. */
+static Thread s_filePreloadThreads[FILE_PRELOAD_THREADS];
+static uint8 s_filePreloadThreadCount = 0;
+#endif /* TOS */
+
 /**
  * Information about files in data/ directory
  * and processed content of PAK files.
@@ -231,6 +261,106 @@ static FileInfo *FileInfo_Find_ByName(const char *filename, FileInfo **pakInfo)
 	return NULL;
 }
 
+#if !defined(TOS)
+/**
+ * Read the complete content of a file being preloaded. It does not use any
+ *  file handle, so it is safe to call from any thread.
+ *
+ * @param p The file being preloaded.
+ * @return The content, or NULL on failure.
+ */
+static uint8 *File_Preload_Read(const FilePreload *p)
+{
+	FILE *fp;
+	uint8 *buffer;
+
+	fp = fopendatadir(SEARCHDIR_GLOBAL_DATA_DIR, (p->pakInfo != NULL) ? p->pakInfo->filename : p->info->filename, "rb");
+	if (fp == NULL) return NULL;
+
+	buffer = (uint8 *)malloc(p->info->fileSize + 1);
+	if (buffer != NULL && p->info->fileSize != 0) {
+		if (fseek(fp, (p->pakInfo != NULL) ? p->info->filePosition : 0, SEEK_SET) != 0 || fread(buffer, p->info->fileSize, 1, fp) != 1) {
+			free(buffer);
+			buffer = NULL;
+		}
+	}
+
+	fclose(fp);
+	return buffer;
+}
+
+/**
+ * The thread reading files being preloaded, until none are left.
+ */
+static ThreadStatus WINAPI File_Preload_ThreadProc(void *data)
+{
+	VARIABLE_NOT_USED(data);
+
+	while (true) {
+		FilePreload *p = NULL;
+		uint8 i;
+
+		Semaphore_Lock(s_filePreloadLock);
+		for (i = 0; i < FILE_PRELOAD_MAX; i++) {
+			if (s_filePreload[i].info == NULL || s_filePreload[i].started) continue;
+
+			p = &s_filePreload[i];
+			p->started = true;
+			break;
+		}
+		Semaphore_Unlock(s_filePreloadLock);
+
+		if (p == NULL) return 0;
+
+		p->buffer = File_Preload_Read(p);
+		Semaphore_Unlock(p->done);
+	}
+}
+#endif /* TOS */
+
+/**
+ * Wait till a file being preloaded is read, and keep its content in memory
+ *  until it is opened and closed once. If no thread took the file yet, it
+ *  is not preloaded after all, and is read from disk as normal.
+ *
+ * @param info The file being preloaded.
+ */
+static void File_Preload_Wait(FileInfo *info)
+{
+#if !defined(TOS)
+	FilePreload *p = NULL;
+	bool started = false;
+	uint8 i;
+
+	Semaphore_Lock(s_filePreloadLock);
+	for (i = 0; i < FILE_PRELOAD_MAX; i++) {
+		if (s_filePreload[i].info != info) continue;
+
+		p = &s_filePreload[i];
+		started = p->started;
+		p->started = true;
+		break;
+	}
+	Semaphore_Unlock(s_filePreloadLock);
+
+	if (p != NULL) {
+		if (started) Semaphore_Lock(p->done);
+		Semaphore_Destroy(p->done);
+
+		if (p->buffer != NULL) {
+			info->buffer = p->buffer;
+			info->flags.inMemory = true;
+		}
+
+		Semaphore_Lock(s_filePreloadLock);
+		p->info = NULL;
+		Semaphore_Unlock(s_filePreloadLock);
+	}
+#endif /* TOS */
+
+	info->flags.isPreloading = false;
+}
+
 /**
  * Internal function to truly open a file.
  *
@@ -248,7 +378,7 @@ static uint8 _File_Open(enum SearchDirectory dir, const char *filename, uint8 mo
 
 	/* Find a free spot in our limited array */
 	for (fileIndex = 0; fileIndex < FILE_MAX; fileIndex++) {
-		if (FileHandleTable[fileIndex].fp == NULL) break;
+		if (!File_IsOpen(&FileHandleTable[fileIndex])) break;
 	}
 	if (fileIndex >= FILE_MAX) {
 		Warning("Limit of %d open files reached.\n", FILE_MAX);
@@ -259,6 +389,17 @@ static uint8 _File_Open(enum SearchDirectory dir, const char *filename, uint8 mo
 		/* Look in PAK only for READ only files, and not Personnal files */
 		fileInfo = FileInfo_Find_ByName(filename, &pakInfo);
 		if (fileInfo == NULL) return FILE_INVALID;
+
+		if (fileInfo->flags.isPreloading) File_Preload_Wait(fileInfo);
+		if (fileInfo->flags.inMemory) {
+			FileHandleTable[fileIndex].buffer   = (const uint8 *)fileInfo->buffer;
+			FileHandleTable[fileIndex].info     = fileInfo;
+			FileHandleTable[fileIndex].start    = 0;
+			FileHandleTable[fileIndex].position = 0;
+			FileHandleTable[fileIndex].size     = fileInfo->fileSize;
+			return fileIndex;
+		}
+
 		if (pakInfo == NULL) {
 			/* Check if we can find the file outside any PAK file */
 			FileHandleTable[fileIndex].fp = fopendatadir(dir, filename, "rb");
@@ -585,15 +726,31 @@ bool File_Init(void)
  */
 void File_Uninit(void)
 {
+#if !defined(TOS)
+	uint8 i;
+
+	/* Wait for all files being preloaded, and drop them */
+	for (i = 0; i < FILE_PRELOAD_MAX; i++) {
+		if (s_filePreload[i].info != NULL) File_Preload_Wait(s_filePreload[i].info);
+	}
+	for (i = 0; i < s_filePreloadThreadCount; i++) Thread_Wait(s_filePreloadThreads[i], NULL);
+	s_filePreloadThreadCount = 0;
+
+	if (s_filePreloadLock != NULL) Semaphore_Destroy(s_filePreloadLock);
+	s_filePreloadLock = NULL;
+#endif /* TOS */
+
 	while (FileHandleTables_in_root != NULL) {
 		FileInfoLinkedElem *e = FileHandleTables_in_root;
 		FileHandleTables_in_root = e->next;
+		if (e->info.flags.inMemory) free(e->info.buffer);
 		free(e);
 	}
 
 	while (FileHandleTables_in_pak != NULL) {
 		PakFileInfoLinkedElem *e = FileHandleTables_in_pak;
 		FileHandleTables_in_pak = e->next;
+		if (e->info.flags.inMemory) free(e->info.buffer);
 		free(e);
 	}
 }
@@ -663,6 +820,74 @@ uint8 File_Open_Ex(enum SearchDirectory dir, const char *filename, uint8 mode)
 	return res;
 }
 
+/**
+ * Start reading a file in the background, so it is in memory by the time
+ *  it is opened. Call File_Preload_Start() after giving all files. Only
+ *  files from the data directory can be preloaded; on platforms without
+ *  threads, this does nothing.
+ *
+ * @param filename The name of the file.
+ */
+void File_Preload(const char *filename)
+{
+#if !defined(TOS)
+	FileInfo *info;
+	FileInfo *pakInfo = NULL;
+	uint8 i;
+
+	info = FileInfo_Find_ByName(filename, &pakInfo);
+	if (info == NULL || info->flags.inMemory || info->flags.isPreloading) return;
+
+	if (s_filePreloadLock == NULL) {
+		s_filePreloadLock = Semaphore_Create(1);
+		if (s_filePreloadLock == NULL) return;
+	}
+
+	Semaphore_Lock(s_filePreloadLock);
+	for (i = 0; i < FILE_PRELOAD_MAX; i++) {
+		FilePreload *p = &s_filePreload[i];
+
+		if (p->info != NULL) continue;
+
+		p->done = Semaphore_Create(0);
+		if (p->done == NULL) break;
+
+		p->info    = info;
+		p->pakInfo = pakInfo;
+		p->buffer  = NULL;
+		p->started = false;
+		info->flags.isPreloading = true;
+		break;
+	}
+	Semaphore_Unlock(s_filePreloadLock);
+#else
+	VARIABLE_NOT_USED(filename);
+#endif /* TOS */
+}
+
+/**
+ * Start the threads reading the files given to File_Preload().
+ */
+void File_Preload_Start(void)
+{
+#if !defined(TOS)
+	uint8 i;
+
+	/* The threads of a previous call stop once no files are left */
+	for (i = 0; i < s_filePreloadThreadCount; i++) Thread_Wait(s_filePreloadThreads[i], NULL);
+	s_filePreloadThreadCount = 0;
+
+	if (s_filePreloadLock == NULL) return;
+
+	for (i = 0; i < FILE_PRELOAD_THREADS; i++) {
+		Thread thread = Thread_Create(File_Preload_ThreadProc, NULL);
+
+		if (thread == NULL) break;
+		s_filePreloadThreads[s_filePreloadThreadCount++] = thread;
+	}
+#endif /* TOS */
+}
+
 /**
  * Close an opened file.
  *
@@ -670,13 +895,34 @@ uint8 File_Open_Ex(enum SearchDirectory dir, const char *filename, uint8 mode)
  */
 void Close_File(uint8 index)
 {
+	File *f;
+
 	if (index >= FILE_MAX) return;
-	if (FileHandleTable[index].fp == NULL) return;
+	f = &FileHandleTable[index];
+	if (!File_IsOpen(f)) return;
 
 	g_fileOperation++;
 
-	fclose(FileHandleTable[index].fp);
-	FileHandleTable[index].fp = NULL;
+	if (f->buffer != NULL) {
+		FileInfo *info = f->info;
+		uint8 i;
+
+		f->buffer = NULL;
+		f->info = NULL;
+
+		/* A preloaded file is only kept in memory until it is read once */
+		for (i = 0; i < FILE_MAX; i++) {
+			if (FileHandleTable[i].info == info) break;
+		}
+		if (i == FILE_MAX) {
+			free(info->buffer);
+			info->buffer = NULL;
+			info->flags.inMemory = false;
+		}
+	} else {
+		fclose(f->fp);
+		f->fp = NULL;
+	}
 
 	g_fileOperation--;
 }
@@ -692,12 +938,18 @@ void Close_File(uint8 index)
 uint32 Read_File(uint8 index, void *buffer, uint32 length)
 {
 	if (index >= FILE_MAX) return 0;
-	if (FileHandleTable[index].fp == NULL) return 0;
+	if (!File_IsOpen(&FileHandleTable[index])) return 0;
 	if (FileHandleTable[index].position >= FileHandleTable[index].size) return 0;
 	if (length == 0) return 0;
 
 	if (length > FileHandleTable[index].size - FileHandleTable[index].position) length = FileHandleTable[index].size - FileHandleTable[index].position;
 
+	if (FileHandleTable[index].buffer != NULL) {
+		memcpy(buffer, FileHandleTable[index].buffer + FileHandleTable[index].position, length);
+		FileHandleTable[index].position += length;
+		return length;
+	}
+
 	g_fileOperation++;
 	if (fread(buffer, length, 1, FileHandleTable[index].fp) != 1) {
 		Error("Read error\n");
@@ -789,9 +1041,18 @@ bool File_Write_LE16(uint8 index, uint16 value)
 uint32 Seek_File(uint8 index, uint32 position, uint8 mode)
 {
 	if (index >= FILE_MAX) return 0;
-	if (FileHandleTable[index].fp == NULL) return 0;
+	if (!File_IsOpen(&FileHandleTable[index])) return 0;
 	if (mode > 2) { Close_File(index); return 0; }
 
+	if (FileHandleTable[index].buffer != NULL) {
+		switch (mode) {
+			case 0: FileHandleTable[index].position = position; break;
+			case 1: FileHandleTable[index].position += (int32)position; break;
+			case 2: FileHandleTable[index].position = FileHandleTable[index].size - position; break;
+		}
+		return FileHandleTable[index].position;
+	}
+
 	g_fileOperation++;
 	switch (mode) {
 		case 0:
@@ -821,7 +1082,7 @@ uint32 Seek_File(uint8 index, uint32 position, uint8 mode)
 uint32 File_Size(uint8 index)
 {
 	if (index >= FILE_MAX) return 0;
-	if (FileHandleTable[index].fp == NULL) return 0;
+	if (!File_IsOpen(&FileHandleTable[index])) return 0;
 
 	return FileHandleTable[index].size;
 }
@@ -32,6 +32,7 @@ typedef struct FileInfo {
 	struct {
 		BIT_U8 inMemory:1;                                  /*!< File is loaded in alloc'd memory. */
 		BIT_U8 inPAKFile:1;                                 /*!< File can be in other PAK file. */
+		BIT_U8 isPreloading:1;                              /*!< File is being read in the background. */
 	} flags;                                                /*!< General flags of the FileInfo. */
 } FileInfo;
 
@@ -41,6 +42,8 @@ extern bool File_Init(void);
 extern void File_Uninit(void);
 extern bool File_Exists_Ex(enum SearchDirectory dir, const char *filename, uint32 *fileSize);
 extern uint8 File_Open_Ex(enum SearchDirectory dir, const char *filename, uint8 mode);
+extern void File_Preload(const char *filename);
+extern void File_Preload_Start(void);
 extern void Close_File(uint8 index);
 extern uint32 Read_File(uint8 index, void *buffer, uint32 length);
 extern uint16 Read_File_LE16(uint8 index);
@@ -0,0 +1,53 @@
+/** @file src/gamecontext.c Game context routines. */
+
+#include <stdlib.h>
+#include "types.h"
+
+#include "gamecontext.h"
+
+/** The context of the game played by the user. GameLoop_Main() sets its player's House before use. */
+static GameContext s_gameContextDefault;
+
+/** The context of the current thread. Threads start with the default context. */
+GAMECONTEXT_THREAD_LOCAL GameContext *g_gameContext = &s_gameContextDefault;
+
+/**
+ * Create a new, empty, context. Make it current with GameContext_SetCurrent()
+ *  before loading a scenario into it.
+ * @return The context, or NULL if out of memory.
+ */
+GameContext *GameContext_Create(void)
+{
+	GameContext *context;
+
+	context = (GameContext *)calloc(1, sizeof(GameContext));
+	if (context == NULL) return NULL;
+
+	context->playerHouseID = HOUSE_INVALID;
+	return context;
+}
+
+/**
+ * Free a context created by GameContext_Create(). It should not be current on
+ *  any thread.
+ * @param context The context to free.
+ */
+void GameContext_Free(GameContext *context)
+{
+	if (context == NULL || context == &s_gameContextDefault) return;
+
+	free(context);
+}
+
+/**
+ * Make a context the current one of the calling thread.
+ * @param context The context, or NULL for the default one.
+ * @return The context which was current before.
+ */
+GameContext *GameContext_SetCurrent(GameContext *context)
+{
+	GameContext *old = g_gameContext;
+
+	g_gameContext = (context != NULL) ? context : &s_gameContextDefault;
+	return old;
+}
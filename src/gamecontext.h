@@ -0,0 +1,171 @@
+/** @file src/gamecontext.h Game context definitions. */
+
+#ifndef GAMECONTEXT_H
+#define GAMECONTEXT_H
+
+#include <stdio.h>
+
+#include "animation.h"
+#include "explosion.h"
+#include "house.h"
+#include "map.h"
+#include "scenario.h"
+#include "structure.h"
+#include "team.h"
+#include "unit.h"
+#include "pool/house.h"
+#include "pool/structure.h"
+#include "pool/team.h"
+#include "pool/unit.h"
+
+#if defined(_MSC_VER)
+	#define GAMECONTEXT_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__) && !defined(TOS)
+	#define GAMECONTEXT_THREAD_LOCAL __thread
+#else
+	/* No thread local storage; there is only one current context */
+	#define GAMECONTEXT_THREAD_LOCAL
+#endif /* _MSC_VER */
+
+/**
+ * The world state of one game: everything the simulation changes, and what
+ *  a snapshot restores. Every thread has its own current context. The globals
+ *  which used to hold this state are macros to the fields of the current
+ *  context.
+ * GUI state, like g_selectionType, g_activeAction and the drawing buffers,
+ *  is still global, so contexts run one after the other, not at the same
+ *  time on several threads.
+ */
+typedef struct GameContext {
+	HousesType playerHouseID;                               /*!< The House of the human player. */
+	uint16 scenarioID;                                      /*!< The scenario being played. */
+	uint16 campaignID;                                      /*!< The campaign the scenario belongs to. */
+	uint32 timerGame;                                       /*!< Tick counter of the game. */
+	uint32 tickScenarioStart;                               /*!< The tick the scenario started in. */
+	uint32 tickGameTimeout;                                 /*!< The tick the game will timeout. */
+	uint8 randomSeed[4];                                    /*!< State of Tools_Random_256(). */
+	uint32 randomLCG;                                       /*!< State of Tools_RandomLCG_Range(). */
+
+	struct Object *scriptCurrentObject;                     /*!< The Object the running script belongs to. */
+	struct Structure *scriptCurrentStructure;               /*!< The Structure the running script belongs to, if any. */
+	struct Unit *scriptCurrentUnit;                         /*!< The Unit the running script belongs to, if any. */
+	struct Team *scriptCurrentTeam;                         /*!< The Team the running script belongs to, if any. */
+
+	Scenario scenario;                                      /*!< The scenario being played. */
+	Tile map[64 * 64];                                      /*!< All map data. */
+	uint16 mapSpriteID[64 * 64];                            /*!< Per tile the ground sprite without the effects of the game. */
+	uint32 unveiledMap[128];                                /*!< Bit array of tiles which are unveiled and have no fog overlay left. */
+
+	uint32 dirtyMinimap[128];                               /*!< Dirty tiles of the minimap (must be rendered again). */
+	uint32 displayedMinimap[128];                           /*!< Displayed part of the minimap. */
+	uint32 dirtyViewport[128];                              /*!< Dirty tiles of the viewport (must be rendered again). */
+	uint32 displayedViewport[128];                          /*!< Displayed part of the viewport. */
+	uint16 dirtyViewportCount;                              /*!< Amount of dirty tiles in the viewport. */
+	uint16 changedTilesCount;                               /*!< Number of changed tiles in changedTiles. */
+	uint16 changedTiles[200];                               /*!< Array of positions of changed tiles. */
+	uint32 changedTilesMap[128];                            /*!< Bit array of changed tiles, in order not to loose changes. */
+
+	Animation animations[ANIMATION_MAX];                    /*!< The running Animations. */
+	uint32 animationTimer;                                  /*!< Timer for animations. */
+	Explosion explosions[EXPLOSION_MAX];                    /*!< The running Explosions. */
+	uint32 explosionTimer;                                  /*!< Timeout value for next explosion activity. */
+
+	House *playerHouse;                                     /*!< The House of the human player. */
+	uint16 houseMissileCountdown;                           /*!< Countdown of the missile of the Palace of the human player. */
+	uint16 playerCreditsNoSilo;                             /*!< Credits of the human player without a Silo to keep them. */
+	uint16 playerCredits;                                   /*!< Credits shown to player as 'current'. */
+	uint32 tickHousePowerMaintenance;                       /*!< Indicates next time the power and maintenance is paid. */
+	uint32 tickHouseHouse;                                  /*!< Indicates next time the House function is executed. */
+	uint32 tickHouseStarport;                               /*!< Indicates next time the Starport function is executed. */
+	uint32 tickHouseReinforcement;                          /*!< Indicates next time the Reinforcement function is executed. */
+	uint32 tickHouseMissileCountdown;                       /*!< Indicates next time the missile countdown is executed. */
+	uint32 tickHouseStarportAvailability;                   /*!< Indicates next time the Starport availability is updated. */
+
+	struct Structure *structureActive;                      /*!< The Structure being placed. */
+	uint16 structureActivePosition;                         /*!< Where the Structure being placed is. */
+	uint16 structureActiveType;                             /*!< The type of Structure being placed. */
+	uint16 structureIndex;                                  /*!< The Structure the human player has selected. */
+	uint32 tickStructureDegrade;                            /*!< Indicates next time Degrade function is executed. */
+	uint32 tickStructureStructure;                          /*!< Indicates next time Structures function is executed. */
+	uint32 tickStructureScript;                             /*!< Indicates next time Script function is executed. */
+	uint32 tickStructurePalace;                             /*!< Indicates next time Palace function is executed. */
+
+	uint32 tickTeamGameLoop;                                /*!< Indicates next time the GameLoop function is executed. */
+
+	struct Unit *unitActive;                                /*!< The Unit being given an order. */
+	struct Unit *unitHouseMissile;                          /*!< The missile launched by the Palace of the human player. */
+	struct Unit *unitSelected;                              /*!< The Unit the human player has selected. */
+	int16 starportAvailable[UNIT_MAX];                      /*!< Per Unit type, how many the Starport has available. */
+	uint32 tickUnitMovement;                                /*!< Indicates next time the Movement function is executed. */
+	uint32 tickUnitRotation;                                /*!< Indicates next time the Rotation function is executed. */
+	uint32 tickUnitBlinking;                                /*!< Indicates next time the Blinking function is executed. */
+	uint32 tickUnitUnknown4;                                /*!< Indicates next time the Unknown4 function is executed. */
+	uint32 tickUnitScript;                                  /*!< Indicates next time the Script function is executed. */
+	uint32 tickUnitUnknown5;                                /*!< Indicates next time the Unknown5 function is executed. */
+	uint32 tickUnitDeviation;                               /*!< Indicates next time the Deviation function is executed. */
+
+	House houseArray[HOUSE_INDEX_MAX];                      /*!< The House pool. */
+	House *houseFindArray[HOUSE_INDEX_MAX];                 /*!< The allocated Houses, in order of allocation. */
+	uint16 houseFindCount;                                  /*!< Amount of allocated Houses. */
+
+	Structure structureArray[STRUCTURE_INDEX_MAX_HARD];     /*!< The Structure pool. */
+	Structure *structureFindArray[STRUCTURE_INDEX_MAX_SOFT]; /*!< The allocated Structures, in order of allocation. */
+	uint16 structureFindCount;                              /*!< Amount of allocated Structures. */
+
+	Team teamArray[TEAM_INDEX_MAX];                         /*!< The Team pool. */
+	Team *teamFindArray[TEAM_INDEX_MAX];                    /*!< The allocated Teams, in order of allocation. */
+	uint16 teamFindCount;                                   /*!< Amount of allocated Teams. */
+
+	Unit unitArray[UNIT_INDEX_MAX];                         /*!< The Unit pool. */
+	Unit *unitFindArray[UNIT_INDEX_MAX];                    /*!< The allocated Units, in order of allocation. */
+	uint16 unitFindCount;                                   /*!< Amount of allocated Units. */
+	Unit *unitDrawArray[UNIT_INDEX_MAX];                    /*!< The allocated Units, in the order to draw them. */
+	int16 unitDrawKey[UNIT_INDEX_MAX];                      /*!< Per Unit index, the key it is sorted on in unitDrawArray. */
+	uint8 unitDrawSlot[UNIT_INDEX_MAX];                     /*!< Per Unit index, where it is in unitDrawArray. */
+	uint16 unitDrawCount;                                   /*!< Amount of Units in unitDrawArray. */
+} GameContext;
+
+extern GAMECONTEXT_THREAD_LOCAL GameContext *g_gameContext;
+
+#define g_playerHouseID          (g_gameContext->playerHouseID)
+#define g_scenarioID             (g_gameContext->scenarioID)
+#define g_campaignID             (g_gameContext->campaignID)
+#define g_timerGame              (g_gameContext->timerGame)
+#define g_tickScenarioStart      (g_gameContext->tickScenarioStart)
+#define g_scriptCurrentObject    (g_gameContext->scriptCurrentObject)
+#define g_scriptCurrentStructure (g_gameContext->scriptCurrentStructure)
+#define g_scriptCurrentUnit      (g_gameContext->scriptCurrentUnit)
+#define g_scriptCurrentTeam      (g_gameContext->scriptCurrentTeam)
+#define g_scenario               (g_gameContext->scenario)
+#define g_map                    (g_gameContext->map)
+#define g_mapSpriteID            (g_gameContext->mapSpriteID)
+#define g_unveiledMap            (g_gameContext->unveiledMap)
+#define g_dirtyMinimap           (g_gameContext->dirtyMinimap)
+#define g_displayedMinimap       (g_gameContext->displayedMinimap)
+#define g_dirtyViewport          (g_gameContext->dirtyViewport)
+#define g_displayedViewport      (g_gameContext->displayedViewport)
+#define g_dirtyViewportCount     (g_gameContext->dirtyViewportCount)
+#define g_changedTilesCount      (g_gameContext->changedTilesCount)
+#define g_changedTiles           (g_gameContext->changedTiles)
+#define g_changedTilesMap        (g_gameContext->changedTilesMap)
+#define g_playerHouse            (g_gameContext->playerHouse)
+#define g_houseMissileCountdown  (g_gameContext->houseMissileCountdown)
+#define g_playerCreditsNoSilo    (g_gameContext->playerCreditsNoSilo)
+#define g_playerCredits          (g_gameContext->playerCredits)
+#define g_tickHousePowerMaintenance (g_gameContext->tickHousePowerMaintenance)
+#define g_structureActive        (g_gameContext->structureActive)
+#define g_structureActivePosition (g_gameContext->structureActivePosition)
+#define g_structureActiveType    (g_gameContext->structureActiveType)
+#define g_structureIndex         (g_gameContext->structureIndex)
+#define g_unitFindArray          (g_gameContext->unitFindArray)
+#define g_unitFindCount          (g_gameContext->unitFindCount)
+#define g_unitActive             (g_gameContext->unitActive)
+#define g_unitHouseMissile       (g_gameContext->unitHouseMissile)
+#define g_unitSelected           (g_gameContext->unitSelected)
+#define g_starportAvailable      (g_gameContext->starportAvailable)
+
+extern GameContext *GameContext_Create(void);
+extern void GameContext_Free(GameContext *context);
+extern GameContext *GameContext_SetCurrent(GameContext *context);
+
+#endif /* GAMECONTEXT_H */
@@ -15,6 +15,7 @@
 #include "gui.h"
 
 #include "font.h"
+#include "../gamecontext.h"
 #include "mentat.h"
 #include "widget.h"
 #include "../animation.h"
@@ -36,6 +37,7 @@
 #include "../pool/house.h"
 #include "../pool/structure.h"
 #include "../pool/unit.h"
+#include "../profile.h"
 #include "../sprites.h"
 #include "../string.h"
 #include "../structure.h"
@@ -775,6 +777,8 @@ uint16 GUI_DisplayModalMessage(const char *str, uint16 spriteID, ...)
 	Screen oldScreenID;
 	uint8 *screenBackup = NULL;
 
+	if (g_headless) return 0;
+
 	va_start(ap, spriteID);
 	vsnprintf(textBuffer, sizeof(textBuffer), str, ap);
 	va_end(ap);
@@ -1384,6 +1388,21 @@ static uint16 Update_Score(int16 score, uint16 *harvestedAllied, uint16 *harvest
 	return score;
 }
 
+/**
+ * Get the final score of the scenario, as the end stats show it.
+ * @param score The score of the scenario so far.
+ * @param harvestedAllied The spice harvested by the allies; the spice still in their harvesters is added.
+ * @param harvestedEnemy The spice harvested by the enemies; the spice still in their harvesters is added.
+ * @param houseID The House to get the score for.
+ * @return The final score.
+ */
+uint16 GUI_EndStats_GetScore(int16 score, uint16 *harvestedAllied, uint16 *harvestedEnemy, uint8 houseID)
+{
+	s_ticksPlayed = ((g_timerGame - g_tickScenarioStart) / 3600) + 1;
+
+	return Update_Score(score, harvestedAllied, harvestedEnemy, houseID);
+}
+
 /**
  * Draws a string on a filled rectangle.
  * @param string The string to draw.
@@ -1527,9 +1546,7 @@ void GUI_EndStats_Show(uint16 killedAllied, uint16 killedEnemy, uint16 destroyed
 	struct { uint16 value; uint16 increment; } scores[3][2];
 	uint16 i;
 
-	s_ticksPlayed = ((g_timerGame - g_tickScenarioStart) / 3600) + 1;
-
-	score = Update_Score(score, &harvestedAllied, &harvestedEnemy, houseID);
+	score = GUI_EndStats_GetScore(score, &harvestedAllied, &harvestedEnemy, houseID);
 
 	/* 1st scenario doesn't have the "Building destroyed" stats */
 	statsBoxCount = (g_scenarioID == 1) ? 2 : 3;
@@ -1893,7 +1910,7 @@ uint16 GUI_DisplayHint(uint16 stringID, uint16 spriteID)
 	uint32 mask;
 	uint16 hint;
 
-	if (g_debugGame || stringID == STR_NULL || !g_gameConfig.hints || g_selectionType == SELECTIONTYPE_MENTAT) return 0;
+	if (g_debugGame || g_headless || stringID == STR_NULL || !g_gameConfig.hints || g_selectionType == SELECTIONTYPE_MENTAT) return 0;
 
 	hint = stringID - STR_YOU_MUST_BUILD_A_WINDTRAP_TO_PROVIDE_POWER_TO_YOUR_BASE_WITHOUT_POWER_YOUR_STRUCTURES_WILL_DECAY;
 
@@ -3783,6 +3800,11 @@ void Low_Show_Mouse(void)
 	if (MDisabled == 1) return;
 	if (g_mouseHiddenDepth == 0 || --g_mouseHiddenDepth != 0) return;
 
+	if (g_mouseHardwareCursor) {
+		Video_Mouse_ShowCursor(true);
+		return;
+	}
+
 	left = g_mouseX - g_mouseSpriteHotspotX;
 	top  = g_mouseY - g_mouseSpriteHotspotY;
 
@@ -3810,7 +3832,9 @@ void Low_Hide_Mouse(void)
 {
 	if (MDisabled == 1) return;
 
-	if (g_mouseHiddenDepth == 0 && s_mouseSpriteWidth != 0) {
+	if (g_mouseHardwareCursor) {
+		if (g_mouseHiddenDepth == 0) Video_Mouse_ShowCursor(false);
+	} else if (g_mouseHiddenDepth == 0 && s_mouseSpriteWidth != 0) {
 		if (g_mouseSpriteBuffer != NULL) {
 			GFX_CopyFromBuffer(s_mouseSpriteLeft * 8, s_mouseSpriteTop, s_mouseSpriteWidth * 8, s_mouseSpriteHeight, g_mouseSpriteBuffer);
 		}
@@ -3827,6 +3851,12 @@ void Low_Hide_Mouse(void)
  */
 void Hide_Mouse(void)
 {
+	/* Nothing can draw over a cursor the video driver draws, so there is no need to wait */
+	if (g_mouseHardwareCursor) {
+		Low_Hide_Mouse();
+		return;
+	}
+
 	while (MouseUpdate != 0) sleepIdle();
 	if (MDisabled == 1) return;
 	MouseUpdate++;
@@ -3842,6 +3872,11 @@ void Hide_Mouse(void)
  */
 void Show_Mouse(void)
 {
+	if (g_mouseHardwareCursor) {
+		Low_Show_Mouse();
+		return;
+	}
+
 	while (MouseUpdate != 0) sleepIdle();
 	if (MDisabled == 1) return;
 	MouseUpdate++;
@@ -3859,6 +3894,8 @@ void Conditional_Show_Mouse(void)
 {
 	uint8 counter;
 
+	if (g_mouseHardwareCursor) return;
+
 	while (MouseUpdate != 0) sleepIdle();
 	MouseUpdate++;
 
@@ -3887,6 +3924,9 @@ void Conditional_Hide_Mouse(uint16 left, uint16 top, uint16 right, uint16 bottom
 	int minx, miny;
 	int maxx, maxy;
 
+	/* The cursor is only hidden to draw below it; not needed when the video driver draws it */
+	if (g_mouseHardwareCursor) return;
+
 	minx = left - ((g_mouseWidth - 1) << 3) + g_mouseSpriteHotspotX;
 	if (minx < 0) minx = 0;
 
@@ -4451,7 +4491,6 @@ void GUI_DrawScreen(Screen screenID)
 
 	Explosion_Tick();
 	Animation_Tick();
-	Unit_Sort();
 
 	if (!g_viewport_forceRedraw && g_viewportPosition != g_minimapPosition) {
 		uint16 viewportX = Tile_GetPackedX(g_viewportPosition);
@@ -4495,14 +4534,10 @@ void GUI_DrawScreen(Screen screenID)
 	if (hasScrolled) {
 		Map_SetSelectionObjectPosition(0xFFFF);
 
-		for (xpos = 0; xpos < 14; xpos++) {
-			uint16 v = g_minimapPosition + xpos + 6*64;
-
-			BitArray_Set(g_dirtyViewport, v);
-			BitArray_Set(g_dirtyMinimap, v);
+		BitArray_SetRange(g_dirtyViewport, g_minimapPosition + 6*64, 14);
+		BitArray_SetRange(g_dirtyMinimap, g_minimapPosition + 6*64, 14);
 
-			g_dirtyViewportCount++;
-		}
+		g_dirtyViewportCount += 14;
 	}
 
 	g_minimapPosition = g_viewportPosition;
@@ -4517,7 +4552,9 @@ void GUI_DrawScreen(Screen screenID)
 		}
 	}
 
+	Profile_Section_Begin(PROFILE_SECTION_VIEWPORT);
 	GUI_Widget_Viewport_Draw(g_viewport_forceRedraw, hasScrolled, !GFX_Screen_IsActive(SCREEN_0));
+	Profile_Section_End(PROFILE_SECTION_VIEWPORT);
 
 	g_viewport_forceRedraw = false;
 
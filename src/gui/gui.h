@@ -139,6 +139,7 @@ extern uint16 GUI_DisplayHint(uint16 stringID, uint16 spriteID);
 
 extern void GUI_UpdateProductionStringID(void);
 extern uint16 GUI_SplitText(char *str, uint16 maxwidth, char delimiter);
+extern uint16 GUI_EndStats_GetScore(int16 score, uint16 *harvestedAllied, uint16 *harvestedEnemy, uint8 houseID);
 extern void GUI_EndStats_Show(uint16 killedAllied, uint16 killedEnemy, uint16 destroyedAllied, uint16 destroyedEnemy, uint16 harvestedAllied, uint16 harvestedEnemy, int16 score, uint8 houseID);
 extern uint8 Choose_Side(void);
 extern void GUI_ChangeSelectionType(uint16 selectionType);
@@ -12,6 +12,7 @@
 #include "mentat.h"
 
 #include "font.h"
+#include "../gamecontext.h"
 #include "gui.h"
 #include "widget.h"
 #include "../audio/driver.h"
@@ -1,5 +1,6 @@
 /** @file src/security.c Security routines. */
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
@@ -8,6 +9,7 @@
 #include "../os/sleep.h"
 #include "../os/error.h"
 
+#include "../gamecontext.h"
 #include "security.h"
 #include "../file.h"
 #include "../gfx.h"
@@ -6,6 +6,7 @@
 #include "../os/common.h"
 #include "../os/math.h"
 
+#include "../gamecontext.h"
 #include "gui.h"
 #include "widget.h"
 #include "../audio/driver.h"
@@ -363,12 +364,26 @@ void GUI_Widget_Viewport_Draw(bool forceRedraw, bool hasScrolled, bool drawToMai
 	if (g_dirtyViewportCount != 0 || forceRedraw) {
 		for (y = 0; y < 10; y++) {
 			uint16 top = (y << 4) + 0x28;
+			uint16 rowStart = g_viewportPosition + Tile_PackXY(0, y);
+			uint16 rowEnd = rowStart + (drawToMainScreen ? 15 : 16);
+
 			for (x = 0; x < (drawToMainScreen ? 15 : 16); x++) {
 				Tile *t;
 				uint16 left;
 
 				curPos = g_viewportPosition + Tile_PackXY(x, y);
 
+				/* Only a few tiles are dirty per frame; jump straight to the next one. */
+				if (!forceRedraw) {
+					uint16 nextViewport = BitArray_FindNext(g_dirtyViewport, curPos, rowEnd);
+					uint16 nextMinimap  = BitArray_FindNext(g_dirtyMinimap,  curPos, rowEnd);
+
+					curPos = min(nextViewport, nextMinimap);
+					if (curPos == rowEnd) break;
+
+					x = curPos - rowStart;
+				}
+
 				if (x < 15 && !forceRedraw && BitArray_Test(g_dirtyViewport, curPos)) {
 					if (maxX[y] < x) maxX[y] = x;
 					if (minX[y] > x) minX[y] = x;
@@ -467,7 +482,7 @@ void GUI_Widget_Viewport_Draw(bool forceRedraw, bool hasScrolled, bool drawToMai
 			uint16 index;
 			uint16 spriteFlags = 0;
 
-			u = Unit_Find(&find);
+			u = Unit_FindInDrawOrder(&find);
 
 			if (u == NULL) break;
 
@@ -642,7 +657,7 @@ void GUI_Widget_Viewport_Draw(bool forceRedraw, bool hasScrolled, bool drawToMai
 			uint16 index;
 			uint16 spriteFlags;
 
-			u = Unit_Find(&find);
+			u = Unit_FindInDrawOrder(&find);
 
 			if (u == NULL) break;
 
@@ -758,8 +773,7 @@ void GUI_Widget_Viewport_Draw(bool forceRedraw, bool hasScrolled, bool drawToMai
 		if (g_changedTilesCount == lengthof(g_changedTiles)) {
 			g_changedTilesCount = 0;
 
-			for (i = 0; i < 4096; i++) {
-				if (!BitArray_Test(g_changedTilesMap, i)) continue;
+			for (i = BitArray_FindNext(g_changedTilesMap, 0, 4096); i < 4096; i = BitArray_FindNext(g_changedTilesMap, i + 1, 4096)) {
 				g_changedTiles[g_changedTilesCount++] = i;
 				if (g_changedTilesCount == lengthof(g_changedTiles)) break;
 			}
@@ -826,15 +840,20 @@ void GUI_Widget_Viewport_Draw(bool forceRedraw, bool hasScrolled, bool drawToMai
 	Change_Window(oldWidgetID);
 }
 
+/** Flag in a minimap look telling it is a sprite instead of a colour. */
+#define MINIMAP_LOOK_SPRITE 0x8000
+
+static uint16 s_minimapLook[64 * 64];                       /*!< Per tile what is drawn on the minimap in SCREEN_1; a colour, or a spriteID with MINIMAP_LOOK_SPRITE set. */
+static bool s_minimapLookValid = false;                     /*!< True if #s_minimapLook reflects what is drawn on the minimap. */
+
 /**
- * Draw a single tile on the screen.
+ * Get what a tile looks like on the minimap.
  *
- * @param packed The tile to draw.
+ * @param packed The tile to get the look of.
+ * @return The colour of the tile, or its spriteID with MINIMAP_LOOK_SPRITE set.
  */
-void GUI_Widget_Viewport_DrawTile(uint16 packed)
+static uint16 GUI_Widget_Viewport_GetMinimapLook(uint16 packed)
 {
-	uint16 x;
-	uint16 y;
 	uint16 colour;
 	uint16 spriteID;
 	Tile *t;
@@ -843,15 +862,8 @@ void GUI_Widget_Viewport_DrawTile(uint16 packed)
 	colour = 12;
 	spriteID = 0xFFFF;
 
-	if (Tile_IsOutOfMap(packed) || !Map_IsValidPosition(packed)) return;
-
-	x = Tile_GetPackedX(packed);
-	y = Tile_GetPackedY(packed);
-
 	mapScale = g_scenario.mapScale + 1;
 
-	if (mapScale == 0 || BitArray_Test(g_displayedMinimap, packed)) return;
-
 	t = &g_map[packed];
 
 	if ((t->Revealed && g_playerHouse->flags.radarActivated) || g_debugScenario) {
@@ -909,20 +921,77 @@ void GUI_Widget_Viewport_DrawTile(uint16 packed)
 		}
 	}
 
+	if (spriteID != 0xFFFF) return spriteID | MINIMAP_LOOK_SPRITE;
+	return colour & 0xFF;
+}
+
+/**
+ * Draw a single tile on the screen. Nothing is drawn if the tile looks the
+ *  same as the last time it was drawn.
+ *
+ * @param packed The tile to draw.
+ */
+void GUI_Widget_Viewport_DrawTile(uint16 packed)
+{
+	uint16 x;
+	uint16 y;
+	uint16 look;
+	uint16 mapScale;
+
+	if (Tile_IsOutOfMap(packed) || !Map_IsValidPosition(packed)) return;
+
+	x = Tile_GetPackedX(packed);
+	y = Tile_GetPackedY(packed);
+
+	mapScale = g_scenario.mapScale + 1;
+
+	if (mapScale == 0 || BitArray_Test(g_displayedMinimap, packed)) return;
+
+	look = GUI_Widget_Viewport_GetMinimapLook(packed);
+
+	if (s_minimapLookValid && s_minimapLook[packed] == look) return;
+	s_minimapLook[packed] = look;
+
 	x -= g_mapInfos[g_scenario.mapScale].minX;
 	y -= g_mapInfos[g_scenario.mapScale].minY;
 
-	if (spriteID != 0xFFFF) {
+	if ((look & MINIMAP_LOOK_SPRITE) != 0) {
 		x *= g_scenario.mapScale + 1;
 		y *= g_scenario.mapScale + 1;
-		Draw_Shape(SCREEN_ACTIVE, g_sprites[spriteID], x, y, 3, 0x4000);
+		Draw_Shape(SCREEN_ACTIVE, g_sprites[look & ~MINIMAP_LOOK_SPRITE], x, y, 3, 0x4000);
 	} else {
-		_Put_Pixel(x + 256, y + 136, colour & 0xFF);
+		_Put_Pixel(x + 256, y + 136, look & 0xFF);
 	}
 }
 
+/**
+ * Forget what the minimap shows for a tile, so the next
+ *  GUI_Widget_Viewport_DrawTile() draws it again. Used when something else
+ *  is drawn over the tile on the minimap.
+ *
+ * @param packed The tile to forget.
+ */
+void GUI_Widget_Viewport_InvalidateTile(uint16 packed)
+{
+	if (Tile_IsOutOfMap(packed)) return;
+
+	s_minimapLook[packed] = 0xFFFF;
+}
+
+/**
+ * Forget what the minimap shows for all tiles, so the next
+ *  GUI_Widget_Viewport_DrawTile() of each tile draws it again. Used when the
+ *  world state is replaced underneath the minimap.
+ */
+void GUI_Widget_Viewport_InvalidateMap(void)
+{
+	memset(s_minimapLook, 0xFF, sizeof(s_minimapLook));
+}
+
 /**
  * Redraw the whole map.
+ * At the smallest scale, where every tile is a single pixel, the looks of
+ *  all tiles are gathered first and then written as one block.
  *
  * @param screenID To which screen we should draw the map. Can only be SCREEN_0 or SCREEN_1. Any non-zero is forced to SCREEN_1.
  */
@@ -933,7 +1002,33 @@ void GUI_Widget_Viewport_RedrawMap(Screen screenID)
 
 	if (screenID == SCREEN_0) oldScreenID = _Set_LogicPage(SCREEN_1);
 
-	for (i = 0; i < 4096; i++) GUI_Widget_Viewport_DrawTile(i);
+	s_minimapLookValid = false;
+
+	if (g_scenario.mapScale == 0) {
+		const MapInfo *mapInfo = &g_mapInfos[0];
+		uint8 *screen = (uint8 *)GFX_Screen_GetActive() + 136 * SCREEN_WIDTH + 256;
+		uint16 x, y;
+
+		for (y = 0; y < mapInfo->sizeY; y++) {
+			uint8 *row = screen + y * SCREEN_WIDTH;
+
+			for (x = 0; x < mapInfo->sizeX; x++) {
+				uint16 packed = Tile_PackXY(mapInfo->minX + x, mapInfo->minY + y);
+
+				if (BitArray_Test(g_displayedMinimap, packed)) {
+					s_minimapLook[packed] = 0xFFFF;
+					continue;
+				}
+
+				s_minimapLook[packed] = GUI_Widget_Viewport_GetMinimapLook(packed);
+				row[x] = s_minimapLook[packed] & 0xFF;
+			}
+		}
+	} else {
+		for (i = 0; i < 4096; i++) GUI_Widget_Viewport_DrawTile(i);
+	}
+
+	s_minimapLookValid = true;
 
 	Map_UpdateMinimapPosition(g_minimapPosition, true);
 
@@ -236,6 +236,8 @@ extern void Widget_PaintCurrentWidget(void);
 extern bool GUI_Widget_Viewport_Click(Widget *w);
 extern void GUI_Widget_Viewport_Draw(bool forceRedraw, bool hasScrolled, bool drawToMainScreen);
 extern void GUI_Widget_Viewport_DrawTile(uint16 packed);
+extern void GUI_Widget_Viewport_InvalidateTile(uint16 packed);
+extern void GUI_Widget_Viewport_InvalidateMap(void);
 extern void GUI_Widget_Viewport_RedrawMap(Screen screenID);
 
 /* widget_click.c */
@@ -10,6 +10,7 @@
 #include "../os/sleep.h"
 #include "../os/strings.h"
 
+#include "../gamecontext.h"
 #include "gui.h"
 #include "widget.h"
 #include "../audio/driver.h"
@@ -4,6 +4,7 @@
 #include "types.h"
 
 #include "font.h"
+#include "../gamecontext.h"
 #include "gui.h"
 #include "widget.h"
 #include "../config.h"
@@ -860,8 +861,13 @@ void GUI_Widget_ActionPanel_Draw(bool forceDraw)
 						} break;
 
 						case STRUCTURE_OUTPOST: {
+							uint16 unitCountAllied;
+							uint16 unitCountEnemy;
+
+							Unit_CountVisible(&unitCountAllied, &unitCountEnemy);
+
 							_Draw_Line(261, 95, 312, 95, 16);
-							Fancy_Text_Print(Extract_String(STR_RADAR_SCANFRIEND_2DENEMY_2D), 258, 88, 29, 0, 0x11, h->unitCountAllied, h->unitCountEnemy);
+							Fancy_Text_Print(Extract_String(STR_RADAR_SCANFRIEND_2DENEMY_2D), 258, 88, 29, 0, 0x11, unitCountAllied, unitCountEnemy);
 						} break;
 					}
 				} break;
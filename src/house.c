@@ -10,6 +10,7 @@
 
 #include "audio/driver.h"
 #include "audio/sound.h"
+#include "gamecontext.h"
 #include "gfx.h"
 #include "gui/gui.h"
 #include "gui/widget.h"
@@ -30,18 +31,11 @@
 #include "wsa.h"
 
 
-House *g_playerHouse = NULL;
-HousesType g_playerHouseID = HOUSE_INVALID;
-uint16 g_houseMissileCountdown = 0;
-uint16 g_playerCreditsNoSilo = 0;
-uint16 g_playerCredits = 0; /*!< Credits shown to player as 'current'. */
-uint32 g_tickHousePowerMaintenance = 0;
-
-static uint32 s_tickHouseHouse = 0;
-static uint32 s_tickHouseStarport = 0;
-static uint32 s_tickHouseReinforcement = 0;
-static uint32 s_tickHouseMissileCountdown = 0;
-static uint32 s_tickHouseStarportAvailability = 0;
+#define s_tickHouseHouse                (g_gameContext->tickHouseHouse)
+#define s_tickHouseStarport             (g_gameContext->tickHouseStarport)
+#define s_tickHouseReinforcement        (g_gameContext->tickHouseReinforcement)
+#define s_tickHouseMissileCountdown     (g_gameContext->tickHouseMissileCountdown)
+#define s_tickHouseStarportAvailability (g_gameContext->tickHouseStarportAvailability)
 
 static void House_EnsureHarvesterAvailable(uint8 houseID);
 
@@ -12,6 +12,7 @@
 #include "../gfx.h"
 #include "../gui/gui.h"
 #include "../input/mouse.h"
+#include "../input/replay.h"
 #include "../opendune.h"
 #include "../timer.h"
 
@@ -233,14 +234,18 @@ static uint16 Input_History_Add(uint16 value)
 static void Input_ReadInputFromFile(void)
 {
 	uint16 value;
-	uint16 mouseBuffer[2];
+	uint16 x;
+	uint16 y;
 
 	if (g_mouseMode == INPUT_MOUSE_MODE_NORMAL || g_mouseMode != INPUT_MOUSE_MODE_PLAY) return;
 
-	Read_File(g_mouseFileID, mouseBuffer, 4); /* Read failure not translated. */
+	if (!Replay_ReadEvent(&g_mouseInputValue, &g_mouseRecordedTimer, &x, &y)) {
+		/* End of the replay; no more input will come */
+		g_mouseNoRecordedValue = true;
+		return;
+	}
 
-	g_mouseRecordedTimer = mouseBuffer[1];
-	value = g_mouseInputValue = mouseBuffer[0];
+	value = g_mouseInputValue;
 
 	if ((value & 0xFF) != 0x2D) {
 		uint8 idx, bit;
@@ -263,10 +268,8 @@ static void Input_ReadInputFromFile(void)
 		}
 	}
 
-	Read_File(g_mouseFileID, mouseBuffer, 4); /* Read failure not translated. */
-
-	g_mouseX = g_mouseRecordedX = mouseBuffer[0];
-	value = g_mouseY = g_mouseRecordedY = mouseBuffer[1];
+	g_mouseX = g_mouseRecordedX = x;
+	value = g_mouseY = g_mouseRecordedY = y;
 
 	Mouse_HandleMovementIfMoved(value);
 	g_timerInput = 0;
@@ -303,7 +306,6 @@ static uint16 Input_AddHistory(uint16 value)
 void Input_HandleInput(uint16 input)
 {
 	uint16 oldTail;
-	uint16 saveSize = 0;
 
 	uint16 index;
 	uint16 value;
@@ -311,17 +313,13 @@ void Input_HandleInput(uint16 input)
 
 	uint16 inputMouseX;
 	uint16 inputMouseY;
-	uint16 tempBuffer[2];
 	uint16 flags; /* Mask for allowed input types. See InputFlagsEnum. */
 
 	flags       = g_inputFlags;
 	inputMouseX = g_mouseX;
 	inputMouseY = g_mouseY;
 
-	if (g_mouseMode == INPUT_MOUSE_MODE_RECORD) {
-		saveSize = 4;
-		if (g_fileOperation != 0) return;
-	}
+	if (g_mouseMode == INPUT_MOUSE_MODE_RECORD && g_fileOperation != 0) return;
 
 	if (input == 0) return;
 
@@ -411,13 +409,11 @@ void Input_HandleInput(uint16 input)
 			KeyBufferTail = oldTail;
 			return;
 		}
-		saveSize += 2;
 
 		if (Input_History_Add(inputMouseY) != 0) {
 			KeyBufferTail = oldTail;
 			return;
 		}
-		saveSize += 2;
 	}
 
 	bit_value = 1;
@@ -439,9 +435,7 @@ void Input_HandleInput(uint16 input)
 
 	if (g_mouseMode != INPUT_MOUSE_MODE_RECORD || value == 0x7D) return;
 
-	tempBuffer[0] = input;
-	tempBuffer[1] = g_timerInput;
-	File_Write(g_mouseFileID, tempBuffer, saveSize);
+	Replay_WriteEvent(input, g_timerInput, inputMouseX, inputMouseY);
 	g_timerInput = 0;
 }
 
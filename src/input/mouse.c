@@ -12,8 +12,8 @@
 #include "../gfx.h"
 #include "../gui/gui.h"
 #include "../input/input.h"
+#include "../input/replay.h"
 #include "../timer.h"
-#include "../tools.h"
 #include "../video/video.h"
 
 uint16 MouseUpdate;          /*!< Lock for when handling mouse movement. */
@@ -40,7 +40,7 @@ uint16 g_regionMaxY;         /*!< Region - maximum value for Y position. */
 
 uint8 MDisabled;       /*!< Mouse disabled flag */
 uint8 g_mouseHiddenDepth;
-uint8 g_mouseFileID;
+bool g_mouseHardwareCursor;  /*!< True if the video driver draws the mouse cursor, instead of it being drawn in SCREEN_0. */
 
 bool g_mouseNoRecordedValue; /*!< used in INPUT_MOUSE_MODE_PLAY */
 uint16 g_mouseInputValue;
@@ -154,24 +154,20 @@ void Mouse_SetMouseMode(uint8 mouseMode, const char *filename)
 
 		case INPUT_MOUSE_MODE_NORMAL:
 			g_mouseMode = mouseMode;
-			if (g_mouseFileID != 0xFF) {
+			if (Replay_IsOpen()) {
 				Input_Flags_ClearBits(INPUT_FLAG_KEY_RELEASE);
-				Close_File(g_mouseFileID);
+				Replay_Close();
 			}
-			g_mouseFileID = 0xFF;
 			g_mouseNoRecordedValue = true;
 			break;
 
 		case INPUT_MOUSE_MODE_RECORD:
-			if (g_mouseFileID != 0xFF) break;
+			if (Replay_IsOpen()) break;
 
-			File_Delete_Personal(filename);
-			File_Create_Personal(filename);
-
-			Tools_RandomLCG_Seed(0x1234);
-			Tools_Random_Seed(0x12344321);
-
-			g_mouseFileID = File_Open(filename, FILE_MODE_READ_WRITE);
+			if (!Replay_OpenRecord(filename)) {
+				mouseMode = INPUT_MOUSE_MODE_NORMAL;
+				break;
+			}
 
 			g_mouseMode = mouseMode;
 
@@ -181,34 +177,23 @@ void Mouse_SetMouseMode(uint8 mouseMode, const char *filename)
 			break;
 
 		case INPUT_MOUSE_MODE_PLAY:
-			if (g_mouseFileID == 0xFF) {
-				g_mouseFileID = File_Open(filename, FILE_MODE_READ);
-
-				Tools_RandomLCG_Seed(0x1234);
-				Tools_Random_Seed(0x12344321);
+			if (!Replay_IsOpen() && !Replay_OpenPlay(filename)) {
+				mouseMode = INPUT_MOUSE_MODE_NORMAL;
+				break;
 			}
 
 			g_mouseNoRecordedValue = true;
 
-			Read_File(g_mouseFileID, &g_mouseInputValue, 2);
-			if (Read_File(g_mouseFileID, &g_mouseRecordedTimer, 2) != 2) break;;
+			if (!Replay_ReadEvent(&g_mouseInputValue, &g_mouseRecordedTimer, &g_mouseRecordedX, &g_mouseRecordedY)) break;
 
-			if ((g_mouseInputValue >= 0x41 && g_mouseInputValue <= 0x44) || g_mouseInputValue == 0x2D) {
+			if (Replay_EventHasPosition(g_mouseInputValue)) {
 				/* 0x2D == '-' 0x41 == 'A' [...] 0x44 == 'D' */
-				Read_File(g_mouseFileID, &g_mouseRecordedX, 2);
-				if (Read_File(g_mouseFileID, &g_mouseRecordedY, 2) == 2) {
-					g_mouseX = g_mouseRecordedX;
-					g_mouseY = g_mouseRecordedY;
-					g_prevButtonState = 0;
-
-					Hide_Mouse();
-					Show_Mouse();
-
-					g_mouseNoRecordedValue = false;
-					break;
-				}
-				g_mouseNoRecordedValue = true;
-				break;
+				g_mouseX = g_mouseRecordedX;
+				g_mouseY = g_mouseRecordedY;
+				g_prevButtonState = 0;
+
+				Hide_Mouse();
+				Show_Mouse();
 			}
 			g_mouseNoRecordedValue = false;
 			break;
@@ -261,7 +246,7 @@ uint16 Mouse_CheckButtons(uint16 newButtonState)
  */
 static void Mouse_CheckMovement(uint16 mouseX, uint16 mouseY)
 {
-	if (g_mouseHiddenDepth == 0 && (g_mousePrevX != mouseX || g_mousePrevY != mouseY)) {
+	if (g_mouseHiddenDepth == 0 && !g_mouseHardwareCursor && (g_mousePrevX != mouseX || g_mousePrevY != mouseY)) {
 
 		if ((g_regionFlags & 0xC000) != 0xC000) {
 			Low_Hide_Mouse();
@@ -24,7 +24,7 @@ extern uint16 g_regionMaxY;
 
 extern uint8 MDisabled;
 extern uint8 g_mouseHiddenDepth;
-extern uint8 g_mouseFileID;
+extern bool g_mouseHardwareCursor;
 extern bool g_mouseNoRecordedValue;
 
 extern uint16 g_mouseInputValue;
@@ -0,0 +1,831 @@
+/** @file src/input/replay.c Replay routines.
+ *
+ * A replay records the input of a game, so it can be played back later.
+ *  It starts with a header ("ODRP", version, state of the randomizers),
+ *  followed by records. Each record starts with its type and the game tick
+ *  relative to the previous record (the first relative to zero) as varint.
+ *  - REPLAY_RECORD_EVENT: an input event. The input value and the delay in
+ *    input ticks are stored as varint. For mouse events the position is
+ *    stored as zigzag encoded varint relative to the previous position.
+ *  - REPLAY_RECORD_FRAME: a run of game loops which each advanced the game
+ *    timer with the same amount; the amount and the length of the run are
+ *    stored as varint. The first game loop stores the absolute game timer.
+ *  - REPLAY_RECORD_KEYFRAME: a 32bit length followed by the game timer, the
+ *    game timer of the first game loop, the state of the randomizers and a
+ *    savegame. It resets the relative position.
+ *
+ * When playing, all keyframes are indexed on open, so Replay_Seek() can jump
+ *  to the closest keyframe before a given game tick. Events and frames are
+ *  read with their own cursor, as events are read ahead of time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "types.h"
+#include "../os/endian.h"
+#include "../os/error.h"
+#include "../os/math.h"
+
+#include "replay.h"
+
+#include "../file.h"
+#include "../gamecontext.h"
+#include "../load.h"
+#include "../opendune.h"
+#include "../save.h"
+#include "../saveload/saveload.h"
+#include "../timer.h"
+#include "../tools.h"
+
+enum {
+	REPLAY_RECORD_EVENT    = 1,                             /*!< Record with an input event. */
+	REPLAY_RECORD_KEYFRAME = 2,                             /*!< Record with a keyframe. */
+	REPLAY_RECORD_FRAME    = 3,                             /*!< Record with a run of game loops. */
+
+	REPLAY_HEADER_SIZE   = 14,                              /*!< Size of the header of the replay. */
+	REPLAY_KEYFRAME_SIZE = 16                               /*!< Size of the keyframe data in front of the savegame. */
+};
+
+/**
+ * Information about a keyframe in the replay.
+ */
+typedef struct ReplayKeyframe {
+	uint32 tick;                                            /*!< The game tick of the keyframe. */
+	uint32 offset;                                          /*!< Offset in the file of the length of the keyframe. */
+} ReplayKeyframe;
+
+/**
+ * A position in the replay, with the state needed to decode relative values.
+ */
+typedef struct ReplayCursor {
+	FILE *fp;                                               /*!< The file, or NULL if not open. */
+	uint32 tick;                                            /*!< Game tick of the previous record. */
+	uint16 x;                                               /*!< X position of the previous mouse event. */
+	uint16 y;                                               /*!< Y position of the previous mouse event. */
+} ReplayCursor;
+
+static ReplayCursor s_replayEvents = { NULL, 0, 0, 0 };     /*!< Cursor for events; also used to record. */
+static ReplayCursor s_replayFrames = { NULL, 0, 0, 0 };     /*!< Cursor for frames when playing. */
+static bool s_replayRecording = false;                      /*!< True if recording, false if playing. */
+static uint32 s_replayNextKeyframe = 0;                     /*!< Game tick at which the next keyframe is recorded. */
+
+static bool s_replayFrameStarted = false;                   /*!< True after the first game loop. */
+static uint32 s_replayFrameBase = 0;                        /*!< Game timer of the first game loop. */
+static uint32 s_replayFrameTick = 0;                        /*!< Game timer of the previous game loop. */
+static uint32 s_replayFrameDelta = 0;                       /*!< Game ticks per game loop in the current run. */
+static uint32 s_replayFrameCount = 0;                       /*!< Length of the current run (left, when playing). */
+
+static ReplayKeyframe *s_replayKeyframes = NULL;            /*!< Index of all keyframes in the replay being played. */
+static uint16 s_replayKeyframeCount = 0;                    /*!< Amount of keyframes in #s_replayKeyframes. */
+static uint16 s_replayKeyframeSize = 0;                     /*!< Allocated size of #s_replayKeyframes. */
+
+static FILE *s_replayChecksumFile = NULL;                   /*!< File to write the checksums to, or NULL. */
+static FILE *s_replayStateFile = NULL;                      /*!< File to write the world state to with every checksum, or NULL. */
+static FILE *s_replayReferenceFile = NULL;                  /*!< File with the checksums to compare with, or NULL. */
+static FILE *s_replayReferenceStateFile = NULL;             /*!< File with the world states to compare with, or NULL. */
+static bool s_replayReferenceValid = false;                 /*!< True if the next checksum to compare with is read. */
+static uint32 s_replayReferenceTick = 0;                    /*!< Game tick of the next checksum to compare with. */
+static uint32 s_replayReferenceChecksum = 0;                /*!< The next checksum to compare with. */
+static uint32 s_replayChecksumInterval = 0;                 /*!< Game ticks between two checksums. */
+static uint32 s_replayNextChecksum = 0;                     /*!< Game tick (relative to the first game loop) of the next checksum. */
+
+static bool Replay_WriteVarint(FILE *fp, uint32 value)
+{
+	uint8 buffer[5];
+	uint8 length = 0;
+
+	while (value >= 0x80) {
+		buffer[length++] = (uint8)(value & 0x7F) | 0x80;
+		value >>= 7;
+	}
+	buffer[length++] = (uint8)value;
+
+	return fwrite(buffer, length, 1, fp) == 1;
+}
+
+static bool Replay_ReadVarint(FILE *fp, uint32 *value)
+{
+	uint8 shift;
+
+	*value = 0;
+	for (shift = 0; shift < 35; shift += 7) {
+		int c = fgetc(fp);
+		if (c == EOF) return false;
+
+		*value |= (uint32)(c & 0x7F) << shift;
+		if ((c & 0x80) == 0) return true;
+	}
+
+	return false;
+}
+
+static bool Replay_WritePosition(uint16 *previous, uint16 position)
+{
+	int32 delta = (int32)position - (int32)*previous;
+
+	*previous = position;
+	return Replay_WriteVarint(s_replayEvents.fp, (delta < 0) ? ((uint32)-delta << 1) - 1 : (uint32)delta << 1);
+}
+
+static bool Replay_ReadPosition(FILE *fp, uint16 *previous)
+{
+	uint32 value;
+
+	if (!Replay_ReadVarint(fp, &value)) return false;
+
+	if ((value & 1) != 0) {
+		*previous -= (uint16)((value + 1) >> 1);
+	} else {
+		*previous += (uint16)(value >> 1);
+	}
+	return true;
+}
+
+/**
+ * Start a record of the given type in the replay being recorded.
+ * @param type The type of the record.
+ * @return True if and only if all bytes were written successful.
+ */
+static bool Replay_WriteRecord(int type)
+{
+	uint32 tick = g_timerGame - s_replayEvents.tick;
+
+	s_replayEvents.tick = g_timerGame;
+
+	if (fputc(type, s_replayEvents.fp) == EOF) return false;
+	return Replay_WriteVarint(s_replayEvents.fp, tick);
+}
+
+/**
+ * Read the next record from the cursor.
+ * @param c The cursor to read from.
+ * @param type Where to store the type of the record.
+ * @param value Where to store the input value of an event, the game ticks
+ *   per game loop of a frame, or the offset of the length of a keyframe.
+ * @param extra Where to store the delay of an event, or the length of the
+ *   run of a frame.
+ * @return True if and only if a record was read completely.
+ */
+static bool Replay_ReadRecord(ReplayCursor *c, int *type, uint32 *value, uint32 *extra)
+{
+	uint32 tick;
+
+	*type = fgetc(c->fp);
+	if (*type == EOF) return false;
+
+	if (!Replay_ReadVarint(c->fp, &tick)) return false;
+	c->tick += tick;
+
+	switch (*type) {
+		case REPLAY_RECORD_KEYFRAME: {
+			uint8 buffer[4];
+
+			*value = ftell(c->fp);
+			if (fread(buffer, 4, 1, c->fp) != 1) return false;
+			if (fseek(c->fp, READ_LE_UINT32(buffer), SEEK_CUR) != 0) return false;
+
+			c->x = 0;
+			c->y = 0;
+			return true;
+		}
+
+		case REPLAY_RECORD_FRAME:
+			if (!Replay_ReadVarint(c->fp, value)) return false;
+			return Replay_ReadVarint(c->fp, extra);
+
+		case REPLAY_RECORD_EVENT:
+			if (!Replay_ReadVarint(c->fp, value)) return false;
+			if (!Replay_ReadVarint(c->fp, extra)) return false;
+
+			if (!Replay_EventHasPosition((uint16)*value)) return true;
+
+			if (!Replay_ReadPosition(c->fp, &c->x)) return false;
+			return Replay_ReadPosition(c->fp, &c->y);
+
+		default: return false;
+	}
+}
+
+/**
+ * Index all keyframes of the replay being played, and rewind to the
+ *  first record.
+ */
+static void Replay_IndexKeyframes(void)
+{
+	ReplayCursor *c = &s_replayEvents;
+	uint32 value;
+	uint32 extra;
+	int type;
+
+	s_replayKeyframeCount = 0;
+	c->tick = 0;
+
+	while (Replay_ReadRecord(c, &type, &value, &extra)) {
+		if (type != REPLAY_RECORD_KEYFRAME) continue;
+
+		if (s_replayKeyframeCount == s_replayKeyframeSize) {
+			ReplayKeyframe *keyframes;
+
+			keyframes = (ReplayKeyframe *)realloc(s_replayKeyframes, (s_replayKeyframeSize + 16) * sizeof(ReplayKeyframe));
+			if (keyframes == NULL) break;
+
+			s_replayKeyframes = keyframes;
+			s_replayKeyframeSize += 16;
+		}
+
+		s_replayKeyframes[s_replayKeyframeCount].tick   = c->tick;
+		s_replayKeyframes[s_replayKeyframeCount].offset = value;
+		s_replayKeyframeCount++;
+	}
+
+	fseek(c->fp, REPLAY_HEADER_SIZE, SEEK_SET);
+	c->tick = 0;
+	c->x = 0;
+	c->y = 0;
+}
+
+/**
+ * Write the current run of game loops to the replay being recorded.
+ * @return True if and only if all bytes were written successful.
+ */
+static bool Replay_WriteFrames(void)
+{
+	bool res;
+
+	if (s_replayFrameCount == 0) return true;
+
+	res = Replay_WriteRecord(REPLAY_RECORD_FRAME);
+	res = res && Replay_WriteVarint(s_replayEvents.fp, s_replayFrameDelta);
+	res = res && Replay_WriteVarint(s_replayEvents.fp, s_replayFrameCount);
+
+	s_replayFrameCount = 0;
+	return res;
+}
+
+/**
+ * Read the amount of game ticks of the next game loop from the replay
+ *  being played.
+ * @param delta Where to store the amount of game ticks.
+ * @return True if read, false at the end of the replay.
+ */
+static bool Replay_ReadFrame(uint32 *delta)
+{
+	while (s_replayFrameCount == 0) {
+		uint32 extra;
+		int type;
+
+		if (!Replay_ReadRecord(&s_replayFrames, &type, &s_replayFrameDelta, &extra)) return false;
+		if (type == REPLAY_RECORD_FRAME) s_replayFrameCount = extra;
+	}
+
+	s_replayFrameCount--;
+	*delta = s_replayFrameDelta;
+	return true;
+}
+
+/**
+ * Write a keyframe to the replay being recorded.
+ * @return True if and only if all bytes were written successful.
+ */
+static bool Replay_WriteKeyframe(void)
+{
+	static char description[] = "Replay";
+	uint8 header[4 + REPLAY_KEYFRAME_SIZE];
+	uint8 buffer[1024];
+	uint32 length;
+	uint32 lcg;
+	FILE *fp;
+	bool res;
+
+	/* Savegames expect to be at the start of a file */
+	fp = tmpfile();
+	if (fp == NULL) return false;
+
+	res = SaveGame_SaveStream(fp, description);
+	length = ftell(fp);
+	rewind(fp);
+
+	WRITE_LE_UINT32(header, REPLAY_KEYFRAME_SIZE + length);
+	WRITE_LE_UINT32(header + 4, g_timerGame);
+	WRITE_LE_UINT32(header + 8, s_replayFrameBase);
+	Tools_Random_GetState(header + 12, &lcg);
+	WRITE_LE_UINT32(header + 16, lcg);
+
+	res = res && Replay_WriteRecord(REPLAY_RECORD_KEYFRAME);
+	res = res && fwrite(header, sizeof(header), 1, s_replayEvents.fp) == 1;
+
+	while (res && length != 0) {
+		uint32 size = (length < sizeof(buffer)) ? length : sizeof(buffer);
+
+		res = fread(buffer, size, 1, fp) == 1 && fwrite(buffer, size, 1, s_replayEvents.fp) == 1;
+		length -= size;
+	}
+
+	fclose(fp);
+
+	s_replayEvents.x = 0;
+	s_replayEvents.y = 0;
+
+	return res;
+}
+
+/**
+ * Stop comparing with a reference.
+ */
+static void Replay_CloseReference(void)
+{
+	if (s_replayReferenceFile != NULL) fclose(s_replayReferenceFile);
+	if (s_replayReferenceStateFile != NULL) fclose(s_replayReferenceStateFile);
+	s_replayReferenceFile = NULL;
+	s_replayReferenceStateFile = NULL;
+}
+
+/**
+ * Write the world state to the state file.
+ * @param tick The game tick relative to the first game loop.
+ * @param state The world state.
+ * @param length The length of the world state.
+ */
+static void Replay_WriteState(uint32 tick, const uint8 *state, uint32 length)
+{
+	uint8 header[8];
+
+	WRITE_LE_UINT32(header, tick);
+	WRITE_LE_UINT32(header + 4, length);
+
+	if (fwrite(header, sizeof(header), 1, s_replayStateFile) == 1 && fwrite(state, length, 1, s_replayStateFile) == 1) return;
+
+	Error("Error while writing replay state.\n");
+	fclose(s_replayStateFile);
+	s_replayStateFile = NULL;
+}
+
+/**
+ * Print how the world state differs from the reference world state at
+ *  the given game tick, if the reference has one.
+ * @param tick The game tick relative to the first game loop.
+ * @param state The world state.
+ * @param length The length of the world state.
+ */
+static void Replay_CompareState(uint32 tick, const uint8 *state, uint32 length)
+{
+	uint8 header[8];
+
+	while (fread(header, sizeof(header), 1, s_replayReferenceStateFile) == 1) {
+		uint32 expectedLength = READ_LE_UINT32(header + 4);
+		uint8 *expected;
+
+		if (READ_LE_UINT32(header) != tick) {
+			if (fseek(s_replayReferenceStateFile, expectedLength, SEEK_CUR) != 0) break;
+			continue;
+		}
+
+		expected = (uint8 *)malloc(expectedLength);
+		if (expected == NULL) break;
+
+		if (fread(expected, expectedLength, 1, s_replayReferenceStateFile) == 1) {
+			SaveLoad_CompareState(expected, expectedLength, state, length);
+		}
+
+		free(expected);
+		return;
+	}
+
+	Warning("  No reference world state for game tick %u.\n", (unsigned int)tick);
+}
+
+/**
+ * Compare the checksum with the reference. On the first difference, it
+ *  reports the game tick and how the world state differs, and stops
+ *  comparing.
+ * @param tick The game tick relative to the first game loop.
+ * @param checksum The checksum of the world state.
+ * @param state The world state.
+ * @param length The length of the world state.
+ */
+static void Replay_CompareChecksum(uint32 tick, uint32 checksum, const uint8 *state, uint32 length)
+{
+	while (!s_replayReferenceValid || s_replayReferenceTick < tick) {
+		unsigned int t;
+		unsigned int c;
+
+		if (fscanf(s_replayReferenceFile, "%u %X", &t, &c) != 2) {
+			Replay_CloseReference();
+			return;
+		}
+
+		s_replayReferenceTick = t;
+		s_replayReferenceChecksum = c;
+		s_replayReferenceValid = true;
+	}
+
+	if (s_replayReferenceTick != tick || s_replayReferenceChecksum == checksum) return;
+
+	Warning("Replay out of sync at game tick %u (checksum %08X, expected %08X).\n", (unsigned int)tick, (unsigned int)checksum, (unsigned int)s_replayReferenceChecksum);
+
+	if (s_replayReferenceStateFile != NULL) Replay_CompareState(tick, state, length);
+
+	Replay_CloseReference();
+}
+
+/**
+ * Write the checksum of the world state if it is time for one, and compare
+ *  it with the reference.
+ */
+static void Replay_WriteChecksum(void)
+{
+	uint8 *state;
+	uint32 length;
+	uint32 checksum;
+	uint32 tick;
+
+	if (s_replayChecksumInterval == 0) return;
+
+	tick = g_timerGame - s_replayFrameBase;
+	if (tick < s_replayNextChecksum) return;
+
+	s_replayNextChecksum = (tick / s_replayChecksumInterval + 1) * s_replayChecksumInterval;
+
+	state = SaveLoad_GetState(&length);
+	if (state == NULL) return;
+
+	checksum = SaveLoad_CRC32(0, state, length);
+
+	if (s_replayChecksumFile != NULL) fprintf(s_replayChecksumFile, "%u %08X\n", (unsigned int)tick, (unsigned int)checksum);
+	if (s_replayStateFile != NULL) Replay_WriteState(tick, state, length);
+	if (s_replayReferenceFile != NULL) Replay_CompareChecksum(tick, checksum, state, length);
+
+	free(state);
+}
+
+/**
+ * Start recording a replay. The current state of the randomizers is stored
+ *  in the header, so playing back starts from the same state.
+ * @param filename The name of the replay in the personal data dir.
+ * @return True if and only if the replay could be created.
+ */
+bool Replay_OpenRecord(const char *filename)
+{
+	uint8 header[REPLAY_HEADER_SIZE];
+	uint32 lcg;
+
+	if (s_replayEvents.fp != NULL) return false;
+
+	s_replayEvents.fp = fopendatadir(SEARCHDIR_PERSONAL_DATA_DIR, filename, "wb");
+	if (s_replayEvents.fp == NULL) {
+		Error("Failed to open file '%s' for writing.\n", filename);
+		return false;
+	}
+
+	memcpy(header, "ODRP", 4);
+	WRITE_LE_UINT16(header + 4, REPLAY_VERSION);
+	Tools_Random_GetState(header + 6, &lcg);
+	WRITE_LE_UINT32(header + 10, lcg);
+
+	if (fwrite(header, REPLAY_HEADER_SIZE, 1, s_replayEvents.fp) != 1) {
+		Replay_Close();
+		return false;
+	}
+
+	s_replayRecording    = true;
+	s_replayEvents.tick  = 0;
+	s_replayEvents.x     = 0;
+	s_replayEvents.y     = 0;
+	s_replayNextKeyframe = 0;
+	s_replayFrameStarted = false;
+	s_replayFrameCount   = 0;
+	s_replayNextChecksum = 0;
+	return true;
+}
+
+/**
+ * Start playing a replay. The randomizers are set to the state stored in
+ *  the header, and all keyframes are indexed.
+ * @param filename The name of the replay in the personal data dir.
+ * @return True if and only if the replay could be opened.
+ */
+bool Replay_OpenPlay(const char *filename)
+{
+	uint8 header[REPLAY_HEADER_SIZE];
+
+	if (s_replayEvents.fp != NULL) return false;
+
+	s_replayEvents.fp = fopendatadir(SEARCHDIR_PERSONAL_DATA_DIR, filename, "rb");
+	s_replayFrames.fp = fopendatadir(SEARCHDIR_PERSONAL_DATA_DIR, filename, "rb");
+	if (s_replayEvents.fp == NULL || s_replayFrames.fp == NULL) {
+		Error("Failed to open file '%s' for reading.\n", filename);
+		Replay_Close();
+		return false;
+	}
+
+	if (fread(header, REPLAY_HEADER_SIZE, 1, s_replayEvents.fp) != 1 || memcmp(header, "ODRP", 4) != 0 || READ_LE_UINT16(header + 4) != REPLAY_VERSION) {
+		Error("Invalid header in replay '%s'.\n", filename);
+		Replay_Close();
+		return false;
+	}
+
+	Tools_Random_SetState(header + 6, READ_LE_UINT32(header + 10));
+
+	s_replayRecording = false;
+	Replay_IndexKeyframes();
+
+	fseek(s_replayFrames.fp, REPLAY_HEADER_SIZE, SEEK_SET);
+	s_replayFrames.tick  = 0;
+	s_replayFrameStarted = false;
+	s_replayFrameCount   = 0;
+	s_replayNextChecksum = 0;
+	return true;
+}
+
+/**
+ * Stop recording or playing the replay.
+ */
+void Replay_Close(void)
+{
+	if (s_replayEvents.fp != NULL && s_replayRecording && !Replay_WriteFrames()) {
+		Error("Error while writing replay.\n");
+	}
+
+	if (s_replayEvents.fp != NULL) fclose(s_replayEvents.fp);
+	if (s_replayFrames.fp != NULL) fclose(s_replayFrames.fp);
+	s_replayEvents.fp = NULL;
+	s_replayFrames.fp = NULL;
+
+	if (s_replayChecksumFile != NULL) fclose(s_replayChecksumFile);
+	if (s_replayStateFile != NULL) fclose(s_replayStateFile);
+	s_replayChecksumFile = NULL;
+	s_replayStateFile = NULL;
+	s_replayChecksumInterval = 0;
+	Replay_CloseReference();
+
+	free(s_replayKeyframes);
+	s_replayKeyframes = NULL;
+	s_replayKeyframeCount = 0;
+	s_replayKeyframeSize = 0;
+}
+
+/**
+ * Check if a replay is being recorded or played.
+ * @return True if and only if a replay is open.
+ */
+bool Replay_IsOpen(void)
+{
+	return s_replayEvents.fp != NULL;
+}
+
+/**
+ * Write a checksum of the world state to a file every given amount of game
+ *  ticks, while the replay is recorded or played. Comparing the file of a
+ *  recording with the file of playing it back shows the first game tick at
+ *  which they went out of sync. Ticks are counted from the first game loop.
+ * @param filename The name of the file in the personal data dir.
+ * @param stateFilename The name of the file to write the complete world
+ *   state to together with each checksum, or NULL to not write it.
+ * @param interval The amount of game ticks between two checksums.
+ * @return True if and only if the files could be created.
+ */
+bool Replay_SetChecksum(const char *filename, const char *stateFilename, uint32 interval)
+{
+	if (s_replayChecksumFile != NULL) fclose(s_replayChecksumFile);
+	if (s_replayStateFile != NULL) fclose(s_replayStateFile);
+	s_replayStateFile = NULL;
+
+	s_replayChecksumInterval = max(interval, 1);
+	s_replayNextChecksum = 0;
+
+	s_replayChecksumFile = fopendatadir(SEARCHDIR_PERSONAL_DATA_DIR, filename, "w");
+	if (s_replayChecksumFile == NULL) {
+		Error("Failed to open file '%s' for writing.\n", filename);
+		return false;
+	}
+
+	if (stateFilename == NULL) return true;
+
+	s_replayStateFile = fopendatadir(SEARCHDIR_PERSONAL_DATA_DIR, stateFilename, "wb");
+	if (s_replayStateFile == NULL) {
+		Error("Failed to open file '%s' for writing.\n", stateFilename);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Compare the checksums with the ones written by an earlier run, like the
+ *  recording of the replay being played or a run of another build. The
+ *  first checksum which differs is reported, together with the Houses,
+ *  Structures, Units and Tiles which differ if the earlier run also wrote
+ *  the world state. Needs Replay_SetChecksum() with the same interval.
+ * @param filename The name of the file with checksums in the personal data dir.
+ * @param stateFilename The name of the file with world states in the
+ *   personal data dir, or NULL.
+ * @return True if and only if the file with checksums could be opened.
+ */
+bool Replay_SetReference(const char *filename, const char *stateFilename)
+{
+	Replay_CloseReference();
+
+	s_replayReferenceFile = fopendatadir(SEARCHDIR_PERSONAL_DATA_DIR, filename, "r");
+	if (s_replayReferenceFile == NULL) return false;
+
+	if (stateFilename != NULL) s_replayReferenceStateFile = fopendatadir(SEARCHDIR_PERSONAL_DATA_DIR, stateFilename, "rb");
+
+	s_replayReferenceValid = false;
+	return true;
+}
+
+/**
+ * Check if an input event comes with a mouse position.
+ * @param value The input value.
+ * @return True if the mouse position is stored together with the event.
+ */
+bool Replay_EventHasPosition(uint16 value)
+{
+	value &= 0xFF;
+	return value == 0x2D || (value >= 0x41 && value <= 0x44);
+}
+
+/**
+ * Write an input event to the replay being recorded.
+ * @param value The input value.
+ * @param delay The amount of input ticks since the previous event.
+ * @param x The X position of the mouse.
+ * @param y The Y position of the mouse.
+ */
+void Replay_WriteEvent(uint16 value, uint16 delay, uint16 x, uint16 y)
+{
+	bool res;
+
+	if (s_replayEvents.fp == NULL || !s_replayRecording) return;
+
+	res = Replay_WriteRecord(REPLAY_RECORD_EVENT);
+	res = res && Replay_WriteVarint(s_replayEvents.fp, value);
+	res = res && Replay_WriteVarint(s_replayEvents.fp, delay);
+
+	if (res && Replay_EventHasPosition(value)) {
+		res = Replay_WritePosition(&s_replayEvents.x, x) && Replay_WritePosition(&s_replayEvents.y, y);
+	}
+
+	if (!res) {
+		Error("Error while writing replay.\n");
+		Replay_Close();
+	}
+}
+
+/**
+ * Read the next input event from the replay being played. Other records on
+ *  the way are skipped.
+ * @param value Where to store the input value.
+ * @param delay Where to store the amount of input ticks since the previous event.
+ * @param x Where to store the X position of the mouse.
+ * @param y Where to store the Y position of the mouse.
+ * @return True if an event was read, false at the end of the replay.
+ */
+bool Replay_ReadEvent(uint16 *value, uint16 *delay, uint16 *x, uint16 *y)
+{
+	uint32 v;
+	uint32 d;
+	int type;
+
+	if (s_replayEvents.fp == NULL || s_replayRecording) return false;
+
+	while (Replay_ReadRecord(&s_replayEvents, &type, &v, &d)) {
+		if (type != REPLAY_RECORD_EVENT) continue;
+
+		*value = (uint16)v;
+		*delay = (uint16)d;
+		*x = s_replayEvents.x;
+		*y = s_replayEvents.y;
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Handle the replay for a game loop. Called once per game loop, at a moment
+ *  the world state is consistent.
+ *
+ * When recording, it stores how far the game timer advanced since the
+ *  previous game loop, and a keyframe if it is time for one. When playing
+ *  with fast forward, it makes the game timer advance exactly the same.
+ */
+void Replay_Tick(void)
+{
+	uint32 delta;
+
+	if (s_replayEvents.fp == NULL) return;
+
+	if (s_replayRecording) {
+		bool res = true;
+
+		delta = s_replayFrameStarted ? g_timerGame - s_replayFrameTick : g_timerGame;
+		if (!s_replayFrameStarted) s_replayFrameBase = g_timerGame;
+		s_replayFrameStarted = true;
+		s_replayFrameTick = g_timerGame;
+
+		if (s_replayFrameCount != 0 && delta != s_replayFrameDelta) res = Replay_WriteFrames();
+		s_replayFrameDelta = delta;
+		s_replayFrameCount++;
+
+		if (res && g_timerGame >= s_replayNextKeyframe) {
+			s_replayNextKeyframe = g_timerGame + REPLAY_KEYFRAME_INTERVAL;
+
+			res = Replay_WriteFrames() && Replay_WriteKeyframe();
+		}
+
+		Replay_WriteChecksum();
+
+		if (!res) {
+			Error("Error while writing replay.\n");
+			Replay_Close();
+		}
+		return;
+	}
+
+	if (!s_replayFrameStarted) {
+		/* The first game loop only tells the game timer during recording */
+		Replay_ReadFrame(&delta);
+		s_replayFrameBase = g_timerGame;
+		s_replayFrameStarted = true;
+	}
+
+	Replay_WriteChecksum();
+
+	if (!Replay_ReadFrame(&delta)) {
+		/* The end of the recording; continue in real time */
+		if (Timer_IsFastForward()) Timer_SetFastForward(false);
+		return;
+	}
+
+	Timer_FastForward(delta);
+}
+
+/**
+ * Jump to the last keyframe at or before the given game tick, and restore
+ *  the world state from it. Playing continues with the first event after
+ *  the keyframe.
+ * @param tick The game tick to seek to.
+ * @return True if and only if a keyframe was found and loaded.
+ */
+bool Replay_Seek(uint32 tick)
+{
+	const ReplayKeyframe *k = NULL;
+	uint8 header[4 + REPLAY_KEYFRAME_SIZE];
+	uint8 buffer[1024];
+	uint32 length;
+	uint16 i;
+	FILE *fp;
+	bool res;
+
+	if (s_replayEvents.fp == NULL || s_replayRecording) return false;
+
+	for (i = 0; i < s_replayKeyframeCount; i++) {
+		if (s_replayKeyframes[i].tick > tick) break;
+		k = &s_replayKeyframes[i];
+	}
+	if (k == NULL) return false;
+
+	if (fseek(s_replayEvents.fp, k->offset, SEEK_SET) != 0) return false;
+	if (fread(header, sizeof(header), 1, s_replayEvents.fp) != 1) return false;
+
+	fp = tmpfile();
+	if (fp == NULL) return false;
+
+	res = true;
+	length = READ_LE_UINT32(header) - REPLAY_KEYFRAME_SIZE;
+	while (res && length != 0) {
+		uint32 size = (length < sizeof(buffer)) ? length : sizeof(buffer);
+
+		res = fread(buffer, size, 1, s_replayEvents.fp) == 1 && fwrite(buffer, size, 1, fp) == 1;
+		length -= size;
+	}
+	rewind(fp);
+
+	if (res) {
+		Game_Init();
+
+		/* The savegame stores timers relative to the game timer */
+		g_timerGame = READ_LE_UINT32(header + 4);
+		res = SaveGame_LoadStream(fp);
+
+		Tools_Random_SetState(header + 12, READ_LE_UINT32(header + 16));
+	}
+
+	fclose(fp);
+
+	s_replayEvents.tick = k->tick;
+	s_replayEvents.x = 0;
+	s_replayEvents.y = 0;
+
+	/* Frames continue right after the keyframe too */
+	fseek(s_replayFrames.fp, ftell(s_replayEvents.fp), SEEK_SET);
+	s_replayFrames.tick  = k->tick;
+	s_replayFrameStarted = true;
+	s_replayFrameBase    = READ_LE_UINT32(header + 8);
+	s_replayFrameCount   = 0;
+	s_replayNextChecksum = ((g_timerGame - s_replayFrameBase) / max(s_replayChecksumInterval, 1) + 1) * s_replayChecksumInterval;
+
+	return res;
+}
@@ -0,0 +1,25 @@
+/** @file src/input/replay.h Replay definitions. */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+enum {
+	REPLAY_VERSION = 2,                                     /*!< Version of the replay format. */
+	REPLAY_KEYFRAME_INTERVAL = 3600                         /*!< Amount of game ticks between two keyframes. */
+};
+
+extern bool Replay_OpenRecord(const char *filename);
+extern bool Replay_OpenPlay(const char *filename);
+extern void Replay_Close(void);
+extern bool Replay_IsOpen(void);
+extern bool Replay_SetChecksum(const char *filename, const char *stateFilename, uint32 interval);
+extern bool Replay_SetReference(const char *filename, const char *stateFilename);
+
+extern bool Replay_EventHasPosition(uint16 value);
+extern void Replay_WriteEvent(uint16 value, uint16 delay, uint16 x, uint16 y);
+extern bool Replay_ReadEvent(uint16 *value, uint16 *delay, uint16 *x, uint16 *y);
+
+extern void Replay_Tick(void);
+extern bool Replay_Seek(uint32 tick);
+
+#endif /* REPLAY_H */
@@ -12,6 +12,7 @@
 #include "audio/sound.h"
 #include "config.h"
 #include "file.h"
+#include "gamecontext.h"
 #include "gui/gui.h"
 #include "gui/widget.h"
 #include "house.h"
@@ -143,11 +144,10 @@ bool SaveGame_LoadFile(char *filename)
 		return false;
 	}
 
-	Sprites_LoadTiles();
+	/* Read the savegame in big blocks, not per chunk header or per struct */
+	setvbuf(fp, NULL, _IOFBF, SAVEGAME_BUFFER_SIZE);
 
-	g_validateStrictIfZero++;
-	res = Load_Main(fp);
-	g_validateStrictIfZero--;
+	res = SaveGame_LoadStream(fp);
 
 	fclose(fp);
 
@@ -156,6 +156,28 @@ bool SaveGame_LoadFile(char *filename)
 		return false;
 	}
 
+	return true;
+}
+
+/**
+ * Load a game from an already opened file. The savegame has to start at the
+ *  beginning of the file, and Game_Init() has to be called before.
+ *
+ * @param fp The file to load from.
+ * @return True if and only if the savegame was loaded successful.
+ */
+bool SaveGame_LoadStream(FILE *fp)
+{
+	bool res;
+
+	Sprites_LoadTiles();
+
+	g_validateStrictIfZero++;
+	res = Load_Main(fp);
+	g_validateStrictIfZero--;
+
+	if (!res) return false;
+
 	if (g_gameMode != GM_RESTART) Game_Prepare();
 
 	return true;
@@ -4,6 +4,7 @@
 #define LOAD_H
 
 extern bool SaveGame_LoadFile(char *filename);
+extern bool SaveGame_LoadStream(FILE *fp);
 extern void Load_Palette_Mercenaries(void);
 
 #endif /* LOAD_H */
@@ -12,6 +12,7 @@
 #include "animation.h"
 #include "audio/sound.h"
 #include "explosion.h"
+#include "gamecontext.h"
 #include "gfx.h"
 #include "gui/gui.h"
 #include "gui/widget.h"
@@ -32,22 +33,10 @@
 #include "file.h"
 
 
-uint16 g_mapSpriteID[64 * 64];
-Tile g_map[64 * 64];                                        /*!< All map data. */
 uint8 g_functions[3][3] = {{0, 1, 0}, {2, 3, 0}, {0, 1, 0}};
 
-uint8 g_dirtyMinimap[512];                                  /*!< Dirty tiles of the minimap (must be rendered again). */
-uint8 g_displayedMinimap[512];                              /*!< Displayed part of the minimap. */
-uint8 g_dirtyViewport[512];                                 /*!< Dirty tiles of the viewport (must be rendered again). */
-uint8 g_displayedViewport[512];                             /*!< Displayed part of the viewport. */
-
-uint16 g_changedTilesCount;                                 /*!< Number of changed tiles in #_changedTiles. */
-uint16 g_changedTiles[200];                                 /*!< Array of positions of changed tiles. */
-uint8 g_changedTilesMap[512];                               /*!< Bit array of changed tiles, in order not to loose changes. */
-
 static bool s_debugNoExplosionDamage = false;               /*!< When non-zero, explosions do no damage to their surrounding. */
 
-uint16 g_dirtyViewportCount = 0;
 bool g_selectionRectangleNeedRepaint = false;
 
 /**
@@ -297,6 +286,9 @@ void Map_UpdateMinimapPosition(uint16 packed, bool forceUpdate)
 
 			curPacked = packed + *m;
 			BitArray_Set(g_displayedMinimap, curPacked);
+
+			/* The rectangle is drawn over this tile; make sure it is drawn again once the rectangle moves away. */
+			GUI_Widget_Viewport_InvalidateTile(curPacked);
 		}
 	}
 
@@ -1328,6 +1320,12 @@ static void Map_UnveilTile_Neighbour(uint16 packed)
 
 	t->overlaySpriteID = spriteID;
 
+	if (t->Revealed && Sprite_Revealed(spriteID)) {
+		BitArray_Set(g_unveiledMap, packed);
+	} else {
+		BitArray_Clear(g_unveiledMap, packed);
+	}
+
 	Map_Update(packed, 0, false);
 }
 
@@ -1348,7 +1346,10 @@ bool Map_UnveilTile(uint16 packed, uint8 houseID)
 
 	t = &g_map[packed];
 
-	if (t->Revealed && Sprite_Revealed(t->overlaySpriteID)) return false;
+	if (t->Revealed && Sprite_Revealed(t->overlaySpriteID)) {
+		BitArray_Set(g_unveiledMap, packed);
+		return false;
+	}
 	t->Revealed = true;
 
 	Map_MarkTileDirty(packed);
@@ -1672,6 +1673,8 @@ void Map_CreateLandscape(uint32 seed)
 		t->index           = 0;
 	}
 
+	memset(g_unveiledMap, 0, sizeof(g_unveiledMap));
+
 	for (i = 0; i < 4096; i++) g_mapSpriteID[i] = g_map[i].groundSpriteID;
 }
 
@@ -67,24 +67,12 @@ typedef struct LandscapeInfo {
 
 struct Unit;
 
-extern uint16 g_mapSpriteID[64 * 64];
-extern Tile g_map[64 * 64];
 extern uint8 g_functions[3][3];
 
-extern uint8 g_dirtyMinimap[512];
-extern uint8 g_displayedMinimap[512];
-extern uint8 g_dirtyViewport[512];
-extern uint8 g_displayedViewport[512];
-
-extern uint16 g_changedTilesCount;
-extern uint16 g_changedTiles[200];
-extern uint8 g_changedTilesMap[512];
-
 extern const MapInfo g_mapInfos[3];
 extern const int16 g_table_mapDiff[4];
 extern const CellStruct g_table_tilediff[34][8];
 
-extern uint16 g_dirtyViewportCount;
 extern bool g_selectionRectangleNeedRepaint;
 
 extern const LandscapeInfo g_table_landscapeInfo[LST_MAX];
@@ -5,6 +5,7 @@
 
 #include "object.h"
 
+#include "gamecontext.h"
 #include "map.h"
 #include "pool/structure.h"
 #include "pool/unit.h"
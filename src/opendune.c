@@ -34,11 +34,14 @@
 #include "animation.h"
 #include "audio/driver.h"
 #include "audio/sound.h"
+#include "batch.h"
+#include "bench.h"
 #include "config.h"
 #include "crashlog/crashlog.h"
 #include "cutscene.h"
 #include "explosion.h"
 #include "file.h"
+#include "gamecontext.h"
 #include "gfx.h"
 #include "gui/font.h"
 #include "gui/gui.h"
@@ -50,13 +53,16 @@
 #include "inifile.h"
 #include "input/input.h"
 #include "input/mouse.h"
+#include "input/replay.h"
 #include "map.h"
 #include "pool/pool.h"
 #include "pool/house.h"
 #include "pool/unit.h"
 #include "pool/structure.h"
 #include "pool/team.h"
+#include "profile.h"
 #include "scenario.h"
+#include "snapshot.h"
 #include "sprites.h"
 #include "string.h"
 #include "structure.h"
@@ -80,15 +86,14 @@ bool g_dune2_enhanced = true; /*!< If false, the game acts exactly like the orig
 uint32 g_hintsShown1 = 0;          /*!< A bit-array to indicate which hints has been show already (0-31). */
 uint32 g_hintsShown2 = 0;          /*!< A bit-array to indicate which hints has been show already (32-63). */
 GameMode g_gameMode = GM_MENU;
-uint16 g_campaignID = 0;
-uint16 g_scenarioID = 1;
 uint16 g_activeAction = 0xFFFF;      /*!< Action the controlled unit will do. */
-uint32 g_tickScenarioStart = 0;      /*!< The tick the scenario started in. */
-static uint32 s_tickGameTimeout = 0; /*!< The tick the game will timeout. */
+
+#define s_tickGameTimeout (g_gameContext->tickGameTimeout)
 
 bool   g_debugGame = false;        /*!< When true, you can control the AI. */
 bool   g_debugScenario = false;    /*!< When true, you can review the scenario. There is no fog. The game is not running (no unit-movement, no structure-building, etc). You can click on individual tiles. */
 bool   g_debugSkipDialogs = false; /*!< When non-zero, you immediately go to house selection, and skip all intros. */
+bool   g_headless = false;         /*!< When true, there is no screen and no input; nothing may wait for the user. */
 
 void *g_readBuffer = NULL;
 uint32 g_readBufferSize = 0;
@@ -96,6 +101,11 @@ uint32 g_readBufferSize = 0;
 static bool  s_debugForceWin = false; /*!< When true, you immediately win the level. */
 
 static uint8 s_enableLog = 0; /*!< 0 = off, 1 = record game, 2 = playback game (stored in 'dune.log'). */
+static uint16 s_replayFastForward = 0; /*!< When non-zero, play back the game as fast as possible, drawing the screen every this many game ticks. */
+static uint32 s_replayChecksum = 0; /*!< When non-zero, write a checksum of the world state every this many game ticks while recording or playing back. */
+static bool  s_replayState = false; /*!< When true, write the complete world state together with each checksum while recording. */
+static uint32 s_replaySeek = 0; /*!< When non-zero, jump to the last keyframe at or before this game tick when playing back. */
+static char  s_startupTrace[64]; /*!< When not empty, the file to write a profile of the startup to. */
 
 uint16 g_validateStrictIfZero = 0; /*!< 0 = strict validation, basically: no-cheat-mode. */
 bool g_running = true; /*!< true if game needs to keep running; false to stop the game. */
@@ -111,7 +121,7 @@ int16 g_musicInBattle = 0; /*!< 0 = no battle, 1 = fight is going on, -1 = music
  *
  * @return True if and only if the level has come to an end.
  */
-static bool GameLoop_IsLevelFinished(void)
+bool GameLoop_IsLevelFinished(void)
 {
 	bool finish = false;
 
@@ -181,7 +191,7 @@ static bool GameLoop_IsLevelFinished(void)
  *
  * @return True if and only if the level has been won by the human.
  */
-static bool GameLoop_IsLevelWon(void)
+bool GameLoop_IsLevelWon(void)
 {
 	bool win = false;
 
@@ -891,24 +901,18 @@ static void InGame_Numpad_Move(uint16 key)
 }
 
 /**
- * Main game loop.
+ * Load everything a game needs which does not change between games: strings,
+ *  sprites, palettes, the team and structure scripts and the profile.
  */
-static void GameLoop_Main(void)
+void GameLoop_Init(void)
 {
-	static uint32 l_timerNext = 0;
-	static uint32 l_timerUnitStatus = 0;
-	static int16  l_selectionState = -2;
-
-	uint16 key;
-
+	Profile_Begin("String_Init");
 	String_Init();
-	Sprites_Init();
+	Profile_End();
 
-#ifdef MUNT
-	if (IniFile_GetInteger("mt32midi", 1) != 0) MT32_Init();
-#else
-	if (IniFile_GetInteger("mt32midi", 0) != 0) MT32_Init();
-#endif
+	Profile_Begin("Sprites_Init");
+	Sprites_Init();
+	Profile_End();
 
 	Input_Flags_SetBits(INPUT_FLAG_KEY_REPEAT | INPUT_FLAG_UNKNOWN_0010 | INPUT_FLAG_UNKNOWN_0200 |
 	                    INPUT_FLAG_UNKNOWN_2000);
@@ -938,7 +942,9 @@ static void GameLoop_Main(void)
 
 	free(g_readBuffer); g_readBuffer = NULL;
 
+	Profile_Begin("IBM.PAL");
 	Load_Data("IBM.PAL", GamePalette, 256 * 3);
+	Profile_End();
 
 	GUI_ClearScreen(SCREEN_0);
 
@@ -960,8 +966,13 @@ static void GameLoop_Main(void)
 	g_paletteMapping2[0xDF] = 0xDF;
 	g_paletteMapping2[0xEF] = 0xEF;
 
+	Profile_Begin("TEAM.EMC");
 	Script_LoadFromFile("TEAM.EMC", g_scriptTeam, g_scriptFunctionsTeam, NULL);
+	Profile_End();
+
+	Profile_Begin("BUILD.EMC");
 	Script_LoadFromFile("BUILD.EMC", g_scriptStructure, g_scriptFunctionsStructure, NULL);
+	Profile_End();
 
 	GUI_Palette_CreateRemap(HOUSE_MERCENARY);
 
@@ -979,6 +990,26 @@ static void GameLoop_Main(void)
 	Team_Init();
 	House_Init();
 	Structure_Init();
+}
+
+/**
+ * Main game loop.
+ */
+static void GameLoop_Main(void)
+{
+	static uint32 l_timerNext = 0;
+	static uint32 l_timerUnitStatus = 0;
+	static int16  l_selectionState = -2;
+
+	uint16 key;
+
+	GameLoop_Init();
+
+#ifdef MUNT
+	if (IniFile_GetInteger("mt32midi", 1) != 0) MT32_Init();
+#else
+	if (IniFile_GetInteger("mt32midi", 0) != 0) MT32_Init();
+#endif
 
 	Show_Mouse();
 
@@ -991,6 +1022,9 @@ static void GameLoop_Main(void)
 		g_gameMode = GM_NORMAL;
 	}
 
+	/* Startup is done; the first frame is drawn from here on */
+	if (s_startupTrace[0] != '\0') Profile_Save(s_startupTrace);
+
 	for (;; sleepIdle()) {
 		if (g_gameMode == GM_MENU) {
 			GameLoop_GameIntroAnimationMenu();
@@ -1006,7 +1040,24 @@ static void GameLoop_Main(void)
 
 			_Clear_KeyBuffer();
 
-			if (s_enableLog != 0) Mouse_SetMouseMode((uint8)s_enableLog, "DUNE.LOG");
+			if (s_enableLog != 0) {
+				Mouse_SetMouseMode((uint8)s_enableLog, "DUNE.LOG");
+
+				if (Replay_IsOpen() && s_replayChecksum != 0) {
+					if (s_enableLog == INPUT_MOUSE_MODE_RECORD) {
+						Replay_SetChecksum("DUNEREC.CRC", s_replayState ? "DUNEREC.STA" : NULL, s_replayChecksum);
+					} else {
+						/* Compare with the recording, to find where it goes out of sync */
+						Replay_SetChecksum("DUNEPLAY.CRC", NULL, s_replayChecksum);
+						Replay_SetReference("DUNEREC.CRC", "DUNEREC.STA");
+					}
+				}
+
+				if (Replay_IsOpen() && s_enableLog == INPUT_MOUSE_MODE_PLAY && s_replayFastForward != 0) {
+					Timer_SetFastForward(true);
+					Timer_Change(Video_Tick, 1000000 / 60 * s_replayFastForward);
+				}
+			}
 
 			Set_Palette(GamePalette);
 
@@ -1016,6 +1067,10 @@ static void GameLoop_Main(void)
 		if (g_gameMode == GM_PICKHOUSE) {
 			Music_Play(28);
 
+			/* Read the tiles while the player picks a House */
+			Sprites_PreloadTiles();
+			File_Preload_Start();
+
 			g_playerHouseID = HOUSE_MERCENARY;
 			g_playerHouseID = Choose_Side();
 
@@ -1105,12 +1160,40 @@ static void GameLoop_Main(void)
 
 			GUI_DrawCredits(g_playerHouseID, 0);
 
+			if (s_replaySeek != 0 && Replay_IsOpen() && g_mouseMode == INPUT_MOUSE_MODE_PLAY) {
+				if (Replay_Seek(s_replaySeek)) {
+					/* Input read ahead of the keyframe is stale; read the first event after it */
+					_Clear_KeyBuffer();
+					g_timerInput = 0;
+					Mouse_SetMouseMode(INPUT_MOUSE_MODE_PLAY, NULL);
+				} else {
+					Warning("No keyframe in the replay at or before game tick %u\n", (unsigned int)s_replaySeek);
+				}
+				s_replaySeek = 0;
+			}
+
+			Replay_Tick();
+			Snapshot_Check();
+
+			Profile_Section_Begin(PROFILE_SECTION_TEAM);
 			GameLoop_Team();
+			Profile_Section_End(PROFILE_SECTION_TEAM);
+
+			Profile_Section_Begin(PROFILE_SECTION_UNIT);
 			GameLoop_Unit();
+			Profile_Section_End(PROFILE_SECTION_UNIT);
+
+			Profile_Section_Begin(PROFILE_SECTION_STRUCTURE);
 			GameLoop_Structure();
+			Profile_Section_End(PROFILE_SECTION_STRUCTURE);
+
+			Profile_Section_Begin(PROFILE_SECTION_HOUSE);
 			GameLoop_House();
+			Profile_Section_End(PROFILE_SECTION_HOUSE);
 
+			Profile_Section_Begin(PROFILE_SECTION_DRAWSCREEN);
 			GUI_DrawScreen(SCREEN_0);
+			Profile_Section_End(PROFILE_SECTION_DRAWSCREEN);
 		}
 
 		GUI_DisplayText(NULL, 0);
@@ -1239,21 +1322,29 @@ int main(int argc, char **argv)
 #endif
 	CrashLog_Init();
 
-	VARIABLE_NOT_USED(argc);
-	VARIABLE_NOT_USED(argv);
+	Profile_Begin("Startup");
 
 	/* Load opendune.ini file */
+	Profile_Begin("Load_IniFile");
 	Load_IniFile();
+	Profile_End();
+
+	/* Only keep the startup profile if it is wanted */
+	if (IniFile_GetString("startuptrace", NULL, s_startupTrace, sizeof(s_startupTrace)) == NULL) Profile_Stop();
 
+	Profile_Begin("File_Init");
 	if (!File_Init()) {
 		exit(1);
 	}
+	Profile_End();
 
 	/* Loading config from dune.cfg */
+	Profile_Begin("Decode_Config_Struct");
 	if (!Decode_Config_Struct("dune.cfg", &g_config)) {
 		Config_Default(&g_config);
 		commit_dune_cfg = true;
 	}
+	Profile_End();
 	/* reading config from opendune.ini which prevail over dune.cfg */
 	SetLanguage_From_IniFile(&g_config);
 
@@ -1263,9 +1354,36 @@ int main(int argc, char **argv)
 		exit(1);
 	}
 
+	/* Also checked while simulating with "--batch" */
+	Snapshot_SetCheck((uint32)IniFile_GetInteger("snapshotcheck", 0));
+
+	/* "--batch <jobs> [report]" simulates the jobs without a screen, and quits */
+	if (argc >= 3 && strcmp(argv[1], "--batch") == 0) {
+		exit(Batch_Run(argv[2], (argc >= 4) ? argv[3] : NULL) ? 0 : 1);
+	}
+
+	/* "--bench [report]" times the pixel kernels, and quits */
+	if (argc >= 2 && strcmp(argv[1], "--bench") == 0) {
+		exit(Bench_Run((argc >= 3) ? argv[2] : NULL) ? 0 : 1);
+	}
+
+	/* Read the data needed to get to the menu while the rest starts up */
+	Profile_Begin("File_Preload");
+	String_Preload();
+	Sprites_Preload();
+	File_Preload("IBM.PAL");
+	File_Preload("TEAM.EMC");
+	File_Preload("BUILD.EMC");
+	File_Preload_Start();
+	Profile_End();
+
+	Profile_Begin("Input_Init");
 	Input_Init();
+	Profile_End();
 
+	Profile_Begin("Sound_Init");
 	Sound_Init();
+	Profile_End();
 
 	scaling_factor = IniFile_GetInteger("scalefactor", 2);
 	if (IniFile_GetString("scalefilter", NULL, filter_text, sizeof(filter_text)) != NULL) {
@@ -1281,8 +1399,29 @@ int main(int argc, char **argv)
 	}
 
 	frame_rate = IniFile_GetInteger("framerate", 60);
+	g_mouseHardwareCursor = (IniFile_GetInteger("hardwarecursor", 0) != 0);
+
+	if (IniFile_GetString("replay", NULL, filter_text, sizeof(filter_text)) != NULL) {
+		if (strcasecmp(filter_text, "record") == 0) {
+			s_enableLog = INPUT_MOUSE_MODE_RECORD;
+		} else if (strcasecmp(filter_text, "play") == 0) {
+			s_enableLog = INPUT_MOUSE_MODE_PLAY;
+		} else {
+			Error("unrecognized replay value '%s'\n", filter_text);
+		}
+	}
+	s_replayFastForward = (uint16)IniFile_GetInteger("replayfast", 0);
+	s_replayChecksum = (uint32)IniFile_GetInteger("replaychecksum", 0);
+	s_replayState = (IniFile_GetInteger("replaystate", 0) != 0);
+	s_replaySeek = (uint32)IniFile_GetInteger("replayseek", 0);
+
+	if (IniFile_GetString("frametrace", NULL, filter_text, sizeof(filter_text)) != NULL) {
+		if (!Profile_Trace_Start(filter_text)) Warning("Not enough memory for the frame trace\n");
+	}
 
+	Profile_Begin("OpenDune_Init");
 	if (!OpenDune_Init(scaling_factor, scale_filter, frame_rate)) exit(1);
+	Profile_End();
 
 	MDisabled = 0;
 
@@ -1437,6 +1576,7 @@ void Game_Init(void)
 	memset(g_changedTilesMap,   0, sizeof(g_changedTilesMap));
 	memset(g_dirtyViewport,     0, sizeof(g_dirtyViewport));
 	memset(g_dirtyMinimap,      0, sizeof(g_dirtyMinimap));
+	memset(g_unveiledMap,       0, sizeof(g_unveiledMap));
 
 	memset(g_mapSpriteID, 0, 64 * 64 * sizeof(uint16));
 	memset(g_starportAvailable, 0, sizeof(g_starportAvailable));
@@ -1505,7 +1645,9 @@ void Prog_End(void)
 
 	Drivers_All_Uninit();
 
-	if (g_mouseFileID != 0xFF) Mouse_SetMouseMode(INPUT_MOUSE_MODE_NORMAL, NULL);
+	Profile_Trace_Stop();
+
+	if (Replay_IsOpen()) Mouse_SetMouseMode(INPUT_MOUSE_MODE_NORMAL, NULL);
 
 	File_Uninit();
 	Timer_Uninit();
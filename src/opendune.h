@@ -22,13 +22,11 @@ extern bool g_dune2_enhanced;
 extern uint32 g_hintsShown1;
 extern uint32 g_hintsShown2;
 extern GameMode g_gameMode;
-extern uint16 g_campaignID;
-extern uint16 g_scenarioID;
 extern uint16 g_activeAction;
-extern uint32 g_tickScenarioStart;
 extern bool   g_debugGame;
 extern bool   g_debugScenario;
 extern bool   g_debugSkipDialogs;
+extern bool   g_headless;
 
 extern uint16 g_validateStrictIfZero;
 extern bool g_running;
@@ -45,7 +43,10 @@ extern uint32 g_readBufferSize;
 extern void Game_Prepare(void);
 extern void Game_Init(void);
 extern void Game_LoadScenario(uint8 houseID, uint16 scenarioID);
+extern void GameLoop_Init(void);
 extern void GameLoop_Uninit(void);
+extern bool GameLoop_IsLevelFinished(void);
+extern bool GameLoop_IsLevelWon(void);
 extern void Prog_End(void);
 
 #endif /* OPENDUNE_H */
@@ -8,8 +8,14 @@
 	typedef HANDLE Thread;
 	typedef HANDLE Semaphore;
 	typedef DWORD ThreadStatus;
+#elif !defined(TOS)
+	typedef struct PosixThread *Thread;
+	typedef struct PosixSemaphore *Semaphore;
+	typedef int ThreadStatus;
+
+	#define WINAPI
 #else
-/* Thead is only used with Windows
+/* Thead is not available on Atari
 	#include <SDL.h>
 	#include <SDL_thread.h>
 	typedef SDL_Thread *Thread;
@@ -20,16 +26,18 @@
 */
 #endif /* _WIN32 */
 
-#if defined(_WIN32)
+#if !defined(TOS)
 typedef ThreadStatus (WINAPI *ThreadProc)(void *);
 
 extern Thread Thread_Create(ThreadProc proc, void *data);
 extern void Thread_Wait(Thread thread, ThreadStatus *status);
+extern uint32 Thread_GetTime(void);
+extern void Thread_SleepUntil(uint32 time);
 extern Semaphore Semaphore_Create(int value);
 extern bool Semaphore_Unlock(Semaphore sem);
 extern bool Semaphore_Lock(Semaphore sem);
 extern bool Semaphore_TryLock(Semaphore sem);
 extern void Semaphore_Destroy(Semaphore sem);
-#endif /* _WIN32 */
+#endif /* TOS */
 
 #endif /* OS_THREAD_H */
@@ -0,0 +1,209 @@
+/** @file src/os/thread_posix.c Platform dependant thread implementation for POSIX systems. */
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "types.h"
+
+#include "thread.h"
+
+#if defined(_POSIX_MONOTONIC_CLOCK) && _POSIX_MONOTONIC_CLOCK >= 0 && !defined(__APPLE__)
+	#define THREAD_ABSOLUTE_SLEEP
+#endif /* _POSIX_MONOTONIC_CLOCK */
+
+/**
+ * A thread, with what its procedure returned.
+ */
+struct PosixThread {
+	pthread_t thread;                                       /*!< The pthread. */
+	ThreadProc proc;                                        /*!< The procedure running in the thread. */
+	void *data;                                             /*!< The argument for the procedure. */
+	ThreadStatus status;                                    /*!< The value the procedure returned. */
+};
+
+/**
+ * A semaphore with a maximum count of 1, like the win32 one is created.
+ */
+struct PosixSemaphore {
+	pthread_mutex_t mutex;                                  /*!< Protects count. */
+	pthread_cond_t cond;                                    /*!< Signalled when count becomes 1. */
+	int count;                                              /*!< 1 if the semaphore is free, 0 if locked. */
+};
+
+static void *Thread_Main(void *arg)
+{
+	Thread thread = (Thread)arg;
+
+	thread->status = thread->proc(thread->data);
+	return NULL;
+}
+
+/**
+ * Create and start a thread. All signals are blocked in the thread, so the
+ *  timer signal keeps being handled by the main thread.
+ * @param proc The procedure to run in the thread.
+ * @param data The argument for the procedure.
+ * @return The thread, or NULL on failure.
+ */
+Thread Thread_Create(ThreadProc proc, void *data)
+{
+	Thread thread;
+	sigset_t all;
+	sigset_t old;
+	int res;
+
+	thread = (Thread)malloc(sizeof(struct PosixThread));
+	if (thread == NULL) return NULL;
+
+	thread->proc   = proc;
+	thread->data   = data;
+	thread->status = 0;
+
+	sigfillset(&all);
+	pthread_sigmask(SIG_SETMASK, &all, &old);
+	res = pthread_create(&thread->thread, NULL, Thread_Main, thread);
+	pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+	if (res != 0) {
+		free(thread);
+		return NULL;
+	}
+	return thread;
+}
+
+void Thread_Wait(Thread thread, ThreadStatus *status)
+{
+	pthread_join(thread->thread, NULL);
+	if (status != NULL) *status = thread->status;
+	free(thread);
+}
+
+/**
+ * Get a monotonic time with a microsecond resolution (where the platform
+ *  allows). Only differences between two calls are meaningful.
+ * @return The time in microseconds.
+ */
+uint32 Thread_GetTime(void)
+{
+#if defined(THREAD_ABSOLUTE_SLEEP)
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (uint32)tv.tv_sec * 1000000 + tv.tv_usec;
+#endif /* THREAD_ABSOLUTE_SLEEP */
+}
+
+/**
+ * Sleep until an absolute time. Where the platform has clock_nanosleep(),
+ *  the kernel wakes the thread at the deadline itself, so neither the time
+ *  to get here nor an interruption makes the sleep drift.
+ * @param time The time to wake up, as returned by Thread_GetTime().
+ */
+void Thread_SleepUntil(uint32 time)
+{
+#if defined(THREAD_ABSOLUTE_SLEEP)
+	struct timespec ts;
+	int32 remaining;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	remaining = (int32)(time - ((uint32)ts.tv_sec * 1000000 + ts.tv_nsec / 1000));
+	if (remaining <= 0) return;
+
+	ts.tv_sec  += remaining / 1000000;
+	ts.tv_nsec += (remaining % 1000000) * 1000;
+	if (ts.tv_nsec >= 1000000000) {
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000;
+	}
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+#else
+	int32 remaining;
+
+	while ((remaining = (int32)(time - Thread_GetTime())) > 0) {
+		struct timespec ts;
+
+		ts.tv_sec  = remaining / 1000000;
+		ts.tv_nsec = (remaining % 1000000) * 1000;
+		nanosleep(&ts, NULL);
+	}
+#endif /* THREAD_ABSOLUTE_SLEEP */
+}
+
+Semaphore Semaphore_Create(int value)
+{
+	Semaphore sem;
+
+	sem = (Semaphore)malloc(sizeof(struct PosixSemaphore));
+	if (sem == NULL) return NULL;
+
+	if (pthread_mutex_init(&sem->mutex, NULL) != 0) {
+		free(sem);
+		return NULL;
+	}
+	if (pthread_cond_init(&sem->cond, NULL) != 0) {
+		pthread_mutex_destroy(&sem->mutex);
+		free(sem);
+		return NULL;
+	}
+	sem->count = (value != 0) ? 1 : 0;
+
+	return sem;
+}
+
+bool Semaphore_Unlock(Semaphore sem)
+{
+	bool ret = false;
+
+	pthread_mutex_lock(&sem->mutex);
+	if (sem->count == 0) {
+		sem->count = 1;
+		pthread_cond_signal(&sem->cond);
+		ret = true;
+	}
+	pthread_mutex_unlock(&sem->mutex);
+
+	return ret;
+}
+
+bool Semaphore_Lock(Semaphore sem)
+{
+	pthread_mutex_lock(&sem->mutex);
+	while (sem->count == 0) pthread_cond_wait(&sem->cond, &sem->mutex);
+	sem->count = 0;
+	pthread_mutex_unlock(&sem->mutex);
+
+	return true;
+}
+
+bool Semaphore_TryLock(Semaphore sem)
+{
+	bool ret = false;
+
+	pthread_mutex_lock(&sem->mutex);
+	if (sem->count != 0) {
+		sem->count = 0;
+		ret = true;
+	}
+	pthread_mutex_unlock(&sem->mutex);
+
+	return ret;
+}
+
+void Semaphore_Destroy(Semaphore sem)
+{
+	if (sem == NULL) return;
+
+	pthread_cond_destroy(&sem->cond);
+	pthread_mutex_destroy(&sem->mutex);
+	free(sem);
+}
@@ -16,6 +16,35 @@ void Thread_Wait(Thread thread, ThreadStatus *status)
 	CloseHandle(thread);
 }
 
+/**
+ * Get a monotonic time with a microsecond resolution. Only differences
+ *  between two calls are meaningful.
+ * @return The time in microseconds.
+ */
+uint32 Thread_GetTime(void)
+{
+	static LARGE_INTEGER l_frequency;
+	LARGE_INTEGER counter;
+
+	if (l_frequency.QuadPart == 0) QueryPerformanceFrequency(&l_frequency);
+	QueryPerformanceCounter(&counter);
+	return (uint32)(counter.QuadPart / l_frequency.QuadPart * 1000000 + counter.QuadPart % l_frequency.QuadPart * 1000000 / l_frequency.QuadPart);
+}
+
+/**
+ * Sleep until an absolute time. Sleep() only knows milliseconds, so this
+ *  wakes up to a millisecond early.
+ * @param time The time to wake up, as returned by Thread_GetTime().
+ */
+void Thread_SleepUntil(uint32 time)
+{
+	int32 remaining;
+
+	while ((remaining = (int32)(time - Thread_GetTime())) >= 1000) {
+		Sleep(remaining / 1000);
+	}
+}
+
 Semaphore Semaphore_Create(int value)
 {
 	return CreateSemaphore(NULL, value, 1, NULL);
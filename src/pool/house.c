@@ -6,13 +6,14 @@
 
 #include "house.h"
 
+#include "../gamecontext.h"
 #include "pool.h"
 #include "unit.h"
 #include "../house.h"
 
-static struct House g_houseArray[HOUSE_INDEX_MAX];
-static struct House *g_houseFindArray[HOUSE_INDEX_MAX];
-static uint16 g_houseFindCount;
+#define g_houseArray     (g_gameContext->houseArray)
+#define g_houseFindArray (g_gameContext->houseFindArray)
+#define g_houseFindCount (g_gameContext->houseFindCount)
 
 /**
  * Get a House from the pool with the indicated index.
@@ -7,15 +7,16 @@
 
 #include "structure.h"
 
+#include "../gamecontext.h"
 #include "house.h"
 #include "pool.h"
 #include "../house.h"
 #include "../opendune.h"
 #include "../structure.h"
 
-static struct Structure g_structureArray[STRUCTURE_INDEX_MAX_HARD];
-static struct Structure *g_structureFindArray[STRUCTURE_INDEX_MAX_SOFT];
-static uint16 g_structureFindCount;
+#define g_structureArray     (g_gameContext->structureArray)
+#define g_structureFindArray (g_gameContext->structureFindArray)
+#define g_structureFindCount (g_gameContext->structureFindCount)
 
 /**
  * Get a Structure from the pool with the indicated index.
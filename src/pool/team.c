@@ -7,13 +7,14 @@
 
 #include "team.h"
 
+#include "../gamecontext.h"
 #include "../house.h"
 #include "pool.h"
 #include "../team.h"
 
-static struct Team g_teamArray[TEAM_INDEX_MAX];
-static struct Team *g_teamFindArray[TEAM_INDEX_MAX];
-static uint16 g_teamFindCount;
+#define g_teamArray     (g_gameContext->teamArray)
+#define g_teamFindArray (g_gameContext->teamFindArray)
+#define g_teamFindCount (g_gameContext->teamFindCount)
 
 /**
  * Get a Team from the pool with the indicated index.
@@ -7,16 +7,20 @@
 
 #include "unit.h"
 
+#include "../gamecontext.h"
 #include "pool.h"
 #include "house.h"
 #include "../house.h"
 #include "../opendune.h"
+#include "../tile.h"
 #include "../unit.h"
 
 
-static struct Unit g_unitArray[UNIT_INDEX_MAX];
-struct Unit *g_unitFindArray[UNIT_INDEX_MAX];
-uint16 g_unitFindCount;
+#define g_unitArray     (g_gameContext->unitArray)
+#define g_unitDrawArray (g_gameContext->unitDrawArray)
+#define g_unitDrawKey   (g_gameContext->unitDrawKey)
+#define g_unitDrawSlot  (g_gameContext->unitDrawSlot)
+#define g_unitDrawCount (g_gameContext->unitDrawCount)
 
 /**
  * Get a Unit from the pool with the indicated index.
@@ -57,6 +61,109 @@ Unit *Unit_Find(PoolFindStruct *find)
 	return NULL;
 }
 
+/**
+ * Find the first matching Unit, like Unit_Find(), but walk over the Units in
+ *  the order they should be drawn in: from top to bottom, with foot Units a
+ *  tile lower than others, so they appear in front.
+ *
+ * @param find A pointer to a PoolFindStruct which contains filter data and
+ *   last known tried index.
+ * @return The Unit, or NULL if nothing matches (anymore).
+ */
+Unit *Unit_FindInDrawOrder(PoolFindStruct *find)
+{
+	if (find->index >= g_unitDrawCount && find->index != 0xFFFF) return NULL;
+	find->index++; /* First, we always go to the next index */
+
+	for (; find->index < g_unitDrawCount; find->index++) {
+		Unit *u = g_unitDrawArray[find->index];
+
+		if (u->o.flags.s.isNotOnMap && g_validateStrictIfZero == 0) continue;
+		if (find->houseID != HOUSE_INVALID       && find->houseID != Unit_GetHouseID(u)) continue;
+		if (find->type    != UNIT_INDEX_INVALID  && find->type    != u->o.type)  continue;
+
+		return u;
+	}
+
+	return NULL;
+}
+
+/**
+ * Get the key a Unit is sorted on in the draw order.
+ *
+ * @param u The Unit.
+ * @return The key; lower is drawn first.
+ */
+static int16 Unit_GetDrawKey(const Unit *u)
+{
+	uint16 y = Tile_GetY(u->o.position);
+
+	if (g_table_unitInfo[u->o.type].movementType == MOVEMENT_FOOT) y -= 0x100;
+	return (int16)y;
+}
+
+/**
+ * Put a Unit in a slot of the draw order.
+ *
+ * @param slot The slot.
+ * @param u The Unit.
+ */
+static void Unit_SetDrawSlot(uint16 slot, Unit *u)
+{
+	g_unitDrawArray[slot] = u;
+	g_unitDrawSlot[u->o.index] = (uint8)slot;
+}
+
+/**
+ * Move a Unit whose key changed to its place in the draw order. The rest of
+ *  the order is sorted, so this takes as many steps as the Unit moves places.
+ *
+ * @param slot The slot the Unit is in now.
+ */
+static void Unit_RepairDrawOrder(uint16 slot)
+{
+	Unit *u = g_unitDrawArray[slot];
+	int16 key = g_unitDrawKey[u->o.index];
+
+	while (slot > 0 && g_unitDrawKey[g_unitDrawArray[slot - 1]->o.index] > key) {
+		Unit_SetDrawSlot(slot, g_unitDrawArray[slot - 1]);
+		slot--;
+	}
+	while (slot + 1 < g_unitDrawCount && g_unitDrawKey[g_unitDrawArray[slot + 1]->o.index] < key) {
+		Unit_SetDrawSlot(slot, g_unitDrawArray[slot + 1]);
+		slot++;
+	}
+
+	Unit_SetDrawSlot(slot, u);
+}
+
+/**
+ * Update the place of a Unit in the draw order, after its position changed.
+ *
+ * @param u The Unit.
+ */
+void Unit_UpdateDrawOrder(Unit *u)
+{
+	int16 key = Unit_GetDrawKey(u);
+
+	if (g_unitDrawKey[u->o.index] == key) return;
+
+	g_unitDrawKey[u->o.index] = key;
+	Unit_RepairDrawOrder(g_unitDrawSlot[u->o.index]);
+}
+
+/**
+ * Add a Unit to the draw order.
+ *
+ * @param u The Unit.
+ */
+static void Unit_AddToDrawOrder(Unit *u)
+{
+	g_unitDrawKey[u->o.index] = Unit_GetDrawKey(u);
+	Unit_SetDrawSlot(g_unitDrawCount++, u);
+	Unit_RepairDrawOrder(g_unitDrawCount - 1);
+}
+
 /**
  * Initialize the Unit array.
  */
@@ -65,11 +172,13 @@ void Unit_Init(void)
 	memset(g_unitArray, 0, sizeof(g_unitArray));
 	memset(g_unitFindArray, 0, sizeof(g_unitFindArray));
 	g_unitFindCount = 0;
+	memset(g_unitDrawArray, 0, sizeof(g_unitDrawArray));
+	g_unitDrawCount = 0;
 }
 
 /**
- * Recount all Units, ignoring the cache array. Also set the unitCount
- *  of all houses to zero.
+ * Recount all Units, ignoring the cache array, and sort them in the draw
+ *  order again. Also set the unitCount of all houses to zero.
  */
 void Unit_Recount(void)
 {
@@ -83,6 +192,7 @@ void Unit_Recount(void)
 	}
 
 	g_unitFindCount = 0;
+	g_unitDrawCount = 0;
 
 	for (index = 0; index < UNIT_INDEX_MAX; index++) {
 		Unit *u = Unit_Get_ByIndex(index);
@@ -92,6 +202,7 @@ void Unit_Recount(void)
 		h->unitCount++;
 
 		g_unitFindArray[g_unitFindCount++] = u;
+		Unit_AddToDrawOrder(u);
 	}
 }
 
@@ -148,6 +259,7 @@ Unit *Unit_Allocate(uint16 index, uint8 type, uint8 houseID)
 	if (type == UNIT_SANDWORM) u->amount = 3;
 
 	g_unitFindArray[g_unitFindCount++] = u;
+	Unit_AddToDrawOrder(u);
 
 	return u;
 }
@@ -165,6 +277,12 @@ void Unit_Free(Unit *u)
 
 	Script_Reset(&u->o.script, g_scriptUnit);
 
+	/* Take it out of the draw order; the rest stays sorted */
+	g_unitDrawCount--;
+	for (i = g_unitDrawSlot[u->o.index]; i < g_unitDrawCount; i++) {
+		Unit_SetDrawSlot(i, g_unitDrawArray[i + 1]);
+	}
+
 	/* Walk the array to find the Unit we are removing */
 	for (i = 0; i < g_unitFindCount; i++) {
 		if (g_unitFindArray[i] == u) break;
@@ -11,11 +11,10 @@ enum {
 
 struct PoolFindStruct;
 
-extern struct Unit *g_unitFindArray[UNIT_INDEX_MAX];
-extern uint16 g_unitFindCount;
-
 extern struct Unit *Unit_Get_ByIndex(uint16 index);
 extern struct Unit *Unit_Find(struct PoolFindStruct *find);
+extern struct Unit *Unit_FindInDrawOrder(struct PoolFindStruct *find);
+extern void Unit_UpdateDrawOrder(struct Unit *u);
 
 extern void Unit_Init(void);
 extern void Unit_Recount(void);
@@ -0,0 +1,453 @@
+/** @file src/profile.c Profiling routines. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32)
+	#include <malloc.h>
+	#include <windows.h>
+#elif defined(TOS)
+	#include <mint/sysbind.h>
+	#include <mint/osbind.h>
+	#include <mint/ostruct.h>
+	#include <mint/sysvars.h>
+#else
+	#include <sys/time.h>
+	#if defined(__APPLE__)
+		#include <malloc/malloc.h>
+	#else
+		#include <malloc.h>
+	#endif /* __APPLE__ */
+#endif /* _WIN32 */
+#include "types.h"
+#include "os/error.h"
+
+#include "profile.h"
+
+#include "file.h"
+
+#if defined(_WIN32) || defined(__APPLE__)
+	/* The amount of blocks on the heap is only known on these platforms */
+	#define PROFILE_HEAP_BLOCKS
+#endif /* _WIN32 || __APPLE__ */
+
+#define PROFILE_EVENT_MAX 256                               /*!< Maximum amount of events in a trace. */
+#define PROFILE_DEPTH_MAX 16                                /*!< Maximum nesting of events. */
+#define PROFILE_HISTORY 128                                 /*!< Amount of runs the statistics of a section are taken over. */
+#define PROFILE_TRACE_MAX 131072                            /*!< Maximum amount of events in a frame trace, per thread. */
+
+/**
+ * A timed phase of the program.
+ */
+typedef struct ProfileEvent {
+	char   name[32];                                        /*!< Name of the phase. */
+	uint32 start;                                           /*!< Start of the phase in microseconds. */
+	uint32 duration;                                        /*!< Duration of the phase in microseconds. */
+	uint32 heapBlocks;                                      /*!< Blocks in use on the heap at the start, growth during the phase at the end. */
+	uint32 heapBytes;                                       /*!< Bytes in use on the heap at the start, growth during the phase at the end. */
+} ProfileEvent;
+
+/**
+ * Timing of a section over the last runs.
+ */
+typedef struct ProfileSectionInfo {
+	const char *name;                                       /*!< Name of the section in a frame trace. */
+	bool   video;                                           /*!< Whether the section is timed by the video driver, which might run from the timer. */
+	uint32 start;                                           /*!< Start of the current run in microseconds. */
+	uint32 history[PROFILE_HISTORY];                        /*!< Duration of the last runs in microseconds. */
+	uint16 historyCount;                                    /*!< Amount of valid entries in history. */
+	uint16 historyIndex;                                    /*!< Entry in history to write the next run to. */
+} ProfileSectionInfo;
+
+/**
+ * A single run of a section in a frame trace.
+ */
+typedef struct ProfileTraceEvent {
+	uint32 start;                                           /*!< Start of the run in microseconds. */
+	uint32 duration;                                        /*!< Duration of the run in microseconds. */
+	uint8  section;                                         /*!< The ProfileSection that ran. */
+} ProfileTraceEvent;
+
+static ProfileEvent s_profileEvents[PROFILE_EVENT_MAX];
+static uint16 s_profileEventCount = 0;
+static uint16 s_profileStack[PROFILE_DEPTH_MAX];
+static uint16 s_profileDepth = 0;
+static uint32 s_profileStartTime = 0;
+static bool s_profileEnabled = true;                        /*!< Events are recorded from the start of the program, until either saved or stopped. */
+
+static ProfileSectionInfo s_profileSections[PROFILE_SECTION_MAX] = {
+	{ "GameLoop_Team",            false, 0, {0}, 0, 0 },
+	{ "GameLoop_Unit",            false, 0, {0}, 0, 0 },
+	{ "GameLoop_Structure",       false, 0, {0}, 0, 0 },
+	{ "GameLoop_House",           false, 0, {0}, 0, 0 },
+	{ "GUI_DrawScreen",           false, 0, {0}, 0, 0 },
+	{ "GUI_Widget_Viewport_Draw", false, 0, {0}, 0, 0 },
+	{ "Video_DrawScreen",         true,  0, {0}, 0, 0 },
+	{ "Frame",                    true,  0, {0}, 0, 0 }
+};
+
+/* The game loop and the video driver each write to their own trace, as the
+ *  video driver can interrupt the game loop at any moment. */
+static ProfileTraceEvent *s_profileTraceEvents[2] = { NULL, NULL };
+static uint32 s_profileTraceCount[2] = { 0, 0 };
+static uint32 s_profileTraceStartTime = 0;
+static uint32 s_profileFrameTime = 0;
+static bool s_profileTraceEnabled = false;
+static char s_profileTraceFilename[64];
+
+/**
+ * Get the time with a microsecond resolution (where the platform allows).
+ *  Only differences between two calls are meaningful.
+ *
+ * @return The time in microseconds.
+ */
+uint32 Profile_GetTime(void)
+{
+#if defined(_WIN32)
+	static LARGE_INTEGER l_frequency;
+	LARGE_INTEGER counter;
+
+	if (l_frequency.QuadPart == 0) QueryPerformanceFrequency(&l_frequency);
+	QueryPerformanceCounter(&counter);
+	return (uint32)(counter.QuadPart / l_frequency.QuadPart * 1000000 + counter.QuadPart % l_frequency.QuadPart * 1000000 / l_frequency.QuadPart);
+#elif defined(TOS)
+	/* use the 200 HZ system timer which has a 5ms granularity */
+	return get_sysvar(_hz_200) * 5000;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000 + tv.tv_usec;
+#endif /* _WIN32 */
+}
+
+/**
+ * Get the memory in use on the heap.
+ *
+ * @param blocks Where to store the amount of blocks in use.
+ * @param bytes Where to store the amount of bytes in use.
+ */
+static void Profile_GetHeap(uint32 *blocks, uint32 *bytes)
+{
+#if defined(_WIN32)
+	_HEAPINFO info;
+
+	*blocks = 0;
+	*bytes  = 0;
+
+	info._pentry = NULL;
+	while (_heapwalk(&info) == _HEAPOK) {
+		if (info._useflag != _USEDENTRY) continue;
+		(*blocks)++;
+		*bytes += (uint32)info._size;
+	}
+#elif defined(__APPLE__)
+	malloc_statistics_t stats;
+
+	malloc_zone_statistics(NULL, &stats);
+	*blocks = (uint32)stats.blocks_in_use;
+	*bytes  = (uint32)stats.size_in_use;
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	struct mallinfo2 info = mallinfo2();
+
+	*blocks = 0;
+	*bytes  = (uint32)(info.uordblks + info.hblkhd);
+#elif defined(__GLIBC__)
+	struct mallinfo info = mallinfo();
+
+	*blocks = 0;
+	*bytes  = (uint32)(info.uordblks + info.hblkhd);
+#else
+	*blocks = 0;
+	*bytes  = 0;
+#endif /* _WIN32 */
+}
+
+/**
+ * Start a new phase. Phases can be nested; every phase has to be ended with
+ *  Profile_End().
+ *
+ * @param name The name of the phase.
+ */
+void Profile_Begin(const char *name)
+{
+	ProfileEvent *e;
+
+	if (!s_profileEnabled) return;
+
+	/* When out of space, keep the nesting intact but do not record the phase */
+	if (s_profileDepth >= PROFILE_DEPTH_MAX) {
+		s_profileDepth++;
+		return;
+	}
+	if (s_profileEventCount >= PROFILE_EVENT_MAX) {
+		s_profileStack[s_profileDepth++] = 0xFFFF;
+		return;
+	}
+
+	if (s_profileEventCount == 0) s_profileStartTime = Profile_GetTime();
+
+	e = &s_profileEvents[s_profileEventCount];
+	strncpy(e->name, name, sizeof(e->name) - 1);
+	e->name[sizeof(e->name) - 1] = '\0';
+
+	s_profileStack[s_profileDepth++] = s_profileEventCount++;
+
+	Profile_GetHeap(&e->heapBlocks, &e->heapBytes);
+	e->start = Profile_GetTime() - s_profileStartTime;
+}
+
+/**
+ * End the phase last started with Profile_Begin().
+ */
+void Profile_End(void)
+{
+	ProfileEvent *e;
+	uint32 blocks;
+	uint32 bytes;
+	uint32 now;
+
+	if (!s_profileEnabled || s_profileDepth == 0) return;
+
+	now = Profile_GetTime() - s_profileStartTime;
+
+	if (--s_profileDepth >= PROFILE_DEPTH_MAX) return;
+	if (s_profileStack[s_profileDepth] == 0xFFFF) return;
+
+	e = &s_profileEvents[s_profileStack[s_profileDepth]];
+	e->duration = now - e->start;
+
+	Profile_GetHeap(&blocks, &bytes);
+	e->heapBlocks = blocks - e->heapBlocks;
+	e->heapBytes  = bytes - e->heapBytes;
+}
+
+/**
+ * Stop recording; all recorded events are dropped.
+ */
+void Profile_Stop(void)
+{
+	s_profileEnabled = false;
+	s_profileEventCount = 0;
+	s_profileDepth = 0;
+}
+
+/**
+ * Write a string as JSON string, escaping where needed.
+ */
+static void Profile_WriteJSONString(FILE *fp, const char *str)
+{
+	fputc('"', fp);
+	for (; *str != '\0'; str++) {
+		if (*str == '"' || *str == '\\') fputc('\\', fp);
+		fputc(*str, fp);
+	}
+	fputc('"', fp);
+}
+
+/**
+ * Save all recorded events as a Chrome trace (as can be loaded in
+ *  chrome://tracing or ui.perfetto.dev) in the personal data directory, and
+ *  stop recording. Phases which did not end yet are ended first.
+ *
+ * Next to the timing, every event tells how much the heap grew during the
+ *  phase; the amount of blocks is only known on Windows and Mac OS X.
+ *
+ * @param filename The name of the file to write to.
+ * @return True if and only if the trace was written.
+ */
+bool Profile_Save(const char *filename)
+{
+	FILE *fp;
+	uint16 i;
+
+	if (!s_profileEnabled) return false;
+
+	while (s_profileDepth != 0) Profile_End();
+
+	fp = fopendatadir(SEARCHDIR_PERSONAL_DATA_DIR, filename, "w");
+	if (fp == NULL) {
+		Warning("Failed to write profile to %s\n", filename);
+		Profile_Stop();
+		return false;
+	}
+
+	fprintf(fp, "{\"traceEvents\":[\n");
+	for (i = 0; i < s_profileEventCount; i++) {
+		const ProfileEvent *e = &s_profileEvents[i];
+
+		fprintf(fp, "{\"name\":");
+		Profile_WriteJSONString(fp, e->name);
+		fprintf(fp, ",\"cat\":\"opendune\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu,\"pid\":1,\"tid\":1,\"args\":{\"heap_bytes\":%ld",
+			(unsigned long)e->start, (unsigned long)e->duration, (long)(int32)e->heapBytes);
+#if defined(PROFILE_HEAP_BLOCKS)
+		fprintf(fp, ",\"heap_blocks\":%ld", (long)(int32)e->heapBlocks);
+#endif /* PROFILE_HEAP_BLOCKS */
+		fprintf(fp, "}}%s\n", (i + 1 < s_profileEventCount) ? "," : "");
+	}
+	fprintf(fp, "],\"displayTimeUnit\":\"ms\"}\n");
+	fclose(fp);
+
+	Profile_Stop();
+	return true;
+}
+
+/**
+ * Add a run to the history of a section, and to the frame trace if enabled.
+ */
+static void Profile_Section_Add(ProfileSection section, uint32 start, uint32 duration)
+{
+	ProfileSectionInfo *si = &s_profileSections[section];
+
+	si->history[si->historyIndex] = duration;
+	si->historyIndex = (si->historyIndex + 1) % PROFILE_HISTORY;
+	if (si->historyCount < PROFILE_HISTORY) si->historyCount++;
+
+	if (s_profileTraceEnabled) {
+		uint8 thread = si->video ? 1 : 0;
+		ProfileTraceEvent *e;
+
+		if (s_profileTraceCount[thread] >= PROFILE_TRACE_MAX) return;
+
+		e = &s_profileTraceEvents[thread][s_profileTraceCount[thread]++];
+		e->start    = start - s_profileTraceStartTime;
+		e->duration = duration;
+		e->section  = (uint8)section;
+	}
+}
+
+/**
+ * Start a run of a section of the frame.
+ *
+ * @param section The section that starts.
+ */
+void Profile_Section_Begin(ProfileSection section)
+{
+	s_profileSections[section].start = Profile_GetTime();
+}
+
+/**
+ * End the run of a section started with Profile_Section_Begin().
+ *
+ * @param section The section that ends.
+ */
+void Profile_Section_End(ProfileSection section)
+{
+	uint32 start = s_profileSections[section].start;
+
+	Profile_Section_Add(section, start, Profile_GetTime() - start);
+}
+
+/**
+ * Mark the start of a new frame shown by the video driver.
+ */
+void Profile_Frame(void)
+{
+	uint32 now = Profile_GetTime();
+
+	if (s_profileFrameTime != 0) Profile_Section_Add(PROFILE_SECTION_FRAME, s_profileFrameTime, now - s_profileFrameTime);
+	s_profileFrameTime = now;
+}
+
+/**
+ * Get the statistics of a section over its last runs.
+ *
+ * @param section The section to get the statistics of.
+ * @param stats Where to store the statistics.
+ * @return False if the section did not run yet.
+ */
+bool Profile_GetStats(ProfileSection section, ProfileStats *stats)
+{
+	const ProfileSectionInfo *si = &s_profileSections[section];
+	uint32 sorted[PROFILE_HISTORY];
+	uint32 total = 0;
+	uint16 count;
+	uint16 i;
+
+	/* The section can run while we are busy; take the amount only once */
+	count = si->historyCount;
+	if (count == 0) return false;
+
+	for (i = 0; i < count; i++) {
+		uint32 value = si->history[i];
+		uint16 j;
+
+		total += value;
+
+		for (j = i; j > 0 && sorted[j - 1] > value; j--) sorted[j] = sorted[j - 1];
+		sorted[j] = value;
+	}
+
+	stats->min = sorted[0];
+	stats->avg = total / count;
+	stats->p99 = sorted[(count * 99 + 99) / 100 - 1];
+	return true;
+}
+
+/**
+ * Start recording every run of every section, to be written as a Chrome
+ *  trace by Profile_Trace_Stop().
+ *
+ * @param filename The name of the file in the personal data directory to
+ *   write the trace to.
+ * @return False if out of memory.
+ */
+bool Profile_Trace_Start(const char *filename)
+{
+	if (s_profileTraceEnabled) return true;
+
+	s_profileTraceEvents[0] = (ProfileTraceEvent *)malloc(PROFILE_TRACE_MAX * sizeof(ProfileTraceEvent));
+	s_profileTraceEvents[1] = (ProfileTraceEvent *)malloc(PROFILE_TRACE_MAX * sizeof(ProfileTraceEvent));
+	if (s_profileTraceEvents[0] == NULL || s_profileTraceEvents[1] == NULL) {
+		free(s_profileTraceEvents[0]); s_profileTraceEvents[0] = NULL;
+		free(s_profileTraceEvents[1]); s_profileTraceEvents[1] = NULL;
+		return false;
+	}
+
+	strncpy(s_profileTraceFilename, filename, sizeof(s_profileTraceFilename) - 1);
+	s_profileTraceFilename[sizeof(s_profileTraceFilename) - 1] = '\0';
+
+	s_profileTraceCount[0] = 0;
+	s_profileTraceCount[1] = 0;
+	s_profileTraceStartTime = Profile_GetTime();
+	s_profileTraceEnabled = true;
+	return true;
+}
+
+/**
+ * Stop recording the frame trace started with Profile_Trace_Start(), and
+ *  write it to the personal data directory. Once the trace is full, later
+ *  runs are no longer recorded.
+ */
+void Profile_Trace_Stop(void)
+{
+	static const char *threadNames[2] = { "Game loop", "Video" };
+	FILE *fp;
+	uint8 thread;
+
+	if (!s_profileTraceEnabled) return;
+	s_profileTraceEnabled = false;
+
+	fp = fopendatadir(SEARCHDIR_PERSONAL_DATA_DIR, s_profileTraceFilename, "w");
+	if (fp == NULL) {
+		Warning("Failed to write frame trace to %s\n", s_profileTraceFilename);
+	} else {
+		fprintf(fp, "{\"traceEvents\":[\n");
+		for (thread = 0; thread < 2; thread++) {
+			uint32 i;
+
+			fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", (thread == 0) ? "" : ",\n", thread + 1, threadNames[thread]);
+
+			for (i = 0; i < s_profileTraceCount[thread]; i++) {
+				const ProfileTraceEvent *e = &s_profileTraceEvents[thread][i];
+
+				fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":%lu,\"dur\":%lu,\"pid\":1,\"tid\":%d}",
+					s_profileSections[e->section].name, (unsigned long)e->start, (unsigned long)e->duration, thread + 1);
+			}
+		}
+		fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+		fclose(fp);
+	}
+
+	free(s_profileTraceEvents[0]); s_profileTraceEvents[0] = NULL;
+	free(s_profileTraceEvents[1]); s_profileTraceEvents[1] = NULL;
+}
@@ -0,0 +1,45 @@
+/** @file src/profile.h Profiling definitions. */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/**
+ * Parts of a frame which are timed every frame.
+ */
+typedef enum ProfileSection {
+	PROFILE_SECTION_TEAM       = 0,                         /*!< GameLoop_Team(). */
+	PROFILE_SECTION_UNIT       = 1,                         /*!< GameLoop_Unit(). */
+	PROFILE_SECTION_STRUCTURE  = 2,                         /*!< GameLoop_Structure(). */
+	PROFILE_SECTION_HOUSE      = 3,                         /*!< GameLoop_House(). */
+	PROFILE_SECTION_DRAWSCREEN = 4,                         /*!< GUI_DrawScreen(). */
+	PROFILE_SECTION_VIEWPORT   = 5,                         /*!< GUI_Widget_Viewport_Draw(), part of GUI_DrawScreen(). */
+	PROFILE_SECTION_VIDEO      = 6,                         /*!< Scaling and showing the screen by the video driver. */
+	PROFILE_SECTION_FRAME      = 7,                         /*!< Time between two frames shown by the video driver. */
+
+	PROFILE_SECTION_MAX        = 8
+} ProfileSection;
+
+/**
+ * Statistics of a section over the last frames.
+ */
+typedef struct ProfileStats {
+	uint32 min;                                             /*!< Shortest time in microseconds. */
+	uint32 avg;                                             /*!< Average time in microseconds. */
+	uint32 p99;                                             /*!< 99th percentile of the time in microseconds. */
+} ProfileStats;
+
+extern uint32 Profile_GetTime(void);
+
+extern void Profile_Begin(const char *name);
+extern void Profile_End(void);
+extern void Profile_Stop(void);
+extern bool Profile_Save(const char *filename);
+
+extern void Profile_Section_Begin(ProfileSection section);
+extern void Profile_Section_End(ProfileSection section);
+extern void Profile_Frame(void);
+extern bool Profile_GetStats(ProfileSection section, ProfileStats *stats);
+extern bool Profile_Trace_Start(const char *filename);
+extern void Profile_Trace_Stop(void);
+
+#endif /* PROFILE_H */
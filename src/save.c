@@ -6,6 +6,7 @@
 
 #include "save.h"
 
+#include "gamecontext.h"
 #include "house.h"
 #include "map.h"
 #include "opendune.h"
@@ -114,6 +115,25 @@ static bool Save_Main(FILE *fp, char *description)
 	return true;
 }
 
+/**
+ * Save the game to an already opened file. The savegame has to start at the
+ *  beginning of the file.
+ *
+ * @param fp The file to save to.
+ * @param description The description of the savegame.
+ * @return True if and only if all bytes were written successful.
+ */
+bool SaveGame_SaveStream(FILE *fp, char *description)
+{
+	bool res;
+
+	g_validateStrictIfZero++;
+	res = Save_Main(fp, description);
+	g_validateStrictIfZero--;
+
+	return res;
+}
+
 /**
  * Save the game to a filename
  *
@@ -139,6 +159,7 @@ bool SaveGame_SaveFile(char *filename, char *description)
 			tile->Revealed = false;
 			tile->overlaySpriteID = g_veiledSpriteID;
 		}
+		memset(g_unveiledMap, 0, sizeof(g_unveiledMap));
 
 		find.houseID = HOUSE_INVALID;
 		find.type    = 0xFFFF;
@@ -176,9 +197,10 @@ bool SaveGame_SaveFile(char *filename, char *description)
 		return false;
 	}
 
-	g_validateStrictIfZero++;
-	res = Save_Main(fp, description);
-	g_validateStrictIfZero--;
+	/* Let the C library collect the many small writes into big blocks */
+	setvbuf(fp, NULL, _IOFBF, SAVEGAME_BUFFER_SIZE);
+
+	res = SaveGame_SaveStream(fp, description);
 
 	fclose(fp);
 
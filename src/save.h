@@ -4,5 +4,6 @@
 #define SAVE_H
 
 extern bool SaveGame_SaveFile(char *filename, char *description);
+extern bool SaveGame_SaveStream(FILE *fp, char *description);
 
 #endif /* SAVE_H */
@@ -0,0 +1,429 @@
+/** @file src/saveload/checksum.c Checksum and compare routines for the world state. */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "types.h"
+#include "../os/endian.h"
+#include "../os/error.h"
+#include "../os/strings.h"
+
+#include "../gamecontext.h"
+#include "saveload.h"
+#include "../house.h"
+#include "../map.h"
+#include "../opendune.h"
+#include "../pool/house.h"
+#include "../pool/pool.h"
+#include "../pool/structure.h"
+#include "../pool/unit.h"
+#include "../structure.h"
+#include "../tools.h"
+#include "../unit.h"
+
+/**
+ * The world state, as created by SaveLoad_GetState(), is a list of records.
+ *  Each starts with one of these tags. Objects follow with their index as
+ *  16bit value and their savegame form.
+ */
+enum {
+	STATE_HOUSE     = 'H',                                  /*!< A House. */
+	STATE_STRUCTURE = 'S',                                  /*!< A Structure. */
+	STATE_UNIT      = 'U',                                  /*!< A Unit. */
+	STATE_MAP       = 'M',                                  /*!< All Tiles, encoded like in a savegame. */
+	STATE_RANDOM    = 'R'                                   /*!< The state of the randomizers. */
+};
+
+static uint32 s_crcTable[256];
+static bool s_crcTableInit = false;
+
+/**
+ * Update a CRC32 (as used by zlib) with more data.
+ * @param crc The CRC so far, 0 to start.
+ * @param data The data to add.
+ * @param length The length of the data.
+ * @return The new CRC.
+ */
+uint32 SaveLoad_CRC32(uint32 crc, const uint8 *data, uint32 length)
+{
+	if (!s_crcTableInit) {
+		uint32 i;
+
+		for (i = 0; i < 256; i++) {
+			uint32 c = i;
+			uint8 k;
+
+			for (k = 0; k < 8; k++) c = ((c & 1) != 0) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+			s_crcTable[i] = c;
+		}
+		s_crcTableInit = true;
+	}
+
+	crc = ~crc;
+	while (length-- != 0) crc = s_crcTable[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+/**
+ * Add an object to the world state.
+ * @param buffer Pointer to the buffer to write to; it is advanced past the bytes written.
+ * @param tag The tag of the record.
+ * @param sld The SaveLoadDesc of the object.
+ * @param object The object.
+ * @param index The index of the object.
+ */
+static void SaveLoad_State_AddObject(uint8 **buffer, uint8 tag, const SaveLoadDesc *sld, void *object, uint16 index)
+{
+	(*buffer)[0] = tag;
+	WRITE_LE_UINT16(*buffer + 1, index);
+	*buffer += 3;
+
+	SaveLoad_SaveToBuffer(sld, buffer, object);
+}
+
+/**
+ * Get the world state: all Houses, Structures and Units in their savegame
+ *  form (so without pointers), the map and the state of the randomizers.
+ *  Two games which behave the same have the same world state, also when
+ *  run by different processes or different builds.
+ * @param length Where to store the length of the world state.
+ * @return The world state, to be freed by the caller, or NULL if out of memory.
+ */
+uint8 *SaveLoad_GetState(uint32 *length)
+{
+	PoolFindStruct find;
+	uint8 *state;
+	uint8 *b;
+	uint32 lcg;
+	uint16 i;
+
+	state = (uint8 *)malloc(
+		HOUSE_INDEX_MAX * (3 + SaveLoad_GetLength(g_saveHouse)) +
+		STRUCTURE_INDEX_MAX_HARD * (3 + SaveLoad_GetLength(g_saveStructure)) +
+		UNIT_INDEX_MAX * (3 + SaveLoad_GetLength(g_saveUnit)) +
+		1 + 0x1000 * SAVEGAME_TILE_SIZE + 1 + 8);
+	if (state == NULL) return NULL;
+	b = state;
+
+	g_validateStrictIfZero++;
+
+	find.houseID = HOUSE_INVALID;
+	find.type    = 0xFFFF;
+	find.index   = 0xFFFF;
+
+	while (true) {
+		House *h;
+
+		h = House_Find(&find);
+		if (h == NULL) break;
+
+		SaveLoad_State_AddObject(&b, STATE_HOUSE, g_saveHouse, h, h->index);
+	}
+
+	find.houseID = HOUSE_INVALID;
+	find.type    = 0xFFFF;
+	find.index   = 0xFFFF;
+
+	while (true) {
+		Structure *s;
+		Structure ss;
+
+		s = Structure_Find(&find);
+		if (s == NULL) break;
+		ss = *s;
+
+		SaveLoad_State_AddObject(&b, STATE_STRUCTURE, g_saveStructure, &ss, ss.o.index);
+	}
+
+	find.houseID = HOUSE_INVALID;
+	find.type    = 0xFFFF;
+	find.index   = 0xFFFF;
+
+	while (true) {
+		Unit *u;
+		Unit su;
+
+		u = Unit_Find(&find);
+		if (u == NULL) break;
+		su = *u;
+
+		SaveLoad_State_AddObject(&b, STATE_UNIT, g_saveUnit, &su, su.o.index);
+	}
+
+	g_validateStrictIfZero--;
+
+	*b++ = STATE_MAP;
+	for (i = 0; i < 0x1000; i++, b += SAVEGAME_TILE_SIZE) Map_EncodeTile(&g_map[i], b);
+
+	*b++ = STATE_RANDOM;
+	Tools_Random_GetState(b, &lcg);
+	WRITE_LE_UINT32(b + 4, lcg);
+	b += 8;
+
+	*length = (uint32)(b - state);
+	return state;
+}
+
+/**
+ * Calculate a checksum of the world state, as returned by SaveLoad_GetState().
+ * @return The checksum.
+ */
+uint32 SaveLoad_Checksum(void)
+{
+	uint8 *state;
+	uint32 length;
+	uint32 crc;
+
+	state = SaveLoad_GetState(&length);
+	if (state == NULL) return 0;
+
+	crc = SaveLoad_CRC32(0, state, length);
+	free(state);
+
+	return crc;
+}
+
+/**
+ * Get the length of a record in the world state.
+ * @param record The record.
+ * @return The length of the record, including its tag.
+ */
+static uint32 SaveLoad_State_GetRecordLength(const uint8 *record)
+{
+	switch (record[0]) {
+		case STATE_HOUSE:     return 3 + SaveLoad_GetLength(g_saveHouse);
+		case STATE_STRUCTURE: return 3 + SaveLoad_GetLength(g_saveStructure);
+		case STATE_UNIT:      return 3 + SaveLoad_GetLength(g_saveUnit);
+		case STATE_MAP:       return 1 + 0x1000 * SAVEGAME_TILE_SIZE;
+		case STATE_RANDOM:    return 1 + 8;
+		default:              return 0;
+	}
+}
+
+/**
+ * Find a record in the world state.
+ * @param state The world state.
+ * @param length The length of the world state.
+ * @param record The record to find one with the same tag (and index) of.
+ * @return The record, or NULL if not found.
+ */
+static const uint8 *SaveLoad_State_FindRecord(const uint8 *state, uint32 length, const uint8 *record)
+{
+	const uint8 *end = state + length;
+
+	while (state < end) {
+		uint32 size = SaveLoad_State_GetRecordLength(state);
+
+		if (size == 0 || state + size > end) return NULL;
+
+		if (state[0] == record[0]) {
+			if (record[0] == STATE_MAP || record[0] == STATE_RANDOM) return state;
+			if (READ_LE_UINT16(state + 1) == READ_LE_UINT16(record + 1)) return state;
+		}
+
+		state += size;
+	}
+
+	return NULL;
+}
+
+/**
+ * Read a single value of an object in its savegame form.
+ * @param type The type on disk.
+ * @param buffer Pointer to the buffer to read from; it is advanced past the bytes read.
+ * @return The value.
+ */
+static int32 SaveLoad_State_ReadValue(SaveLoadType type, const uint8 **buffer)
+{
+	int32 value;
+
+	switch (type) {
+		case SLDT_UINT8:  value = (*buffer)[0];                         *buffer += 1; break;
+		case SLDT_UINT16: value = READ_LE_UINT16(*buffer);              *buffer += 2; break;
+		case SLDT_UINT32: value = (int32)READ_LE_UINT32(*buffer);       *buffer += 4; break;
+		case SLDT_INT8:   value = (int8)(*buffer)[0];                   *buffer += 1; break;
+		case SLDT_INT16:  value = (int16)READ_LE_UINT16(*buffer);       *buffer += 2; break;
+		case SLDT_INT32:  value = (int32)READ_LE_UINT32(*buffer);       *buffer += 4; break;
+		default:          value = 0; break;
+	}
+
+	return value;
+}
+
+/**
+ * Print the members which differ between two objects in their savegame form.
+ * @param sld The SaveLoadDesc of the objects.
+ * @param expected Pointer to the expected object; it is advanced past the object.
+ * @param actual Pointer to the actual object; it is advanced past the object.
+ * @param object The name of the object, like "Unit 12".
+ * @param prefix The name of the members containing this object, like "o.".
+ */
+static void SaveLoad_State_CompareObject(const SaveLoadDesc *sld, const uint8 **expected, const uint8 **actual, const char *object, const char *prefix)
+{
+	for (; sld->type_disk != SLDT_NULL; sld++) {
+		uint16 i;
+
+		for (i = 0; i < sld->count; i++) {
+			char name[80];
+			int32 e;
+			int32 a;
+
+			if (sld->count == 1) {
+				snprintf(name, sizeof(name), "%s%s", prefix, sld->name == NULL ? "" : sld->name);
+			} else {
+				snprintf(name, sizeof(name), "%s%s[%u]", prefix, sld->name == NULL ? "" : sld->name, i);
+			}
+
+			if (sld->type_disk == SLDT_SLD) {
+				strncat(name, ".", sizeof(name) - strlen(name) - 1);
+				SaveLoad_State_CompareObject(sld->sld, expected, actual, object, name);
+				continue;
+			}
+
+			e = SaveLoad_State_ReadValue(sld->type_disk, expected);
+			a = SaveLoad_State_ReadValue(sld->type_disk, actual);
+
+			/* Padding is not interesting */
+			if (e == a || sld->name == NULL) continue;
+
+			Warning("  %s: %s is %d, expected %d\n", object, name, (int)a, (int)e);
+		}
+	}
+}
+
+/**
+ * Print the fields which differ between two tiles.
+ * @param packed The index of the tile.
+ * @param expected The expected tile, encoded like in a savegame.
+ * @param actual The actual tile, encoded like in a savegame.
+ */
+static void SaveLoad_State_CompareTile(uint16 packed, const uint8 *expected, const uint8 *actual)
+{
+	uint16 e;
+	uint16 a;
+
+	e = expected[0] | ((expected[1] & 1) << 8);
+	a = actual[0] | ((actual[1] & 1) << 8);
+	if (e != a) Warning("  Tile %u: groundSpriteID is %u, expected %u\n", packed, a, e);
+
+	e = expected[1] >> 1;
+	a = actual[1] >> 1;
+	if (e != a) Warning("  Tile %u: overlaySpriteID is %u, expected %u\n", packed, a, e);
+
+	e = expected[2];
+	a = actual[2];
+	if (e != a) Warning("  Tile %u: houseID / flags is 0x%02X, expected 0x%02X\n", packed, a, e);
+
+	e = expected[3];
+	a = actual[3];
+	if (e != a) Warning("  Tile %u: index is %u, expected %u\n", packed, a, e);
+}
+
+/**
+ * Get the name of a record of the world state, to tell the user which
+ *  object it is about.
+ * @param record The record.
+ * @param name Where to store the name.
+ * @param size The size of name.
+ * @return The name.
+ */
+static const char *SaveLoad_State_GetRecordName(const uint8 *record, char *name, size_t size)
+{
+	switch (record[0]) {
+		case STATE_HOUSE:     snprintf(name, size, "House %u", READ_LE_UINT16(record + 1)); break;
+		case STATE_STRUCTURE: snprintf(name, size, "Structure %u", READ_LE_UINT16(record + 1)); break;
+		case STATE_UNIT:      snprintf(name, size, "Unit %u", READ_LE_UINT16(record + 1)); break;
+		case STATE_MAP:       snprintf(name, size, "Tiles"); break;
+		case STATE_RANDOM:    snprintf(name, size, "Random"); break;
+		default:              snprintf(name, size, "Record '%c'", record[0]); break;
+	}
+
+	return name;
+}
+
+/**
+ * Compare two world states, as returned by SaveLoad_GetState(), and print
+ *  all members of the first House, Structure and Unit which differ, and all
+ *  fields of the first Tile which differ.
+ * @param expected The expected world state.
+ * @param expectedLength The length of the expected world state.
+ * @param actual The actual world state.
+ * @param actualLength The length of the actual world state.
+ * @return The amount of records which differ.
+ */
+uint32 SaveLoad_CompareState(const uint8 *expected, uint32 expectedLength, const uint8 *actual, uint32 actualLength)
+{
+	const uint8 *e = expected;
+	const uint8 *a;
+	bool reported[3];
+	char object[32];
+	uint32 differ = 0;
+
+	memset(reported, 0, sizeof(reported));
+
+	/* Everything expected but changed or missing */
+	while (e < expected + expectedLength) {
+		uint32 size = SaveLoad_State_GetRecordLength(e);
+		uint8 kind;
+
+		if (size == 0) break;
+
+		a = SaveLoad_State_FindRecord(actual, actualLength, e);
+		kind = (e[0] == STATE_HOUSE) ? 0 : (e[0] == STATE_STRUCTURE) ? 1 : 2;
+
+		if (a == NULL) {
+			Warning("  %s: missing\n", SaveLoad_State_GetRecordName(e, object, sizeof(object)));
+			differ++;
+		} else if (memcmp(a, e, size) != 0) {
+			differ++;
+
+			if (e[0] == STATE_MAP) {
+				uint16 i;
+
+				for (i = 0; i < 0x1000; i++) {
+					const uint8 *et = e + 1 + i * SAVEGAME_TILE_SIZE;
+					const uint8 *at = a + 1 + i * SAVEGAME_TILE_SIZE;
+
+					if (memcmp(et, at, SAVEGAME_TILE_SIZE) == 0) continue;
+
+					SaveLoad_State_CompareTile(i, et, at);
+					break;
+				}
+			} else if (e[0] == STATE_RANDOM) {
+				Warning("  Random: state is %02X%02X%02X%02X %08X, expected %02X%02X%02X%02X %08X\n",
+					a[1], a[2], a[3], a[4], (unsigned int)READ_LE_UINT32(a + 5),
+					e[1], e[2], e[3], e[4], (unsigned int)READ_LE_UINT32(e + 5));
+			} else if (!reported[kind]) {
+				const SaveLoadDesc *sld = (kind == 0) ? g_saveHouse : (kind == 1) ? g_saveStructure : g_saveUnit;
+				const uint8 *ea = e + 3;
+				const uint8 *aa = a + 3;
+
+				SaveLoad_State_GetRecordName(e, object, sizeof(object));
+				SaveLoad_State_CompareObject(sld, &ea, &aa, object, "");
+				reported[kind] = true;
+			}
+		}
+
+		e += size;
+	}
+
+	/* Everything not expected */
+	a = actual;
+	while (a < actual + actualLength) {
+		uint32 size = SaveLoad_State_GetRecordLength(a);
+
+		if (size == 0) break;
+
+		if (SaveLoad_State_FindRecord(expected, expectedLength, a) == NULL) {
+			Warning("  %s: unexpected\n", SaveLoad_State_GetRecordName(a, object, sizeof(object)));
+			differ++;
+		}
+
+		a += size;
+	}
+
+	if (differ != 0) Warning("  %u records differ\n", (unsigned int)differ);
+
+	return differ;
+}
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include "types.h"
 
+#include "../gamecontext.h"
 #include "saveload.h"
 #include "../house.h"
 #include "../map.h"
@@ -122,35 +123,35 @@ static uint32 SaveLoad_UnitHouseMissile(void *object, uint32 value, bool loading
 }
 
 static const SaveLoadDesc s_saveInfo[] = {
-	SLD_GSLD   (g_scenario,  g_saveScenario),
-	SLD_GENTRY (SLDT_UINT16, g_playerCreditsNoSilo),
+	SLD_SLD    (GameContext, scenario, g_saveScenario),
+	SLD_ENTRY  (GameContext, SLDT_UINT16, playerCreditsNoSilo),
 	SLD_GENTRY (SLDT_UINT16, g_minimapPosition),
 	SLD_GENTRY (SLDT_UINT16, g_selectionRectanglePosition),
 	SLD_GCALLB (SLDT_INT8,   g_selectionType, &SaveLoad_SelectionType),
-	SLD_GENTRY2(SLDT_INT8,   g_structureActiveType, SLDT_UINT16),
-	SLD_GENTRY (SLDT_UINT16, g_structureActivePosition),
-	SLD_GCALLB (SLDT_UINT16, g_structureActive, &SaveLoad_StructureActive),
-	SLD_GCALLB (SLDT_UINT16, g_unitSelected, &SaveLoad_UnitSelected),
-	SLD_GCALLB (SLDT_UINT16, g_unitActive, &SaveLoad_UnitActive),
+	SLD_ENTRY2 (GameContext, SLDT_INT8,   structureActiveType, SLDT_UINT16),
+	SLD_ENTRY  (GameContext, SLDT_UINT16, structureActivePosition),
+	SLD_CALLB  (GameContext, SLDT_UINT16, structureActive, &SaveLoad_StructureActive),
+	SLD_CALLB  (GameContext, SLDT_UINT16, unitSelected, &SaveLoad_UnitSelected),
+	SLD_CALLB  (GameContext, SLDT_UINT16, unitActive, &SaveLoad_UnitActive),
 	SLD_GENTRY (SLDT_UINT16, g_activeAction),
 	SLD_GENTRY (SLDT_UINT32, g_strategicRegionBits),
-	SLD_GENTRY (SLDT_UINT16, g_scenarioID),
-	SLD_GENTRY (SLDT_UINT16, g_campaignID),
+	SLD_ENTRY  (GameContext, SLDT_UINT16, scenarioID),
+	SLD_ENTRY  (GameContext, SLDT_UINT16, campaignID),
 	SLD_GENTRY (SLDT_UINT32, g_hintsShown1),
 	SLD_GENTRY (SLDT_UINT32, g_hintsShown2),
-	SLD_GCALLB (SLDT_UINT32, g_tickScenarioStart, &SaveLoad_TickScenarioStart),
-	SLD_GENTRY (SLDT_UINT16, g_playerCreditsNoSilo),
-	SLD_GARRAY (SLDT_INT16,  g_starportAvailable, UNIT_MAX),
-	SLD_GENTRY (SLDT_UINT16, g_houseMissileCountdown),
-	SLD_GCALLB (SLDT_UINT16, g_unitHouseMissile, &SaveLoad_UnitHouseMissile),
-	SLD_GENTRY (SLDT_UINT16, g_structureIndex),
+	SLD_CALLB  (GameContext, SLDT_UINT32, tickScenarioStart, &SaveLoad_TickScenarioStart),
+	SLD_ENTRY  (GameContext, SLDT_UINT16, playerCreditsNoSilo),
+	SLD_ARRAY  (GameContext, SLDT_INT16,  starportAvailable, UNIT_MAX),
+	SLD_ENTRY  (GameContext, SLDT_UINT16, houseMissileCountdown),
+	SLD_CALLB  (GameContext, SLDT_UINT16, unitHouseMissile, &SaveLoad_UnitHouseMissile),
+	SLD_ENTRY  (GameContext, SLDT_UINT16, structureIndex),
 	SLD_END
 };
 
 static const SaveLoadDesc s_saveInfoOld[] = {
 	SLD_EMPTY2(SLDT_UINT8,  250),
-	SLD_GENTRY(SLDT_UINT16, g_scenarioID),
-	SLD_GENTRY(SLDT_UINT16, g_campaignID),
+	SLD_ENTRY (GameContext, SLDT_UINT16, scenarioID),
+	SLD_ENTRY (GameContext, SLDT_UINT16, campaignID),
 	SLD_END
 };
 
@@ -163,7 +164,7 @@ static const SaveLoadDesc s_saveInfoOld[] = {
 bool Info_Load(FILE *fp, uint32 length)
 {
 	if (SaveLoad_GetLength(s_saveInfo) != length) return false;
-	if (!SaveLoad_Load(s_saveInfo, fp, NULL)) return false;
+	if (!SaveLoad_Load(s_saveInfo, fp, g_gameContext)) return false;
 
 	g_viewportPosition = g_minimapPosition;
 	g_selectionPosition = g_selectionRectanglePosition;
@@ -185,7 +186,7 @@ bool Info_LoadOld(FILE *fp, uint32 length)
 {
 	VARIABLE_NOT_USED(length);
 
-	if (!SaveLoad_Load(s_saveInfoOld, fp, NULL)) return false;
+	if (!SaveLoad_Load(s_saveInfoOld, fp, g_gameContext)) return false;
 
 	return true;
 }
@@ -201,7 +202,7 @@ bool Info_Save(FILE *fp)
 
 	if (!fwrite_le_uint16(savegameVersion, fp)) return false;
 
-	if (!SaveLoad_Save(s_saveInfo, fp, NULL)) return false;
+	if (!SaveLoad_Save(s_saveInfo, fp, g_gameContext)) return false;
 
 	return true;
 }
@@ -1,23 +1,25 @@
 /** @file src/saveload/map.c Load/save routines for Map. */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "types.h"
+#include "../os/endian.h"
 
+#include "../gamecontext.h"
+#include "saveload.h"
 #include "../file.h"
 #include "../map.h"
 #include "../sprites.h"
 
 /**
- * Load a Tile structure to a file (Little endian)
+ * Decode a Tile structure from a buffer (Little endian)
  *
- * @param t The tile to read
- * @param fp The stream
- * @return True if the tile was loaded successfully
+ * @param t The tile to decode to
+ * @param buffer The 4 bytes of the tile
  */
-static bool fread_tile(Tile *t, FILE *fp)
+static void Map_DecodeTile(Tile *t, const uint8 *buffer)
 {
-	uint8 buffer[4];
-	if (fread(buffer, 1, 4, fp) != 4) return false;
 	t->groundSpriteID = buffer[0] | ((buffer[1] & 1) << 8);
 	t->overlaySpriteID = buffer[1] >> 1;
 	t->houseID = buffer[2] & 0x07;
@@ -27,35 +29,32 @@ static bool fread_tile(Tile *t, FILE *fp)
 	t->hasAnimation = (buffer[2] & 0x40) ? true : false;
 	t->hasExplosion = (buffer[2] & 0x80) ? true : false;
 	t->index = buffer[3];
-	return true;
 }
 
 /**
- * Save a Tile structure to a file (Little endian)
+ * Encode a Tile structure to a buffer (Little endian)
  *
- * @param t The tile to save
- * @param fp The stream
- * @return True if the tile was saved successfully
+ * @param t The tile to encode
+ * @param buffer The 4 bytes to store the tile in
  */
-static bool fwrite_tile(const Tile *t, FILE *fp)
+void Map_EncodeTile(const Tile *t, uint8 *buffer)
 {
-	uint8 buffer[4];
 	buffer[0] = t->groundSpriteID & 0xff;
 	buffer[1] = (t->groundSpriteID >> 8) | (t->overlaySpriteID << 1);
 	buffer[2] = t->houseID | (t->Revealed << 3) | (t->hasUnit << 4) | (t->hasStructure << 5) | (t->hasAnimation << 6) | (t->hasExplosion << 7);
 	buffer[3] = t->index;
-	if (fwrite(buffer, 1, 4, fp) != 4) return false;
-	return true;
 }
 
 /**
- * Load all Tiles from a file.
+ * Load all Tiles from a file. The whole chunk is read in one go.
  * @param fp The file to load from.
  * @param length The length of the data chunk.
  * @return True if and only if all bytes were read successful.
  */
 bool Map_Load(FILE *fp, uint32 length)
 {
+	uint8 *data;
+	const uint8 *buffer;
 	uint16 i;
 
 	for (i = 0; i < 0x1000; i++) {
@@ -64,36 +63,60 @@ bool Map_Load(FILE *fp, uint32 length)
 		t->Revealed = false;
 		t->overlaySpriteID = g_veiledSpriteID;
 	}
+	memset(g_unveiledMap, 0, sizeof(g_unveiledMap));
+
+	if (length == 0) return true;
+
+	data = (uint8 *)malloc(length);
+	if (data == NULL) return false;
+
+	if (fread(data, length, 1, fp) != 1) {
+		free(data);
+		return false;
+	}
 
-	while (length >= sizeof(uint16) + sizeof(Tile)) {
+	buffer = data;
+	while (length >= sizeof(uint16) + SAVEGAME_TILE_SIZE) {
 		Tile *t;
 
-		length -= sizeof(uint16) + sizeof(Tile);
+		length -= sizeof(uint16) + SAVEGAME_TILE_SIZE;
 
-		if (!fread_le_uint16(&i, fp)) return false;
-		if (i >= 0x1000) return false;
+		i = READ_LE_UINT16(buffer);
+		buffer += sizeof(uint16);
+		if (i >= 0x1000) break;
 
 		t = &g_map[i];
-		if (!fread_tile(t, fp)) return false;
+		Map_DecodeTile(t, buffer);
+		buffer += SAVEGAME_TILE_SIZE;
 
 		if (g_mapSpriteID[i] != t->groundSpriteID) {
 			g_mapSpriteID[i] |= 0x8000;
 		}
 	}
-	if (length != 0) return false;
+
+	free(data);
+
+	if (i >= 0x1000 || length != 0) return false;
 
 	return true;
 }
 
 /**
- * Save all Tiles to a file.
+ * Save all Tiles to a file. The chunk is built in memory and written in one go.
  * @param fp The file to save to.
  * @return True if and only if all bytes were written successful.
  */
 bool Map_Save(FILE *fp)
 {
+	uint8 *data;
+	uint8 *buffer;
 	uint16 i;
+	bool res;
+
+	data = (uint8 *)malloc(0x1000 * (sizeof(uint16) + SAVEGAME_TILE_SIZE));
+	if (data == NULL) return false;
 
+	buffer = data;
 	for (i = 0; i < 0x1000; i++) {
 		Tile *tile = &g_map[i];
 
@@ -101,9 +124,15 @@ bool Map_Save(FILE *fp)
 		if (!tile->Revealed && !tile->hasStructure && !tile->hasUnit && !tile->hasAnimation && !tile->hasExplosion && (g_mapSpriteID[i] & 0x8000) == 0 && g_mapSpriteID[i] == tile->groundSpriteID) continue;
 
 		/* Store the index, then the tile itself */
-		if (!fwrite_le_uint16(i, fp)) return false;
-		if (!fwrite_tile(tile, fp)) return false;
+		WRITE_LE_UINT16(buffer, i);
+		buffer += sizeof(uint16);
+		Map_EncodeTile(tile, buffer);
+		buffer += SAVEGAME_TILE_SIZE;
 	}
 
-	return true;
+	res = (buffer == data || fwrite(data, buffer - data, 1, fp) == 1);
+
+	free(data);
+
+	return res;
 }
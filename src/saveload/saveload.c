@@ -1,7 +1,9 @@
 /** @file src/saveload/saveload.c General routines for load/save. */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include "types.h"
+#include "../os/endian.h"
 
 #include "saveload.h"
 #include "../house.h"
@@ -10,6 +12,8 @@
 #include "../file.h"
 #include "../os/error.h"
 
+/** Size of the buffer on the stack used to (de)serialize a single struct; bigger structs use the heap. */
+#define SAVELOAD_BUFFER_SIZE 512
 
 /**
  * Get the length of the struct how it would be on disk.
@@ -40,13 +44,14 @@ uint32 SaveLoad_GetLength(const SaveLoadDesc *sld)
 }
 
 /**
- * Load from a file into a struct.
+ * Load from a buffer into a struct.
  * @param sld The description of the struct.
- * @param fp The file to read from.
+ * @param buffer Pointer to the buffer to read from; it is advanced past the
+ *  bytes read. It should hold at least SaveLoad_GetLength() bytes.
  * @param object The object instance to read to.
  * @return True if and only if the reading was successful.
  */
-bool SaveLoad_Load(const SaveLoadDesc *sld, FILE *fp, void *object)
+bool SaveLoad_LoadFromBuffer(const SaveLoadDesc *sld, const uint8 **buffer, void *object)
 {
 	while (sld->type_disk != SLDT_NULL) {
 		uint32 value = 0;
@@ -62,54 +67,36 @@ bool SaveLoad_Load(const SaveLoadDesc *sld, FILE *fp, void *object)
 					value = 0;
 					break;
 
-				case SLDT_UINT8: {
-					uint8 v;
-
-					if (fread(&v, sizeof(uint8), 1, fp) != 1) return false;
-
-					value = v;
-				} break;
-
-				case SLDT_UINT16: {
-					uint16 v;
-
-					if (!fread_le_uint16(&v, fp)) return false;
-
-					value = v;
-				} break;
-
-				case SLDT_UINT32: {
-					uint32 v;
-
-					if (!fread_le_uint32(&v, fp)) return false;
-
-					value = v;
-				} break;
-
-
-				case SLDT_INT8: {
-					int8 v;
-
-					if (fread(&v, sizeof(int8), 1, fp) != 1) return false;
-
-					value = v;
-				} break;
+				case SLDT_UINT8:
+					value = (*buffer)[0];
+					*buffer += sizeof(uint8);
+					break;
 
-				case SLDT_INT16: {
-					int16 v;
+				case SLDT_UINT16:
+					value = READ_LE_UINT16(*buffer);
+					*buffer += sizeof(uint16);
+					break;
 
-					if (!fread_le_int16(&v, fp)) return false;
+				case SLDT_UINT32:
+					value = READ_LE_UINT32(*buffer);
+					*buffer += sizeof(uint32);
+					break;
 
-					value = v;
-				} break;
 
-				case SLDT_INT32: {
-					int32 v;
+				case SLDT_INT8:
+					value = (int8)(*buffer)[0];
+					*buffer += sizeof(int8);
+					break;
 
-					if (!fread_le_int32(&v, fp)) return false;
+				case SLDT_INT16:
+					value = (int16)READ_LE_UINT16(*buffer);
+					*buffer += sizeof(int16);
+					break;
 
-					value = v;
-				} break;
+				case SLDT_INT32:
+					value = (int32)READ_LE_UINT32(*buffer);
+					*buffer += sizeof(int32);
+					break;
 
 				case SLDT_INVALID:
 				default:
@@ -189,7 +176,7 @@ bool SaveLoad_Load(const SaveLoadDesc *sld, FILE *fp, void *object)
 
 
 				case SLDT_SLD:
-					if (!SaveLoad_Load(sld->sld, fp, ptr)) return false;
+					if (!SaveLoad_LoadFromBuffer(sld->sld, buffer, ptr)) return false;
 					break;
 
 				case SLDT_CALLBACK:
@@ -209,13 +196,14 @@ bool SaveLoad_Load(const SaveLoadDesc *sld, FILE *fp, void *object)
 }
 
 /**
- * Save from a struct to a file.
+ * Save from a struct to a buffer.
  * @param sld The description of the struct.
- * @param fp The file to write to.
+ * @param buffer Pointer to the buffer to write to; it is advanced past the
+ *  bytes written. It should have room for SaveLoad_GetLength() bytes.
  * @param object The object instance to write from.
  * @return True if and only if the writing was successful.
  */
-bool SaveLoad_Save(const SaveLoadDesc *sld, FILE *fp, void *object)
+bool SaveLoad_SaveToBuffer(const SaveLoadDesc *sld, uint8 **buffer, void *object)
 {
 	while (sld->type_disk != SLDT_NULL) {
 		uint32 value = 0;
@@ -272,7 +260,7 @@ bool SaveLoad_Save(const SaveLoadDesc *sld, FILE *fp, void *object)
 
 
 				case SLDT_SLD:
-					if (!SaveLoad_Save(sld->sld, fp, ptr)) return false;
+					if (!SaveLoad_SaveToBuffer(sld->sld, buffer, ptr)) return false;
 					break;
 
 				case SLDT_CALLBACK:
@@ -291,52 +279,95 @@ bool SaveLoad_Save(const SaveLoadDesc *sld, FILE *fp, void *object)
 					break;
 
 
-				case SLDT_UINT8: {
-					uint8 v = (uint8)value;
+				case SLDT_UINT8:
+				case SLDT_INT8:
+					(*buffer)[0] = (uint8)value;
+					*buffer += sizeof(uint8);
+					break;
 
-					if (fwrite(&v, sizeof(uint8), 1, fp) != 1) return false;
-				} break;
+				case SLDT_UINT16:
+				case SLDT_INT16:
+					WRITE_LE_UINT16(*buffer, value);
+					*buffer += sizeof(uint16);
+					break;
 
-				case SLDT_UINT16: {
-					uint16 v = (uint16)value;
+				case SLDT_UINT32:
+				case SLDT_INT32:
+					WRITE_LE_UINT32(*buffer, value);
+					*buffer += sizeof(uint32);
+					break;
 
-					if (!fwrite_le_uint16(v, fp)) return false;
-				} break;
+				default:
+				case SLDT_INVALID:
+					Error("Error in Save/Load structure descriptions");
+					return false;
+			}
+		}
 
-				case SLDT_UINT32: {
-					uint32 v = (uint32)value;
+		sld++;
+	}
 
-					if (!fwrite_le_uint32(v, fp)) return false;
-				} break;
+	return true;
+}
 
+/**
+ * Load from a file into a struct. The whole struct is read from the file in
+ *  one go, and then decoded from memory.
+ * @param sld The description of the struct.
+ * @param fp The file to read from.
+ * @param object The object instance to read to.
+ * @return True if and only if the reading was successful.
+ */
+bool SaveLoad_Load(const SaveLoadDesc *sld, FILE *fp, void *object)
+{
+	uint8 local[SAVELOAD_BUFFER_SIZE];
+	uint8 *data;
+	const uint8 *buffer;
+	uint32 length;
+	bool res;
 
-				case SLDT_INT8: {
-					int8 v = (int8)value;
+	length = SaveLoad_GetLength(sld);
 
-					if (fwrite(&v, sizeof(int8), 1, fp) != 1) return false;
-				} break;
+	data = (length <= sizeof(local)) ? local : (uint8 *)malloc(length);
+	if (data == NULL) return false;
 
-				case SLDT_INT16: {
-					int16 v = (int16)value;
+	res = (length == 0 || fread(data, length, 1, fp) == 1);
 
-					if (!fwrite_le_int16(v, fp)) return false;
-				} break;
+	buffer = data;
+	if (res) res = SaveLoad_LoadFromBuffer(sld, &buffer, object);
 
-				case SLDT_INT32: {
-					int32 v = (int32)value;
+	if (data != local) free(data);
 
-					if (!fwrite_le_int32(v, fp)) return false;
-				} break;
+	return res;
+}
 
-				default:
-				case SLDT_INVALID:
-					Error("Error in Save/Load structure descriptions");
-					return false;
-			}
-		}
+/**
+ * Save from a struct to a file. The whole struct is encoded in memory first,
+ *  and then written to the file in one go.
+ * @param sld The description of the struct.
+ * @param fp The file to write to.
+ * @param object The object instance to write from.
+ * @return True if and only if the writing was successful.
+ */
+bool SaveLoad_Save(const SaveLoadDesc *sld, FILE *fp, void *object)
+{
+	uint8 local[SAVELOAD_BUFFER_SIZE];
+	uint8 *data;
+	uint8 *buffer;
+	uint32 length;
+	bool res;
 
-		sld++;
-	}
+	length = SaveLoad_GetLength(sld);
 
-	return true;
+	data = (length <= sizeof(local)) ? local : (uint8 *)malloc(length);
+	if (data == NULL) return false;
+
+	buffer = data;
+	res = SaveLoad_SaveToBuffer(sld, &buffer, object);
+
+	if (res && length != 0) res = (fwrite(data, length, 1, fp) == 1);
+
+	if (data != local) free(data);
+
+	return res;
 }
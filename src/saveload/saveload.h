@@ -26,6 +26,12 @@ typedef enum SaveLoadType {
 	SLDT_NULL                                               /*!< Not stored. */
 } SaveLoadType;
 
+/** Size of the stdio buffer used while reading or writing a savegame. */
+#define SAVEGAME_BUFFER_SIZE 0x8000
+
+/** Size of a Tile as stored in a savegame. */
+#define SAVEGAME_TILE_SIZE 4
+
 #define offset(c, m) (((size_t)&((c *)8)->m) - 8)
 #define item_size(c, m) sizeof(((c *)0)->m)
 
@@ -37,8 +43,8 @@ typedef enum SaveLoadType {
  * @param t The type on disk / in memory.
  * @param m The member of the class.
  */
-#define SLD_ENTRY(c, t, m) { offset(c, m), t, t, 1, NULL, item_size(c, m), NULL, NULL }
-#define SLD_GENTRY(t, m) { 0, t, t, 1, NULL, sizeof(m), NULL, &m }
+#define SLD_ENTRY(c, t, m) { offset(c, m), t, t, 1, NULL, item_size(c, m), NULL, NULL, #m }
+#define SLD_GENTRY(t, m) { 0, t, t, 1, NULL, sizeof(m), NULL, &m, #m }
 
 /**
  * A full entry.
@@ -47,8 +53,8 @@ typedef enum SaveLoadType {
  * @param m The member of the class.
  * @param t2 The type in memory.
  */
-#define SLD_ENTRY2(c, t, m, t2) { offset(c, m), t, t2, 1, NULL, item_size(c, m), NULL, NULL }
-#define SLD_GENTRY2(t, m, t2) { 0, t, t2, 1, NULL, sizeof(m), NULL, &m }
+#define SLD_ENTRY2(c, t, m, t2) { offset(c, m), t, t2, 1, NULL, item_size(c, m), NULL, NULL, #m }
+#define SLD_GENTRY2(t, m, t2) { 0, t, t2, 1, NULL, sizeof(m), NULL, &m, #m }
 
 /**
  * A normal array.
@@ -57,8 +63,8 @@ typedef enum SaveLoadType {
  * @param m The member of the class.
  * @param n The number of elements.
  */
-#define SLD_ARRAY(c, t, m, n) { offset(c, m), t, t, n, NULL, item_size(c, m) / n, NULL, NULL }
-#define SLD_GARRAY(t, m, n) { 0, t, t, n, NULL, sizeof(m) / n, NULL, &m }
+#define SLD_ARRAY(c, t, m, n) { offset(c, m), t, t, n, NULL, item_size(c, m) / n, NULL, NULL, #m }
+#define SLD_GARRAY(t, m, n) { 0, t, t, n, NULL, sizeof(m) / n, NULL, &m, #m }
 
 /**
  * A full array.
@@ -68,21 +74,21 @@ typedef enum SaveLoadType {
  * @param t2 The type in memory.
  * @param n The number of elements.
  */
-#define SLD_ARRAY2(c, t, m, t2, n) { offset(c, m), t, t2, n, NULL, item_size(c, m) / n, NULL, NULL }
-#define SLD_GARRAY2(t, m, t2, n) { 0, t, t2, n, NULL, sizeof(m) / n, NULL, &m }
+#define SLD_ARRAY2(c, t, m, t2, n) { offset(c, m), t, t2, n, NULL, item_size(c, m) / n, NULL, NULL, #m }
+#define SLD_GARRAY2(t, m, t2, n) { 0, t, t2, n, NULL, sizeof(m) / n, NULL, &m, #m }
 
 /**
  * An empty entry. Just to pad bytes on disk.
  * @param t The type on disk.
  */
-#define SLD_EMPTY(t) { 0, t, SLDT_NULL, 1, NULL, 0, NULL, NULL }
+#define SLD_EMPTY(t) { 0, t, SLDT_NULL, 1, NULL, 0, NULL, NULL, NULL }
 
 /**
  * An empty array. Just to pad bytes on disk.
  * @param t The type on disk.
  * @param n The number of elements.
  */
-#define SLD_EMPTY2(t, n) { 0, t, SLDT_NULL, n, NULL, 0, NULL, NULL }
+#define SLD_EMPTY2(t, n) { 0, t, SLDT_NULL, n, NULL, 0, NULL, NULL, NULL }
 
 /**
  * A struct entry.
@@ -90,8 +96,8 @@ typedef enum SaveLoadType {
  * @param m The member of the class.
  * @param s The SaveLoadDesc.
  */
-#define SLD_SLD(c, m, s) { offset(c, m), SLDT_SLD, SLDT_SLD, 1, s, item_size(c, m), NULL, NULL }
-#define SLD_GSLD(m, s) { 0, SLDT_SLD, SLDT_SLD, 1, s, sizeof(m), NULL, &m }
+#define SLD_SLD(c, m, s) { offset(c, m), SLDT_SLD, SLDT_SLD, 1, s, item_size(c, m), NULL, NULL, #m }
+#define SLD_GSLD(m, s) { 0, SLDT_SLD, SLDT_SLD, 1, s, sizeof(m), NULL, &m, #m }
 
 /**
  * A struct array.
@@ -100,8 +106,8 @@ typedef enum SaveLoadType {
  * @param s The SaveLoadDesc.
  * @param n The number of elements.
  */
-#define SLD_SLD2(c, m, s, n) { offset(c, m), SLDT_SLD, SLDT_SLD, n, s, item_size(c, m) / n, NULL, NULL }
-#define SLD_GSLD2(m, s, n) { 0, SLDT_SLD, SLDT_SLD, n, s, sizeof(m) / n, NULL, &m }
+#define SLD_SLD2(c, m, s, n) { offset(c, m), SLDT_SLD, SLDT_SLD, n, s, item_size(c, m) / n, NULL, NULL, #m }
+#define SLD_GSLD2(m, s, n) { 0, SLDT_SLD, SLDT_SLD, n, s, sizeof(m) / n, NULL, &m, #m }
 
 /**
  * A callback entry.
@@ -110,11 +116,11 @@ typedef enum SaveLoadType {
  * @param m The member of the class.
  * @param p The callback.
  */
-#define SLD_CALLB(c, t, m, p) { offset(c, m), t, SLDT_CALLBACK, 1, NULL, item_size(c, m), p, NULL }
-#define SLD_GCALLB(t, m, p) { 0, t, SLDT_CALLBACK, 1, NULL, sizeof(m), p, &m }
+#define SLD_CALLB(c, t, m, p) { offset(c, m), t, SLDT_CALLBACK, 1, NULL, item_size(c, m), p, NULL, #m }
+#define SLD_GCALLB(t, m, p) { 0, t, SLDT_CALLBACK, 1, NULL, sizeof(m), p, &m, #m }
 
 /** Indicates end of array. */
-#define SLD_END { 0, SLDT_NULL, SLDT_NULL, 0, NULL, 0, NULL, NULL }
+#define SLD_END { 0, SLDT_NULL, SLDT_NULL, 0, NULL, 0, NULL, NULL, NULL }
 
 /**
  * Table definition for SaveLoad descriptors.
@@ -128,16 +134,27 @@ typedef struct SaveLoadDesc {
 	size_t size;                                            /*!< The size of an element. */
 	uint32 (*callback)(void *object, uint32 value, bool loading);/*!< The custom callback. */
 	void *address;                                          /*!< The address of the element. */
+	const char *name;                                       /*!< The name of the member, or NULL for padding. */
 } SaveLoadDesc;
 
 extern const SaveLoadDesc g_saveObject[];
 extern const SaveLoadDesc g_saveScriptEngine[];
 extern const SaveLoadDesc g_saveScenario[];
+extern const SaveLoadDesc g_saveHouse[];
+extern const SaveLoadDesc g_saveStructure[];
+extern const SaveLoadDesc g_saveUnit[];
 
 extern uint32 SaveLoad_GetLength(const SaveLoadDesc *sld);
+extern bool SaveLoad_LoadFromBuffer(const SaveLoadDesc *sld, const uint8 **buffer, void *object);
+extern bool SaveLoad_SaveToBuffer(const SaveLoadDesc *sld, uint8 **buffer, void *object);
 extern bool SaveLoad_Load(const SaveLoadDesc *sld, FILE *fp, void *object);
 extern bool SaveLoad_Save(const SaveLoadDesc *sld, FILE *fp, void *object);
 
+extern uint32 SaveLoad_CRC32(uint32 crc, const uint8 *data, uint32 length);
+extern uint32 SaveLoad_Checksum(void);
+extern uint8 *SaveLoad_GetState(uint32 *length);
+extern uint32 SaveLoad_CompareState(const uint8 *expected, uint32 expectedLength, const uint8 *actual, uint32 actualLength);
+
 extern bool House_Load(FILE *fp, uint32 length);
 extern bool House_LoadOld(FILE *fp, uint32 length);
 extern bool House_Save(FILE *fp);
@@ -146,6 +163,8 @@ extern bool Info_Load(FILE *fp, uint32 length);
 extern bool Info_LoadOld(FILE *fp, uint32 length);
 extern bool Info_Save(FILE *fp);
 
+struct Tile;
+extern void Map_EncodeTile(const struct Tile *t, uint8 *buffer);
 extern bool Map_Save(FILE *fp);
 extern bool Map_Load(FILE *fp, uint32 length);
 
@@ -10,7 +10,7 @@
 #include "../pool/structure.h"
 #include "../pool/pool.h"
 
-static const SaveLoadDesc s_saveStructure[] = {
+const SaveLoadDesc g_saveStructure[] = {
 	SLD_SLD   (Structure,              o, g_saveObject),
 	SLD_ENTRY (Structure, SLDT_UINT16, creatorHouseID),
 	SLD_ENTRY (Structure, SLDT_UINT16, rotationSpriteDiff),
@@ -40,9 +40,9 @@ bool Structure_Load(FILE *fp, uint32 length)
 		memset(&sl, 0, sizeof(sl));
 
 		/* Read the next Structure from disk */
-		if (!SaveLoad_Load(s_saveStructure, fp, &sl)) return false;
+		if (!SaveLoad_Load(g_saveStructure, fp, &sl)) return false;
 
-		length -= SaveLoad_GetLength(s_saveStructure);
+		length -= SaveLoad_GetLength(g_saveStructure);
 
 		sl.o.script.scriptInfo = g_scriptStructure;
 		sl.o.script.script = g_scriptStructure->start + (size_t)sl.o.script.script;
@@ -83,7 +83,7 @@ bool Structure_Save(FILE *fp)
 		if (s == NULL) break;
 		ss = *s;
 
-		if (!SaveLoad_Save(s_saveStructure, fp, &ss)) return false;
+		if (!SaveLoad_Save(g_saveStructure, fp, &ss)) return false;
 	}
 
 	return true;
@@ -4,6 +4,7 @@
 #include <string.h>
 #include "types.h"
 
+#include "../gamecontext.h"
 #include "saveload.h"
 #include "../house.h"
 #include "../pool/unit.h"
@@ -17,7 +18,7 @@ static const SaveLoadDesc s_saveUnitOrientation[] = {
 	SLD_END
 };
 
-static const SaveLoadDesc s_saveUnit[] = {
+const SaveLoadDesc g_saveUnit[] = {
 	SLD_SLD   (Unit,              o, g_saveObject),
 	SLD_EMPTY (      SLDT_UINT16),
 	SLD_ENTRY (Unit, SLDT_UINT16, currentDestination.x),
@@ -78,9 +79,9 @@ bool Unit_Load(FILE *fp, uint32 length)
 		memset(&ul, 0, sizeof(ul));
 
 		/* Read the next Structure from disk */
-		if (!SaveLoad_Load(s_saveUnit, fp, &ul)) return false;
+		if (!SaveLoad_Load(g_saveUnit, fp, &ul)) return false;
 
-		length -= SaveLoad_GetLength(s_saveUnit);
+		length -= SaveLoad_GetLength(g_saveUnit);
 
 		ul.o.script.scriptInfo = g_scriptUnit;
 		ul.o.script.script = g_scriptUnit->start + (size_t)ul.o.script.script;
@@ -131,7 +132,7 @@ bool Unit_Save(FILE *fp)
 		if (u == NULL) break;
 		su = *u;
 
-		if (!SaveLoad_Save(s_saveUnit, fp, &su)) return false;
+		if (!SaveLoad_Save(g_saveUnit, fp, &su)) return false;
 	}
 
 	return true;
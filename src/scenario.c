@@ -9,6 +9,7 @@
 #include "scenario.h"
 
 #include "file.h"
+#include "gamecontext.h"
 #include "house.h"
 #include "ini.h"
 #include "map.h"
@@ -25,7 +26,6 @@
 #include "unit.h"
 #include "gui/gui.h"
 
-Scenario g_scenario;
 
 static void *s_scenarioBuffer = NULL;
 
@@ -179,6 +179,7 @@ static void Read_Scenario_INI_Unit(const char *key, char *settings)
 
 	u->o.hitpoints   = hitpoints * g_table_unitInfo[unitType].o.hitpoints / 256;
 	u->o.position    = position;
+	Unit_UpdateDrawOrder(u);
 	u->orientation[0].Current = orientation;
 	u->actionID     = actionType;
 	u->nextActionID = ACTION_INVALID;
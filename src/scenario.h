@@ -36,7 +36,6 @@ typedef struct Scenario {
 	Reinforcement reinforcement[16];                        /*!< Reinforcement information. */
 } Scenario;
 
-extern Scenario g_scenario;
 
 extern bool Read_Scenario_INI(uint16 scenarioID, uint8 houseID);
 
@@ -7,6 +7,7 @@
 #include "script.h"
 
 #include "../audio/sound.h"
+#include "../gamecontext.h"
 #include "../gui/gui.h"
 #include "../map.h"
 #include "../pool/pool.h"
@@ -13,13 +13,9 @@
 #include "script.h"
 
 #include "../file.h"
+#include "../gamecontext.h"
 #include "../object.h"
 
-struct Object *g_scriptCurrentObject;
-struct Structure *g_scriptCurrentStructure;
-struct Unit *g_scriptCurrentUnit;
-struct Team *g_scriptCurrentTeam;
-
 static ScriptInfo s_scriptStructure;
 static ScriptInfo s_scriptTeam;
 static ScriptInfo s_scriptUnit;
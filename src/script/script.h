@@ -98,11 +98,6 @@ typedef struct ScriptInfo {
 #define STACK_PEEK(position) Script_Stack_Peek(script, position)
 #endif
 
-extern struct Object *g_scriptCurrentObject;
-extern struct Structure *g_scriptCurrentStructure;
-extern struct Unit *g_scriptCurrentUnit;
-extern struct Team *g_scriptCurrentTeam;
-
 extern ScriptInfo *g_scriptStructure;
 extern ScriptInfo *g_scriptTeam;
 extern ScriptInfo *g_scriptUnit;
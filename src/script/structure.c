@@ -8,6 +8,7 @@
 #include "../audio/sound.h"
 #include "../config.h"
 #include "../explosion.h"
+#include "../gamecontext.h"
 #include "../gui/gui.h"
 #include "../house.h"
 #include "../map.h"
@@ -6,6 +6,7 @@
 
 #include "script.h"
 
+#include "../gamecontext.h"
 #include "../gui/gui.h"
 #include "../house.h"
 #include "../pool/team.h"
@@ -13,6 +13,7 @@
 #include "../audio/sound.h"
 #include "../config.h"
 #include "../explosion.h"
+#include "../gamecontext.h"
 #include "../gui/gui.h"
 #include "../house.h"
 #include "../map.h"
@@ -473,6 +474,7 @@ uint16 Script_Unit_MoveToTarget(ScriptEngine *script)
 
 		u->o.position.x += clamp((int16)(tile.x - u->o.position.x), -16, 16);
 		u->o.position.y += clamp((int16)(tile.y - u->o.position.y), -16, 16);
+		Unit_UpdateDrawOrder(u);
 
 		Unit_UpdateMap(2, u);
 
@@ -1792,9 +1794,13 @@ uint16 Script_Unit_IsValidDestination(ScriptEngine *script)
 			if (u->o.linkedID == 0xFF) return 1;
 			u2 = Unit_Get_ByIndex(u->o.linkedID);
 			u2->o.position = Tools_Index_GetTile(encoded);
-			if (!Unit_IsTileOccupied(u2)) return 0;
+			if (!Unit_IsTileOccupied(u2)) {
+				Unit_UpdateDrawOrder(u2);
+				return 0;
+			}
 			u2->o.position.x = 0xFFFF;
 			u2->o.position.y = 0xFFFF;
+			Unit_UpdateDrawOrder(u2);
 			return 1;
 
 		case IT_STRUCTURE: {
@@ -0,0 +1,243 @@
+/** @file src/snapshot.c In-memory snapshot routines. */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "types.h"
+#include "os/error.h"
+#include "os/math.h"
+
+#include "snapshot.h"
+
+#include "gamecontext.h"
+#include "gui/widget.h"
+#include "opendune.h"
+#include "saveload/saveload.h"
+
+#define SNAPSHOT_PAGE_SIZE 512                              /*!< Size of a single page in a snapshot. */
+/** Amount of pages holding a GameContext. */
+#define SNAPSHOT_PAGE_COUNT ((sizeof(GameContext) + SNAPSHOT_PAGE_SIZE - 1) / SNAPSHOT_PAGE_SIZE)
+
+/**
+ * A page of a snapshot. The content of the page directly follows this header.
+ */
+typedef struct SnapshotPage {
+	uint32 refCount;                                        /*!< Amount of snapshots sharing this page. */
+} SnapshotPage;
+
+struct Snapshot {
+	const GameContext *context;                             /*!< The context the snapshot was created of; pointers in it point into this context. */
+	uint16 pageCount;                                       /*!< Amount of pages in the snapshot. */
+	SnapshotPage **pages;                                   /*!< The pages, directly following the snapshot. */
+};
+
+#define SNAPSHOT_PAGE_DATA(page) ((uint8 *)((page) + 1))
+
+static uint32 s_snapshotCheckInterval = 0;                  /*!< Game ticks between two checks of Snapshot_Check(), or 0 to not check. */
+static uint32 s_snapshotCheckNext = 0;                      /*!< Game tick of the next check. */
+static Snapshot *s_snapshotCheck = NULL;                    /*!< Snapshot of the previous check, or NULL. */
+static uint8 *s_snapshotCheckState = NULL;                  /*!< World state at the previous check, or NULL. */
+static uint32 s_snapshotCheckLength = 0;                    /*!< Length of #s_snapshotCheckState. */
+static uint32 s_snapshotCheckTick = 0;                      /*!< Game tick of the previous check. */
+
+/**
+ * Create a snapshot of the current world state, which is the current
+ *  GameContext as a whole.
+ *
+ * Pointers inside the world state (like g_unitActive or the script engines)
+ *  are stored as-is; a snapshot is only valid within the running process,
+ *  and can only be restored in the GameContext it was created of.
+ *
+ * @param base The snapshot to share unchanged pages with, or NULL to copy
+ *   every page. Successive snapshots of a running game normally only differ
+ *   in a few pages.
+ * @return The snapshot, or NULL if out of memory.
+ */
+Snapshot *Snapshot_Create(const Snapshot *base)
+{
+	const uint8 *data = (const uint8 *)g_gameContext;
+	Snapshot *snapshot;
+	uint16 page;
+
+	snapshot = (Snapshot *)malloc(sizeof(Snapshot) + SNAPSHOT_PAGE_COUNT * sizeof(SnapshotPage *));
+	if (snapshot == NULL) return NULL;
+
+	snapshot->context   = g_gameContext;
+	snapshot->pageCount = SNAPSHOT_PAGE_COUNT;
+	snapshot->pages     = (SnapshotPage **)(snapshot + 1);
+
+	assert(base == NULL || base->context == snapshot->context);
+
+	for (page = 0; page < SNAPSHOT_PAGE_COUNT; page++) {
+		uint32 offset = page * SNAPSHOT_PAGE_SIZE;
+		uint32 length = min(sizeof(GameContext) - offset, SNAPSHOT_PAGE_SIZE);
+		SnapshotPage *p;
+
+		if (base != NULL && memcmp(SNAPSHOT_PAGE_DATA(base->pages[page]), data + offset, length) == 0) {
+			p = base->pages[page];
+			p->refCount++;
+			snapshot->pages[page] = p;
+			continue;
+		}
+
+		p = (SnapshotPage *)malloc(sizeof(SnapshotPage) + length);
+		if (p == NULL) {
+			snapshot->pageCount = page;
+			Snapshot_Free(snapshot);
+			return NULL;
+		}
+
+		p->refCount = 1;
+		memcpy(SNAPSHOT_PAGE_DATA(p), data + offset, length);
+		snapshot->pages[page] = p;
+	}
+
+	return snapshot;
+}
+
+/**
+ * Restore the world state from a snapshot. The snapshot remains valid, so
+ *  it can be restored as often as needed.
+ *
+ * @param snapshot The snapshot to restore.
+ */
+void Snapshot_Restore(const Snapshot *snapshot)
+{
+	uint8 *data = (uint8 *)g_gameContext;
+	uint16 page;
+
+	assert(snapshot->context == g_gameContext);
+
+	for (page = 0; page < snapshot->pageCount; page++) {
+		uint32 offset = page * SNAPSHOT_PAGE_SIZE;
+		uint32 length = min(sizeof(GameContext) - offset, SNAPSHOT_PAGE_SIZE);
+
+		memcpy(data + offset, SNAPSHOT_PAGE_DATA(snapshot->pages[page]), length);
+	}
+
+	/* Nothing on screen can be trusted anymore */
+	memset(g_dirtyMinimap, 0xFF, sizeof(g_dirtyMinimap));
+	GUI_Widget_Viewport_InvalidateMap();
+	g_viewport_forceRedraw = true;
+}
+
+/**
+ * Free a snapshot. Pages shared with other snapshots stay alive until the
+ *  last snapshot using them is freed.
+ *
+ * @param snapshot The snapshot to free.
+ */
+void Snapshot_Free(Snapshot *snapshot)
+{
+	uint16 i;
+
+	if (snapshot == NULL) return;
+
+	for (i = 0; i < snapshot->pageCount; i++) {
+		SnapshotPage *p = snapshot->pages[i];
+
+		if (--p->refCount == 0) free(p);
+	}
+
+	free(snapshot);
+}
+
+/**
+ * Compare the world state with a world state taken earlier, and report
+ *  when they differ.
+ * @param expected The expected world state, as from SaveLoad_GetState().
+ * @param expectedLength The length of the expected world state.
+ * @param tick The game tick the expected world state was taken at.
+ * @return True if and only if the world state is the same.
+ */
+static bool Snapshot_CompareState(const uint8 *expected, uint32 expectedLength, uint32 tick)
+{
+	uint8 *state;
+	uint32 length;
+	bool res;
+
+	state = SaveLoad_GetState(&length);
+	if (state == NULL) return true;
+
+	res = (length == expectedLength && memcmp(state, expected, length) == 0);
+	if (!res) {
+		Warning("Restoring the snapshot of game tick %u gave another world state:\n", (unsigned int)tick);
+		SaveLoad_CompareState(expected, expectedLength, state, length);
+	}
+
+	free(state);
+	return res;
+}
+
+/**
+ * Forget the snapshot Snapshot_Check() took last, and check again at the
+ *  next call. Call it when another GameContext is made current.
+ */
+void Snapshot_ResetCheck(void)
+{
+	Snapshot_Free(s_snapshotCheck);
+	free(s_snapshotCheckState);
+
+	s_snapshotCheck = NULL;
+	s_snapshotCheckState = NULL;
+	s_snapshotCheckNext = 0;
+}
+
+/**
+ * Set how often Snapshot_Check() checks the snapshots.
+ * @param interval The amount of game ticks between two checks, or 0 to not check.
+ */
+void Snapshot_SetCheck(uint32 interval)
+{
+	Snapshot_ResetCheck();
+
+	s_snapshotCheckInterval = interval;
+}
+
+/**
+ * Check that restoring a snapshot gives back the exact world state it was
+ *  taken from. Called once per game loop, at a moment the world state is
+ *  consistent; every interval set by Snapshot_SetCheck() it takes a new
+ *  snapshot based on the previous one, restores the previous one and
+ *  compares it with the world state taken together with it, and then
+ *  restores the new one and compares that too, before the game continues.
+ * @return False if and only if a restored world state differed.
+ */
+bool Snapshot_Check(void)
+{
+	Snapshot *snapshot;
+	uint8 *state;
+	uint32 length;
+	bool res = true;
+
+	if (s_snapshotCheckInterval == 0 || g_timerGame < s_snapshotCheckNext) return true;
+	s_snapshotCheckNext = g_timerGame + s_snapshotCheckInterval;
+
+	snapshot = Snapshot_Create(s_snapshotCheck);
+	state = SaveLoad_GetState(&length);
+	if (snapshot == NULL || state == NULL) {
+		Warning("Not enough memory to check snapshots\n");
+		Snapshot_Free(snapshot);
+		free(state);
+		return true;
+	}
+
+	if (s_snapshotCheck != NULL) {
+		Snapshot_Restore(s_snapshotCheck);
+		res = Snapshot_CompareState(s_snapshotCheckState, s_snapshotCheckLength, s_snapshotCheckTick);
+
+		Snapshot_Restore(snapshot);
+		res = Snapshot_CompareState(state, length, g_timerGame) && res;
+	}
+
+	Snapshot_Free(s_snapshotCheck);
+	free(s_snapshotCheckState);
+
+	s_snapshotCheck       = snapshot;
+	s_snapshotCheckState  = state;
+	s_snapshotCheckLength = length;
+	s_snapshotCheckTick   = g_timerGame;
+
+	return res;
+}
@@ -0,0 +1,21 @@
+/** @file src/snapshot.h In-memory snapshot definitions. */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/**
+ * A snapshot of the complete world state, kept in memory. The content is
+ *  stored in pages; pages that did not change compared to the snapshot it
+ *  was based on are shared between both snapshots.
+ */
+typedef struct Snapshot Snapshot;
+
+extern Snapshot *Snapshot_Create(const Snapshot *base);
+extern void Snapshot_Restore(const Snapshot *snapshot);
+extern void Snapshot_Free(Snapshot *snapshot);
+
+extern void Snapshot_SetCheck(uint32 interval);
+extern void Snapshot_ResetCheck(void);
+extern bool Snapshot_Check(void);
+
+#endif /* SNAPSHOT_H */
@@ -1,5 +1,6 @@
 /** @file src/sprites.c Sprite routines. */
 
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,18 +15,24 @@
 
 #include "codec/format80.h"
 #include "file.h"
+#include "gamecontext.h"
 #include "gfx.h"
 #include "house.h"
 #include "ini.h"
 #include "input/mouse.h"
 #include "gui/gui.h"
+#include "profile.h"
 #include "script/script.h"
 #include "string.h"
 #include "tile.h"
+#include "video/video.h"
 
 
 uint8 **g_sprites = NULL;
 static uint16 s_spritesCount = 0;
+static uint8 *s_spritesArena = NULL;                        /*!< Memory holding all sprites of g_sprites, back to back. */
+static uint8 *s_spritesFiles[32];                           /*!< The SHP files read by Sprites_Load(), until Sprites_Pack(). */
+static uint16 s_spritesFilesCount = 0;                      /*!< Amount of files in s_spritesFiles. */
 uint8 *g_spriteBuffer;
 uint8 *g_iconRTBL = NULL;
 uint8 *g_iconRPAL = NULL;
@@ -74,40 +81,76 @@ static const uint8 *Sprites_GetSprite(const uint8 *buffer, uint16 index)
 }
 
 /**
- * Loads the sprites.
+ * Loads the sprites. They only become available in g_sprites after
+ *  Sprites_Pack() is called.
  *
- * @param index The index of the list of sprite files to load.
- * @param sprites The array where to store CSIP for each loaded sprite.
+ * @param filename The name of the SHP file to load.
  */
-
-//uh wut....
 static void Sprites_Load(const char *filename)
 {
 	uint8 *buffer;
-	uint16 count;
-	uint16 i;
 
+	assert(s_spritesFilesCount < lengthof(s_spritesFiles));
+
+	Profile_Begin(filename);
 	buffer = Read_FileWholeFile(filename);
+	Profile_End();
+
+	s_spritesCount += READ_LE_UINT16(buffer);
+	s_spritesFiles[s_spritesFilesCount++] = buffer;
+}
 
-	count = READ_LE_UINT16(buffer);
+/**
+ * Copies the sprites of all files loaded by Sprites_Load() back to back in a
+ *  single block of memory, in the order they were loaded, and fills
+ *  g_sprites with them.
+ */
+static void Sprites_Pack(void)
+{
+	uint32 size = 0;
+	uint16 index = 0;
+	uint8 *dst;
+	uint16 i;
+
+	for (i = 0; i < s_spritesFilesCount; i++) {
+		const uint8 *buffer = s_spritesFiles[i];
+		uint16 count = READ_LE_UINT16(buffer);
+		uint16 j;
+
+		for (j = 0; j < count; j++) {
+			const uint8 *src = Sprites_GetSprite(buffer, j);
+
+			if (src != NULL) size += READ_LE_UINT16(src + 6);
+		}
+	}
 
-	s_spritesCount += count;
-	g_sprites = (uint8 **)realloc(g_sprites, s_spritesCount * sizeof(uint8 *));
+	g_sprites = (uint8 **)malloc(s_spritesCount * sizeof(uint8 *));
+	s_spritesArena = (uint8 *)malloc(size);
+	dst = s_spritesArena;
 
-	for (i = 0; i < count; i++) {
-		const uint8 *src = Sprites_GetSprite(buffer, i);
-		uint8 *dst = NULL;
+	for (i = 0; i < s_spritesFilesCount; i++) {
+		uint8 *buffer = s_spritesFiles[i];
+		uint16 count = READ_LE_UINT16(buffer);
+		uint16 j;
 
-		if (src != NULL) {
-			uint16 size = READ_LE_UINT16(src + 6);
-			dst = (uint8 *)malloc(size);
+		for (j = 0; j < count; j++) {
+			const uint8 *src = Sprites_GetSprite(buffer, j);
+
+			if (src == NULL) {
+				g_sprites[index++] = NULL;
+				continue;
+			}
+
+			size = READ_LE_UINT16(src + 6);
 			memcpy(dst, src, size);
+			g_sprites[index++] = dst;
+			dst += size;
 		}
 
-		g_sprites[s_spritesCount - count + i] = dst;
+		free(buffer);
 	}
 
-	free(buffer);
+	s_spritesFilesCount = 0;
 }
 
 /**
@@ -337,6 +380,55 @@ uint16 Load_Picture(const char *filename, Screen screenID, uint8 *palette)
 	return Load_Uncompress(filename, screenID, palette) / 8000;
 }
 
+/**
+ * Hand the mouse cursor to the video driver, to draw it over the screen.
+ * @param sprite The mouse sprite, not LCW compressed.
+ * @param hotSpotX The X-position in the sprite that points at the mouse position.
+ * @param hotSpotY The Y-position in the sprite that points at the mouse position.
+ * @return True if the video driver draws the cursor.
+ */
+static bool Sprites_SetHardwareCursor(const uint8 *sprite, uint16 hotSpotX, uint16 hotSpotY)
+{
+	const uint8 *colours = NULL;
+	uint8 *pixels;
+	uint16 width;
+	uint16 height;
+	uint16 x;
+	uint16 y;
+	bool ret;
+
+	height = sprite[2];
+	width  = READ_LE_UINT16(sprite + 3);
+	if (width == 0 || height == 0) return false;
+
+	pixels = calloc(1, width * height);
+	if (pixels == NULL) return false;
+
+	if ((READ_LE_UINT16(sprite) & 0x1) != 0) colours = sprite + 10;
+	sprite += (colours != NULL) ? 26 : 10;
+
+	/* Each row holds colours, or a 0 followed by the amount of transparent pixels */
+	for (y = 0; y < height; y++) {
+		x = 0;
+		while (x < width) {
+			uint8 v = *sprite++;
+
+			if (v == 0) {
+				x += *sprite++;
+				continue;
+			}
+
+			pixels[y * width + x++] = (colours != NULL) ? colours[v] : v;
+		}
+	}
+
+	ret = Video_Mouse_SetCursor(pixels, width, height, hotSpotX, hotSpotY);
+
+	free(pixels);
+
+	return ret;
+}
+
 void Set_Mouse_Cursor(uint16 hotSpotX, uint16 hotSpotY, uint8 *sprite)
 {
 	uint16 size;
@@ -404,6 +496,9 @@ void Set_Mouse_Cursor(uint16 hotSpotX, uint16 hotSpotY, uint8 *sprite)
 	g_mouseHeight = sprite[5];
 	g_mouseWidth = (READ_LE_UINT16(sprite + 3) >> 3) + 2;
 
+	/* Drivers which cannot draw the cursor fall back to drawing it in SCREEN_0 */
+	if (g_mouseHardwareCursor && !Sprites_SetHardwareCursor(sprite, hotSpotX, hotSpotY)) g_mouseHardwareCursor = false;
+
 	Low_Show_Mouse();
 
 	MouseUpdate--;
@@ -457,44 +552,92 @@ bool Sprite_Revealed(uint16 spriteID)
 	return false;
 }
 
+/**
+ * The SHP files with the sprites, in the order of g_sprites. Names without
+ *  extension are language specific, see Language_Name().
+ */
+static const char * const s_spritesFilenames[] = {
+	"MOUSE.SHP",                                            /*   0 -   6 */
+	"BTTN",                                                 /*   7 -  11 */
+	"SHAPES.SHP",                                           /*  12 - 110 */
+	"UNITS2.SHP",                                           /* 111 - 150 */
+	"UNITS1.SHP",                                           /* 151 - 237 */
+	"UNITS.SHP",                                            /* 238 - 354 */
+	"CHOAM",                                                /* 355 - 372 */
+	"MENTAT",                                               /* 373 - 386 */
+	"MENSHPH.SHP",                                          /* 387 - 401 */
+	"MENSHPA.SHP",                                          /* 402 - 416 */
+	"MENSHPO.SHP",                                          /* 417 - 431 */
+	"MENSHPM.SHP",                                          /* 432 - 446 (Placeholder - Fremen) */
+	"MENSHPM.SHP",                                          /* 447 - 461 (Placeholder - Sardaukar) */
+	"MENSHPM.SHP",                                          /* 462 - 476 */
+	"PIECES.SHP",                                           /* 477 - 504 */
+	"ARROWS.SHP",                                           /* 505 - 513 */
+	"CREDIT1.SHP",                                          /* 514 */
+	"CREDIT2.SHP",                                          /* 515 */
+	"CREDIT3.SHP",                                          /* 516 */
+	"CREDIT4.SHP",                                          /* 517 */
+	"CREDIT5.SHP",                                          /* 518 */
+	"CREDIT6.SHP",                                          /* 519 */
+	"CREDIT7.SHP",                                          /* 520 */
+	"CREDIT8.SHP",                                          /* 521 */
+	"CREDIT9.SHP",                                          /* 522 */
+	"CREDIT10.SHP",                                         /* 523 */
+	"CREDIT11.SHP"                                          /* 524 */
+};
+
+/**
+ * Gets the name of a SHP file with sprites.
+ *
+ * @param index The index in s_spritesFilenames.
+ * @return The name of the file.
+ */
+static const char *Sprites_GetFilename(uint8 index)
+{
+	const char *filename = s_spritesFilenames[index];
+
+	if (strchr(filename, '.') == NULL) return Language_Name(filename);
+	return filename;
+}
+
+/**
+ * Start reading the SHP files in the background, see File_Preload().
+ */
+void Sprites_Preload(void)
+{
+	uint8 i;
+
+	for (i = 0; i < lengthof(s_spritesFilenames); i++) File_Preload(Sprites_GetFilename(i));
+}
+
+/**
+ * Start reading the files of Sprites_LoadTiles() in the background, if they
+ *  are not loaded yet.
+ */
+void Sprites_PreloadTiles(void)
+{
+	if (s_iconLoaded) return;
+
+	File_Preload("ICON.ICN");
+	File_Preload("ICON.MAP");
+	File_Preload("UNIT.EMC");
+}
+
 void Sprites_Init(void)
 {
+	uint8 i;
+
 	g_spriteBuffer = calloc(1, 20000);
-	Sprites_Load("MOUSE.SHP");                       /*   0 -   6 */
-	Sprites_Load(Language_Name("BTTN"));   /*   7 -  11 */
-	Sprites_Load("SHAPES.SHP");                      /*  12 - 110 */
-	Sprites_Load("UNITS2.SHP");                      /* 111 - 150 */
-	Sprites_Load("UNITS1.SHP");                      /* 151 - 237 */
-	Sprites_Load("UNITS.SHP");                       /* 238 - 354 */
-	Sprites_Load(Language_Name("CHOAM"));  /* 355 - 372 */
-	Sprites_Load(Language_Name("MENTAT")); /* 373 - 386 */
-	Sprites_Load("MENSHPH.SHP");                     /* 387 - 401 */
-	Sprites_Load("MENSHPA.SHP");                     /* 402 - 416 */
-	Sprites_Load("MENSHPO.SHP");                     /* 417 - 431 */
-	Sprites_Load("MENSHPM.SHP");                     /* 432 - 446 (Placeholder - Fremen) */
-	Sprites_Load("MENSHPM.SHP");                     /* 447 - 461 (Placeholder - Sardaukar) */
-	Sprites_Load("MENSHPM.SHP");                     /* 462 - 476 */
-	Sprites_Load("PIECES.SHP");                      /* 477 - 504 */
-	Sprites_Load("ARROWS.SHP");                      /* 505 - 513 */
-	Sprites_Load("CREDIT1.SHP");                     /* 514 */
-	Sprites_Load("CREDIT2.SHP");                     /* 515 */
-	Sprites_Load("CREDIT3.SHP");                     /* 516 */
-	Sprites_Load("CREDIT4.SHP");                     /* 517 */
-	Sprites_Load("CREDIT5.SHP");                     /* 518 */
-	Sprites_Load("CREDIT6.SHP");                     /* 519 */
-	Sprites_Load("CREDIT7.SHP");                     /* 520 */
-	Sprites_Load("CREDIT8.SHP");                     /* 521 */
-	Sprites_Load("CREDIT9.SHP");                     /* 522 */
-	Sprites_Load("CREDIT10.SHP");                    /* 523 */
-	Sprites_Load("CREDIT11.SHP");                    /* 524 */
+
+	for (i = 0; i < lengthof(s_spritesFilenames); i++) Sprites_Load(Sprites_GetFilename(i));
+	Sprites_Pack();
 }
 
 void Sprites_Uninit(void)
 {
-	uint16 i;
-
-	for (i = 0; i < s_spritesCount; i++) free(g_sprites[i]);
+	free(s_spritesArena); s_spritesArena = NULL;
 	free(g_sprites); g_sprites = NULL;
+	s_spritesCount = 0;
 
 	free(g_spriteBuffer); g_spriteBuffer = NULL;
 
@@ -68,6 +68,8 @@ extern uint16 g_landscapeSpriteID;                          /*!< First landscape
 extern uint16 g_builtSlabSpriteID;                          /*!< SpriteID of the built concrete slab. */
 extern uint16 g_wallSpriteID;                               /*!< First wall spriteID. */
 
+extern void Sprites_Preload(void);
+extern void Sprites_PreloadTiles(void);
 extern void Sprites_Init(void);
 extern void Sprites_Uninit(void);
 extern uint8 Sprite_GetWidth(uint8 *sprite);
@@ -144,6 +144,17 @@ static void String_Load(const char *filename, bool compressed, int start, int en
 	free(buf);
 }
 
+/**
+ * Start reading the language files in the background, see File_Preload().
+ */
+void String_Preload(void)
+{
+	static const char * const filenames[] = { "DUNE", "MESSAGE", "INTRO", "TEXTH", "TEXTA", "TEXTO", "PROTECT" };
+	uint8 i;
+
+	for (i = 0; i < lengthof(filenames); i++) File_Preload(Language_Name(filenames[i]));
+}
+
 /**
  * Loads the language files in the memory, which is used after that with String_GetXXX_ByIndex().
  */
@@ -23,6 +23,7 @@ extern uint16 UnDip_Text(const char *source, char *dest);
 extern const char *Language_Name(const char *name);
 extern char *Extract_String(uint16 stringID);
 extern void String_TranslateSpecial(char *source, char *dest);
+extern void String_Preload(void);
 extern void String_Init(void);
 extern void String_Uninit(void);
 extern uint8 *String_NextString(uint8 *ptr);
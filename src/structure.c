@@ -12,6 +12,7 @@
 #include "animation.h"
 #include "audio/sound.h"
 #include "explosion.h"
+#include "gamecontext.h"
 #include "gfx.h"
 #include "gui/gui.h"
 #include "gui/widget.h"
@@ -34,17 +35,13 @@
 #include "unit.h"
 
 
-Structure *g_structureActive = NULL;
-uint16 g_structureActivePosition = 0;
-uint16 g_structureActiveType = 0;
-
 static bool s_debugInstantBuild = false; /*!< When non-zero, constructions are almost instant. */
-static uint32 s_tickStructureDegrade   = 0; /*!< Indicates next time Degrade function is executed. */
-static uint32 s_tickStructureStructure = 0; /*!< Indicates next time Structures function is executed. */
-static uint32 s_tickStructureScript    = 0; /*!< Indicates next time Script function is executed. */
-static uint32 s_tickStructurePalace    = 0; /*!< Indicates next time Palace function is executed. */
 
-uint16 g_structureIndex;
+#define s_tickStructureDegrade   (g_gameContext->tickStructureDegrade)
+#define s_tickStructureStructure (g_gameContext->tickStructureStructure)
+#define s_tickStructureScript    (g_gameContext->tickStructureScript)
+#define s_tickStructurePalace    (g_gameContext->tickStructurePalace)
+
 
 /**
  * Loop over all structures, preforming various of tasks.
@@ -6,6 +6,7 @@
 
 #include "team.h"
 
+#include "gamecontext.h"
 #include "opendune.h"
 #include "house.h"
 #include "pool/pool.h"
@@ -14,7 +15,7 @@
 #include "timer.h"
 #include "tools.h"
 
-static uint32 s_tickTeamGameLoop = 0; /*!< Indicates next time the GameLoop function is executed. */
+#define s_tickTeamGameLoop (g_gameContext->tickTeamGameLoop)
 
 /**
  * Loop over all teams, performing various of tasks.
@@ -8,6 +8,7 @@
 
 #include "tile.h"
 
+#include "gamecontext.h"
 #include "house.h"
 #include "map.h"
 #include "tools.h"
@@ -243,6 +244,63 @@ uint16 Tile_GetDistanceRoundedUp(CellStruct from, CellStruct to)
 	return (Tile_GetDistance(from, to) + 0x80) >> 8;
 }
 
+/** Biggest radius which does not yet cover the whole map from every position. */
+#define SIGHT_RADIUS_MAX 95
+
+/**
+ * Half width of the circle Sight_From() unveils, per radius and per absolute
+ *  row distance to the center; -1 if the row is outside the circle.
+ * This is exactly the set of tiles for which Tile_GetDistanceRoundedUp() is
+ *  not more than the radius.
+ */
+static int8 s_sightHalfWidth[SIGHT_RADIUS_MAX + 1][64];
+static bool s_sightHalfWidthInit = false;
+
+/**
+ * Fill the table with half widths of the sight circles.
+ */
+static void Sight_InitHalfWidths(void)
+{
+	uint16 radius;
+	uint16 dy;
+
+	for (radius = 0; radius <= SIGHT_RADIUS_MAX; radius++) {
+		for (dy = 0; dy < 64; dy++) {
+			int16 dx;
+
+			/* The rounded up distance of two tiles is the longest axis plus half the shortest, rounded up. */
+			for (dx = -1; dx < 63; dx++) {
+				uint16 next = dx + 1;
+
+				if (max(next, dy) + (min(next, dy) + 1) / 2 > radius) break;
+			}
+
+			s_sightHalfWidth[radius][dy] = (int8)dx;
+		}
+	}
+
+	s_sightHalfWidthInit = true;
+}
+
+/**
+ * Get the bits of a bit array word which are between two X-positions of a row.
+ *
+ * @param word Which of the two words of the row (0 or 1).
+ * @param left The left-most X-position.
+ * @param right The right-most X-position.
+ * @return The mask for the word.
+ */
+static uint32 Sight_RowMask(uint16 word, int16 left, int16 right)
+{
+	int16 base = word * 32;
+
+	if (left < base) left = base;
+	if (right > base + 31) right = base + 31;
+	if (left > right) return 0;
+
+	return (0xFFFFFFFF >> (31 - (right - base))) & (0xFFFFFFFF << (left - base));
+}
+
 /**
  * Remove fog in the radius around the given tile.
  *
@@ -251,6 +309,7 @@ uint16 Tile_GetDistanceRoundedUp(CellStruct from, CellStruct to)
  */
 void Sight_From(CellStruct tile, uint16 radius)
 {
+	uint32 pending;
 	uint16 packed;
 	uint16 x, y;
 	int16 i, j;
@@ -259,21 +318,44 @@ void Sight_From(CellStruct tile, uint16 radius)
 
 	if (!Map_IsValidPosition(packed)) return;
 
+	if (!s_sightHalfWidthInit) Sight_InitHalfWidths();
+	if (radius > SIGHT_RADIUS_MAX) radius = SIGHT_RADIUS_MAX;
+
 	x = Tile_GetPackedX(packed);
 	y = Tile_GetPackedY(packed);
-	tile = Tile_MakeXY(x, y);
 
+	/* Most of the time everything in sight is already unveiled; check that
+	 *  with a few word operations per row before touching any tile. */
+	pending = 0;
+	for (j = -radius; j <= radius; j++) {
+		int16 halfWidth;
+		uint16 row;
+
+		if ((y + j) < 0 || (y + j) >= 64) continue;
+
+		halfWidth = s_sightHalfWidth[radius][abs(j)];
+		if (halfWidth < 0) continue;
+
+		row = (y + j) * 2;
+		pending |= Sight_RowMask(0, x - halfWidth, x + halfWidth) & ~g_unveiledMap[row];
+		pending |= Sight_RowMask(1, x - halfWidth, x + halfWidth) & ~g_unveiledMap[row + 1];
+	}
+
+	if (pending == 0) return;
+
+	/* Keep the original column by column order, as unveiling has side-effects
+	 *  (unit counts, hints, AI activation) which depend on it. */
 	for (i = -radius; i <= radius; i++) {
-		for (j = -radius; j <= radius; j++) {
-			CellStruct t;
+		if ((x + i) < 0 || (x + i) >= 64) continue;
 
-			if ((x + i) < 0 || (x + i) >= 64) continue;
+		for (j = -radius; j <= radius; j++) {
 			if ((y + j) < 0 || (y + j) >= 64) continue;
 
+			if (abs(i) > s_sightHalfWidth[radius][abs(j)]) continue;
+
 			packed = Tile_PackXY(x + i, y + j);
-			t = Tile_MakeXY(x + i, y + j);
 
-			if (Tile_GetDistanceRoundedUp(tile, t) > radius) continue;
+			if (BitArray_Test(g_unveiledMap, packed)) continue;
 
 			Map_UnveilTile(packed, g_playerHouseID);
 		}
@@ -28,10 +28,11 @@
 
 #include "timer.h"
 
+#include "gamecontext.h"
+
 
 
 uint32 g_timerGUI = 0;                                      /*!< Tick counter. Increases with 1 every tick when Timer 1 is enabled. Used for GUI. */
-uint32 g_timerGame = 0;                                     /*!< Tick counter. Increases with 1 every tick when Timer 2 is enabled. Used for game timing (units, ..). */
 uint32 g_timerInput = 0;                                    /*!< Tick counter. Increases with 1 every tick. Used for input timing. */
 uint32 g_timerSleep = 0;                                    /*!< Tick counter. Increases with 1 every tick. Used for sleeping. */
 uint32 g_timerTimeout = 0;                                  /*!< Tick counter. Decreases with 1 every tick when non-zero. Used to timeout. */
@@ -62,6 +63,9 @@ static uint32 s_timerLastTime;
 
 static const uint32 s_timerSpeed = 1000000 / 120; /* Our timer runs at 120Hz */
 
+static bool s_timerFastForward = false;                     /*!< If true, time is simulated instead of measured. */
+static uint32 s_timerFastForwardTicks = 1;                  /*!< Amount of 60Hz ticks the next timer run simulates. */
+
 
 uint32 Timer_GetTime(void)
 {
@@ -98,6 +102,12 @@ static void Timer_InterruptRun(int arg)
 	usec_delta = (new_time - s_timerLastTime) * 1000;
 	s_timerLastTime = new_time;
 
+	/* When fast forwarding, every run is a fixed amount of game time */
+	if (s_timerFastForward) {
+		usec_delta = s_timerFastForwardTicks * (1000000 / 60);
+		s_timerFastForwardTicks = 1;
+	}
+
 	/* Walk all our timers, see which (and how often) it should be triggered */
 	node = s_timerNodes;
 	for (i = 0; i < s_timerNodeCount; i++, node++) {
@@ -146,6 +156,13 @@ static void Timer_Handler(int sig)
 
 void SleepAndProcessBackgroundTasks(void)
 {
+	if (s_timerFastForward) {
+		/* Don't wait for the real time to pass */
+		s_timer_count = 0;
+		Timer_InterruptRun(0);
+		return;
+	}
+
 	while (s_timer_count == 0) {
 		pause();	/* wait for a signal to happen */
 		/* another signal can have been triggered,
@@ -350,6 +367,42 @@ bool Timer_SetTimer(TimerType timer, bool set)
 	return ret;
 }
 
+/**
+ * Switch fast forwarding on or off. When on, time is no longer measured;
+ *  every moment the game is idle, a single tick of 1/60 second passes
+ *  (or as many as set by Timer_FastForward()). This makes the game run as
+ *  fast as possible, while the timers advance exactly as in real time.
+ *
+ * On Windows the timers run in their own thread, so there fast forwarding
+ *  only advances the time faster; it doesn't stop waiting for it.
+ *
+ * @param enable True to switch fast forwarding on.
+ */
+void Timer_SetFastForward(bool enable)
+{
+	s_timerFastForward = enable;
+	s_timerFastForwardTicks = 1;
+}
+
+/**
+ * Check if fast forwarding is on.
+ * @return True if and only if the time is simulated.
+ */
+bool Timer_IsFastForward(void)
+{
+	return s_timerFastForward;
+}
+
+/**
+ * Set the amount of ticks of 1/60 second which pass the next moment the game
+ *  is idle, when fast forwarding. Afterwards it returns to a single tick.
+ * @param ticks The amount of ticks; can be zero.
+ */
+void Timer_FastForward(uint32 ticks)
+{
+	s_timerFastForwardTicks = ticks;
+}
+
 /**
  * Sleep for an amount of ticks.
  * @param ticks The amount of ticks to sleep.
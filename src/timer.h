@@ -9,7 +9,6 @@ typedef enum TimerType {
 } TimerType;
 
 extern uint32 g_timerGUI;
-extern uint32 g_timerGame;
 extern uint32 g_timerInput;
 extern uint32 g_timerSleep;
 extern uint32 g_timerTimeout;
@@ -24,6 +23,10 @@ extern void Timer_Uninit(void);
 
 extern void Timer_Tick(void);
 
+extern void Timer_SetFastForward(bool enable);
+extern bool Timer_IsFastForward(void);
+extern void Timer_FastForward(uint32 ticks);
+
 extern void Timer_Add(void (*callback)(void), uint32 usec_delay, bool callonce);
 extern void Timer_Change(void (*callback)(void), uint32 usec_delay);
 extern void Timer_Remove(void (*callback)(void));
@@ -2,11 +2,14 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "types.h"
+#include "os/math.h"
 
 #include "tools.h"
 
 #include "config.h"
+#include "gamecontext.h"
 #include "pool/structure.h"
 #include "pool/unit.h"
 #include "structure.h"
@@ -14,8 +17,8 @@
 #include "unit.h"
 
 
-static uint8 s_randomSeed[4];
-static uint32 s_randomLCG;
+#define s_randomSeed (g_gameContext->randomSeed)
+#define s_randomLCG  (g_gameContext->randomLCG)
 
 uint16 Tools_AdjustToGameSpeed(uint16 normal, uint16 minimum, uint16 maximum, bool inverseSpeed)
 {
@@ -272,6 +275,28 @@ void Tools_RandomLCG_Seed(uint16 seed)
 	s_randomLCG = seed;
 }
 
+/**
+ * Get the state of both randomizers, so it can be restored later.
+ * @param seed The state of the 256 randomizer (4 bytes).
+ * @param lcg The state of the LCG randomizer.
+ */
+void Tools_Random_GetState(uint8 *seed, uint32 *lcg)
+{
+	memcpy(seed, s_randomSeed, sizeof(s_randomSeed));
+	*lcg = s_randomLCG;
+}
+
+/**
+ * Restore the state of both randomizers.
+ * @param seed The state of the 256 randomizer (4 bytes).
+ * @param lcg The state of the LCG randomizer.
+ */
+void Tools_Random_SetState(const uint8 *seed, uint32 lcg)
+{
+	memcpy(s_randomSeed, seed, sizeof(s_randomSeed));
+	s_randomLCG = lcg;
+}
+
 /**
  * Get a random value from the LCG.
  */
@@ -310,32 +335,70 @@ uint16 Tools_RandomLCG_Range(uint16 min, uint16 max)
 }
 
 /**
- * Test a bit in a bit array.
- * @param array Bit array.
- * @param index Index in the array.
- * @return value of the bit.
+ * Get the mask of the bits in one word of a bit array which are inside a range.
+ * @param word The index of the word in the array.
+ * @param index The first bit of the range.
+ * @param end The bit after the last bit of the range.
+ * @return The mask for the word.
  */
-bool BitArray_Test(uint8 *array, uint16 index)
+static uint32 BitArray_WordMask(uint16 word, uint32 index, uint32 end)
 {
-	return (array[index >> 3] & (1 << (index & 7))) != 0;
+	uint32 base = (uint32)word << 5;
+	uint32 mask = 0xFFFFFFFF;
+
+	if (index > base) mask &= 0xFFFFFFFF << (index - base);
+	if (end < base + 32) mask &= 0xFFFFFFFF >> (base + 32 - end);
+
+	return mask;
 }
 
 /**
- * Set a bit in a bit array.
+ * Find the next set bit in a bit array. Words without any bit set are
+ *  skipped as a whole.
  * @param array Bit array.
- * @param index Index in the array.
+ * @param index Index in the array to start searching from (inclusive).
+ * @param end Index in the array to stop searching at (exclusive).
+ * @return The index of the first set bit, or end if there is none.
  */
-void BitArray_Set(uint8 *array, uint16 index)
+uint16 BitArray_FindNext(const uint32 *array, uint16 index, uint16 end)
 {
-	array[index >> 3] |= (1 << (index & 7));
+	while (index < end) {
+		uint32 word = array[index >> 5] >> (index & 31);
+
+		if (word == 0) {
+			index = (index | 31) + 1;
+			continue;
+		}
+
+		while ((word & 0xFF) == 0) {
+			word >>= 8;
+			index += 8;
+		}
+		while ((word & 1) == 0) {
+			word >>= 1;
+			index++;
+		}
+
+		return min(index, end);
+	}
+
+	return end;
 }
 
 /**
- * Clear a bit in a bit array.
+ * Set a range of bits in a bit array.
  * @param array Bit array.
- * @param index Index in the array.
+ * @param index Index of the first bit to set.
+ * @param count Amount of bits to set.
  */
-void BitArray_Clear(uint8 *array, uint16 index)
+void BitArray_SetRange(uint32 *array, uint16 index, uint16 count)
 {
-	array[index >> 3] &= ~(1 << (index & 7));
+	uint32 end = (uint32)index + count;
+	uint16 word;
+
+	if (count == 0) return;
+
+	for (word = index >> 5; word <= (end - 1) >> 5; word++) {
+		array[word] |= BitArray_WordMask(word, index, end);
+	}
 }
@@ -32,10 +32,22 @@ extern struct Object *Tools_Index_GetObject(uint16 encoded);
 extern uint8 Tools_Random_256(void);
 extern void Tools_Random_Seed(uint32 seed);
 extern void Tools_RandomLCG_Seed(uint16 seed);
+extern void Tools_Random_GetState(uint8 *seed, uint32 *lcg);
+extern void Tools_Random_SetState(const uint8 *seed, uint32 lcg);
 extern uint16 Tools_RandomLCG_Range(uint16 min, uint16 max);
 
-extern bool BitArray_Test(uint8 *array, uint16 index);
-extern void BitArray_Set(uint8 *array, uint16 index);
-extern void BitArray_Clear(uint8 *array, uint16 index);
+/**
+ * Bit arrays are arrays of uint32 words; bit 'index' lives in word
+ *  'index / 32'. A bit array for the map (one bit per tile) is 128 words,
+ *  two per map row.
+ * Test, set and clear a single bit are macros, as they are used in the
+ *  inner loops of the map and viewport code. 'index' is evaluated twice.
+ */
+#define BitArray_Test(array, index)  (((array)[(index) >> 5] & ((uint32)1 << ((index) & 31))) != 0)
+#define BitArray_Set(array, index)   ((array)[(index) >> 5] |= ((uint32)1 << ((index) & 31)))
+#define BitArray_Clear(array, index) ((array)[(index) >> 5] &= ~((uint32)1 << ((index) & 31)))
+
+extern uint16 BitArray_FindNext(const uint32 *array, uint16 index, uint16 end);
+extern void BitArray_SetRange(uint32 *array, uint16 index, uint16 count);
 
 #endif /* TOOLS_H */
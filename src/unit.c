@@ -15,6 +15,7 @@
 #include "audio/sound.h"
 #include "config.h"
 #include "explosion.h"
+#include "gamecontext.h"
 #include "gui/gui.h"
 #include "gui/widget.h"
 #include "house.h"
@@ -35,17 +36,14 @@
 #include "tools.h"
 
 
-static uint32 s_tickUnitMovement  = 0; /*!< Indicates next time the Movement function is executed. */
-static uint32 s_tickUnitRotation  = 0; /*!< Indicates next time the Rotation function is executed. */
-static uint32 s_tickUnitBlinking  = 0; /*!< Indicates next time the Blinking function is executed. */
-static uint32 s_tickUnitUnknown4  = 0; /*!< Indicates next time the Unknown4 function is executed. */
-static uint32 s_tickUnitScript    = 0; /*!< Indicates next time the Script function is executed. */
-static uint32 s_tickUnitUnknown5  = 0; /*!< Indicates next time the Unknown5 function is executed. */
-static uint32 s_tickUnitDeviation = 0; /*!< Indicates next time the Deviation function is executed. */
+#define s_tickUnitMovement  (g_gameContext->tickUnitMovement)
+#define s_tickUnitRotation  (g_gameContext->tickUnitRotation)
+#define s_tickUnitBlinking  (g_gameContext->tickUnitBlinking)
+#define s_tickUnitUnknown4  (g_gameContext->tickUnitUnknown4)
+#define s_tickUnitScript    (g_gameContext->tickUnitScript)
+#define s_tickUnitUnknown5  (g_gameContext->tickUnitUnknown5)
+#define s_tickUnitDeviation (g_gameContext->tickUnitDeviation)
 
-Unit *g_unitActive = NULL;
-Unit *g_unitHouseMissile = NULL;
-Unit *g_unitSelected = NULL;
 
 uint16 g_dirtyUnitCount = 0;
 uint16 g_dirtyAirUnitCount = 0;
@@ -54,7 +52,6 @@ uint16 g_dirtyAirUnitCount = 0;
  * Number of units of each type available at the starport.
  * \c 0 means not available, \c -1 means \c 0 units, \c >0 means that number of units available.
  */
-int16 g_starportAvailable[UNIT_MAX];
 
 /**
  * Rotate a unit (or his top).
@@ -408,6 +405,7 @@ Unit *Unit_Create(uint16 index, uint8 typeID, uint8 houseID, CellStruct position
 	Unit_SetSpeed(u, 0);
 
 	u->o.position       = position;
+	Unit_UpdateDrawOrder(u);
 	u->o.hitpoints      = ui->o.hitpoints;
 	u->currentDestination.x = 0;
 	u->currentDestination.y = 0;
@@ -582,35 +580,17 @@ Team *Unit_GetTeam(Unit *u)
 }
 
 /**
- * ?? Sorts unit array and count enemy/allied units.
+ * Count the Units on the map the player can see, as the radar of an Outpost
+ *  shows them.
+ * @param allied Where to store the amount of allied Units.
+ * @param enemy Where to store the amount of enemy Units.
  */
-void Unit_Sort(void)
+void Unit_CountVisible(uint16 *allied, uint16 *enemy)
 {
-	House *h;
 	uint16 i;
 
-	h = g_playerHouse;
-	h->unitCountEnemy = 0;
-	h->unitCountAllied = 0;
-
-	for (i = 0; i < g_unitFindCount - 1; i++) {
-		Unit *u1;
-		Unit *u2;
-		uint16 y1;
-		uint16 y2;
-
-		u1 = g_unitFindArray[i];
-		u2 = g_unitFindArray[i + 1];
-		y1 = Tile_GetY(u1->o.position);
-		y2 = Tile_GetY(u2->o.position);
-		if (g_table_unitInfo[u1->o.type].movementType == MOVEMENT_FOOT) y1 -= 0x100;
-		if (g_table_unitInfo[u2->o.type].movementType == MOVEMENT_FOOT) y2 -= 0x100;
-
-		if ((int16)y1 > (int16)y2) {
-			g_unitFindArray[i] = u2;
-			g_unitFindArray[i + 1] = u1;
-		}
-	}
+	*allied = 0;
+	*enemy = 0;
 
 	for (i = 0; i < g_unitFindCount; i++) {
 		Unit *u;
@@ -618,9 +598,9 @@ void Unit_Sort(void)
 		u = g_unitFindArray[i];
 		if ((u->o.seenByHouses & (1 << g_playerHouseID)) != 0 && !u->o.flags.s.isNotOnMap) {
 			if (House_AreAllied(u->o.houseID, g_playerHouseID)) {
-				h->unitCountAllied++;
+				(*allied)++;
 			} else {
-				h->unitCountEnemy++;
+				(*enemy)++;
 			}
 		}
 	}
@@ -732,52 +712,166 @@ void Unit_SetDestination(Unit *u, uint16 destination)
 	u->Path[0]   = 0xFF;
 }
 
+/** Maximum amount of candidates in a TargetBatch; there are less structures than units. */
+#define TARGET_BATCH_MAX UNIT_INDEX_MAX
+
 /**
- * Get the priority a target unit has for a given unit. The higher the value,
- *  the more serious it should look at the target.
+ * Candidate targets for a unit, packed per field, so the distances and
+ *  priorities of all of them are calculated in a few tight loops. Everything
+ *  about a candidate which does not depend on the distance is checked when it
+ *  is added.
+ */
+typedef struct TargetBatch {
+	CellStruct from;                                        /*!< Position of the unit looking for a target. */
+	bool checkRange;                                        /*!< Skip candidates within their own range (the unit is outside the map). */
+	uint16 addend;                                          /*!< Added to the priority divided by the distance. */
+	uint16 count;                                           /*!< Amount of candidates. */
+	uint16 x[TARGET_BATCH_MAX];                             /*!< X position of the candidates. */
+	uint16 y[TARGET_BATCH_MAX];                             /*!< Y position of the candidates. */
+	uint16 range[TARGET_BATCH_MAX];                         /*!< Range of the candidates. */
+	uint16 priority[TARGET_BATCH_MAX];                      /*!< Base priority of the candidates; the final priority after Unit_TargetBatch_Score(). */
+	void *object[TARGET_BATCH_MAX];                         /*!< The candidates. */
+} TargetBatch;
+
+/**
+ * Start an empty batch of candidates.
  *
+ * @param batch The candidates.
+ * @param unit The unit looking for a target.
+ * @param addend What to add to the priority divided by the distance.
+ */
+static void Unit_TargetBatch_Init(TargetBatch *batch, Unit *unit, uint16 addend)
+{
+	batch->from       = unit->o.position;
+	batch->checkRange = !Map_IsValidPosition(Tile_PackTile(unit->o.position));
+	batch->addend     = addend;
+	batch->count      = 0;
+}
+
+/**
+ * Add a unit to the candidates, if it can be a target at all.
+ *
+ * @param batch The candidates.
  * @param unit The unit looking at a target.
  * @param target The unit to look at.
- * @return The priority of the target.
  */
-uint16 Unit_GetTargetUnitPriority(Unit *unit, Unit *target)
+static void Unit_TargetBatch_AddUnit(TargetBatch *batch, Unit *unit, Unit *target)
 {
 	const UnitInfo *targetInfo;
 	const UnitInfo *unitInfo;
-	uint16 distance;
-	uint16 priority;
+	uint16 i;
 
-	if (unit == NULL || target == NULL) return 0;
-	if (unit == target) return 0;
+	if (unit == NULL || target == NULL) return;
+	if (unit == target) return;
 
-	if (!target->o.flags.s.allocated) return 0;
-	if ((target->o.seenByHouses & (1 << Unit_GetHouseID(unit))) == 0) return 0;
+	if (!target->o.flags.s.allocated) return;
+	if ((target->o.seenByHouses & (1 << Unit_GetHouseID(unit))) == 0) return;
 
-	if (House_AreAllied(Unit_GetHouseID(unit), Unit_GetHouseID(target))) return 0;
+	if (House_AreAllied(Unit_GetHouseID(unit), Unit_GetHouseID(target))) return;
 
 	unitInfo   = &g_table_unitInfo[unit->o.type];
 	targetInfo = &g_table_unitInfo[target->o.type];
 
-	if (!targetInfo->o.flags.priority) return 0;
+	if (!targetInfo->o.flags.priority) return;
 
 	if (targetInfo->movementType == MOVEMENT_WINGER) {
-		if (!unitInfo->o.flags.targetAir) return 0;
-		if (target->o.houseID == g_playerHouseID && !Map_IsPositionUnveiled(Tile_PackTile(target->o.position))) return 0;
+		if (!unitInfo->o.flags.targetAir) return;
+		if (target->o.houseID == g_playerHouseID && !Map_IsPositionUnveiled(Tile_PackTile(target->o.position))) return;
 	}
 
-	if (!Map_IsValidPosition(Tile_PackTile(target->o.position))) return 0;
+	if (!Map_IsValidPosition(Tile_PackTile(target->o.position))) return;
 
-	distance = Tile_GetDistanceRoundedUp(unit->o.position, target->o.position);
+	i = batch->count++;
+	batch->x[i]        = target->o.position.x;
+	batch->y[i]        = target->o.position.y;
+	batch->range[i]    = targetInfo->Range;
+	batch->priority[i] = targetInfo->o.priorityTarget + targetInfo->o.priorityBuild;
+	batch->object[i]   = target;
+}
+
+/**
+ * Add a structure to the candidates, if it can be a target at all.
+ *
+ * @param batch The candidates.
+ * @param unit The unit looking at a target.
+ * @param target The structure to look at.
+ */
+static void Unit_TargetBatch_AddStructure(TargetBatch *batch, Unit *unit, Structure *target)
+{
+	const StructureInfo *si;
+	uint16 i;
 
-	if (!Map_IsValidPosition(Tile_PackTile(unit->o.position))) {
-		if (targetInfo->Range >= distance) return 0;
+	if (unit == NULL || target == NULL) return;
+
+	if (House_AreAllied(Unit_GetHouseID(unit), target->o.houseID)) return;
+	if ((target->o.seenByHouses & (1 << Unit_GetHouseID(unit))) == 0) return;
+
+	si = &g_table_structureInfo[target->o.type];
+
+	i = batch->count++;
+	batch->x[i]        = target->o.position.x;
+	batch->y[i]        = target->o.position.y;
+	batch->range[i]    = 0;
+	batch->priority[i] = si->o.priorityBuild + si->o.priorityTarget;
+	batch->object[i]   = target;
+}
+
+/**
+ * Calculate the priority of all candidates, the same way as
+ *  Unit_GetTargetUnitPriority() and Unit_GetTargetStructurePriority() do for
+ *  a single one. The loops have no calls and no early exits, so the compiler
+ *  is free to vectorise them.
+ *
+ * @param batch The candidates; their base priority is replaced by the priority.
+ */
+static void Unit_TargetBatch_Score(TargetBatch *batch)
+{
+	uint16 distance[TARGET_BATCH_MAX];
+	uint16 count = batch->count;
+	uint16 i;
+
+	/* Tile_GetDistanceRoundedUp() */
+	for (i = 0; i < count; i++) {
+		uint16 dx = abs(batch->from.x - batch->x[i]);
+		uint16 dy = abs(batch->from.y - batch->y[i]);
+		uint16 d  = (dx > dy) ? dx + (dy / 2) : dy + (dx / 2);
+
+		distance[i] = (d + 0x80) >> 8;
 	}
 
-	priority = targetInfo->o.priorityTarget + targetInfo->o.priorityBuild;
-	if (distance != 0) priority = (priority / distance) + 1;
+	for (i = 0; i < count; i++) {
+		uint16 priority = batch->priority[i];
+
+		if (batch->checkRange && batch->range[i] >= distance[i]) {
+			priority = 0;
+		} else if (distance[i] != 0) {
+			priority = (priority / distance[i]) + batch->addend;
+		}
+
+		batch->priority[i] = min(priority, 0x7D00);
+	}
+}
+
+/**
+ * Get the priority a target unit has for a given unit. The higher the value,
+ *  the more serious it should look at the target.
+ *
+ * @param unit The unit looking at a target.
+ * @param target The unit to look at.
+ * @return The priority of the target.
+ */
+uint16 Unit_GetTargetUnitPriority(Unit *unit, Unit *target)
+{
+	TargetBatch batch;
+
+	if (unit == NULL) return 0;
+
+	Unit_TargetBatch_Init(&batch, unit, 1);
+	Unit_TargetBatch_AddUnit(&batch, unit, target);
+	if (batch.count == 0) return 0;
 
-	if (priority > 0x7D00) return 0x7D00;
-	return priority;
+	Unit_TargetBatch_Score(&batch);
+	return batch.priority[0];
 }
 
 /**
@@ -853,6 +947,7 @@ bool Unit_SetPosition(Unit *u, CellStruct position)
 	u->o.flags.s.isNotOnMap = false;
 
 	u->o.position = Tile_Center(position);
+	Unit_UpdateDrawOrder(u);
 
 	if (u->originEncoded == 0) Unit_FindClosestRefinery(u);
 
@@ -925,8 +1020,10 @@ Unit *Unit_FindBestTargetUnit(Unit *u, uint16 mode)
 	CellStruct position;
 	uint16 distance;
 	PoolFindStruct find;
+	TargetBatch batch;
 	Unit *best = NULL;
 	uint16 bestPriority = 0;
+	uint16 i;
 
 	if (u == NULL) return NULL;
 
@@ -944,9 +1041,10 @@ Unit *Unit_FindBestTargetUnit(Unit *u, uint16 mode)
 	find.type    = 0xFFFF;
 	find.index   = 0xFFFF;
 
+	Unit_TargetBatch_Init(&batch, u, 1);
+
 	while (true) {
 		Unit *target;
-		uint16 priority;
 
 		target = Unit_Find(&find);
 
@@ -961,11 +1059,16 @@ Unit *Unit_FindBestTargetUnit(Unit *u, uint16 mode)
 			}
 		}
 
-		priority = Unit_GetTargetUnitPriority(u, target);
+		Unit_TargetBatch_AddUnit(&batch, u, target);
+	}
 
-		if ((int16)priority > (int16)bestPriority) {
-			best = target;
-			bestPriority = priority;
+	Unit_TargetBatch_Score(&batch);
+
+	/* On equal priority, the first candidate wins */
+	for (i = 0; i < batch.count; i++) {
+		if (batch.priority[i] > bestPriority) {
+			best = (Unit *)batch.object[i];
+			bestPriority = batch.priority[i];
 		}
 	}
 
@@ -1408,6 +1511,7 @@ bool Unit_Move(Unit *unit, uint16 distance)
 
 			if (type == LST_WALL || type == LST_STRUCTURE || type == LST_ENTIRELY_MOUNTAIN) {
 				unit->o.position = newPosition;
+				Unit_UpdateDrawOrder(unit);
 
 				Map_MakeExplosion((ui->explosionType + unit->o.hitpoints / 10) & 3, unit->o.position, unit->o.hitpoints, unit->originEncoded);
 
@@ -1514,6 +1618,7 @@ bool Unit_Move(Unit *unit, uint16 distance)
 
 	unit->distanceToDestination = distance;
 	unit->o.position = newPosition;
+	Unit_UpdateDrawOrder(unit);
 
 	Unit_UpdateMap(1, unit);
 
@@ -2283,6 +2388,8 @@ static Structure *Unit_FindBestTargetStructure(Unit *unit, uint16 mode)
 	CellStruct position;
 	uint16 distance;
 	PoolFindStruct find;
+	TargetBatch batch;
+	uint16 i;
 
 	if (unit == NULL) return NULL;
 
@@ -2293,10 +2400,12 @@ static Structure *Unit_FindBestTargetStructure(Unit *unit, uint16 mode)
 	find.index   = 0xFFFF;
 	find.type    = 0xFFFF;
 
+	Unit_TargetBatch_Init(&batch, unit, 0);
+	batch.checkRange = false;
+
 	while (true) {
 		Structure *s;
 		CellStruct curPosition;
-		uint16 priority;
 
 		s = Structure_Find(&find);
 		if (s == NULL) break;
@@ -2314,11 +2423,16 @@ static Structure *Unit_FindBestTargetStructure(Unit *unit, uint16 mode)
 			}
 		}
 
-		priority = Unit_GetTargetStructurePriority(unit, s);
+		Unit_TargetBatch_AddStructure(&batch, unit, s);
+	}
 
-		if (priority >= bestPriority) {
-			best = s;
-			bestPriority = priority;
+	Unit_TargetBatch_Score(&batch);
+
+	/* On equal priority, the last candidate wins */
+	for (i = 0; i < batch.count; i++) {
+		if (batch.priority[i] >= bestPriority) {
+			best = (Structure *)batch.object[i];
+			bestPriority = batch.priority[i];
 		}
 	}
 
@@ -2565,21 +2679,17 @@ void Unit_AddToTile(Unit *unit, uint16 packed)
  */
 uint16 Unit_GetTargetStructurePriority(Unit *unit, Structure *target)
 {
-	const StructureInfo *si;
-	uint16 priority;
-	uint16 distance;
+	TargetBatch batch;
 
-	if (unit == NULL || target == NULL) return 0;
-
-	if (House_AreAllied(Unit_GetHouseID(unit), target->o.houseID)) return 0;
-	if ((target->o.seenByHouses & (1 << Unit_GetHouseID(unit))) == 0) return 0;
+	if (unit == NULL) return 0;
 
-	si = &g_table_structureInfo[target->o.type];
-	priority = si->o.priorityBuild + si->o.priorityTarget;
-	distance = Tile_GetDistanceRoundedUp(unit->o.position, target->o.position);
-	if (distance != 0) priority /= distance;
+	Unit_TargetBatch_Init(&batch, unit, 0);
+	batch.checkRange = false;
+	Unit_TargetBatch_AddStructure(&batch, unit, target);
+	if (batch.count == 0) return 0;
 
-	return min(priority, 32000);
+	Unit_TargetBatch_Score(&batch);
+	return batch.priority[0];
 }
 
 void Unit_LaunchHouseMissile(uint16 packed)
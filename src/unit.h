@@ -230,10 +230,6 @@ extern const uint16 g_table_actionsAI[4];
 extern const ActionInfo g_table_actionInfo[ACTION_MAX];
 extern UnitInfo g_table_unitInfo[UNIT_MAX];
 
-extern Unit *g_unitActive;
-extern Unit *g_unitHouseMissile;
-extern Unit *g_unitSelected;
-extern int16 g_starportAvailable[UNIT_MAX];
 
 extern uint16 g_dirtyUnitCount;
 extern uint16 g_dirtyAirUnitCount;
@@ -250,7 +246,7 @@ extern void Unit_SetAction(Unit *u, ActionType action);
 extern uint16 Unit_AddToTeam(Unit *u, struct Team *t);
 extern uint16 Unit_RemoveFromTeam(Unit *u);
 extern struct Team *Unit_GetTeam(Unit *u);
-extern void Unit_Sort(void);
+extern void Unit_CountVisible(uint16 *allied, uint16 *enemy);
 extern Unit *Unit_Get_ByPackedTile(uint16 packed);
 extern uint16 Unit_IsValidMovementIntoStructure(Unit *unit, struct Structure *s);
 extern void Unit_SetDestination(Unit *u, uint16 destination);
@@ -50,6 +50,7 @@
 #if defined(_MSC_VER) && (_MSC_VER <= 1500)
 /* MS Visual C++ 2008 doesn't include stdint.h */
 #include "types.h"
+typedef int32 int32_t;
 typedef uint32 uint32_t;
 typedef uint8 uint8_t;
 #else
@@ -15,6 +15,8 @@ extern void Video_Tick(void);
 extern void Video_SetPalette(void *palette, int from, int length);
 extern void Video_Mouse_SetPosition(uint16 x, uint16 y);
 extern void Video_Mouse_SetRegion(uint16 minX, uint16 maxX, uint16 minY, uint16 maxY);
+extern bool Video_Mouse_SetCursor(const uint8 *pixels, uint16 width, uint16 height, uint16 hotSpotX, uint16 hotSpotY);
+extern void Video_Mouse_ShowCursor(bool show);
 extern void Video_SetOffset(uint16 offset);
 
 #endif /* VIDEO_VIDEO_H */
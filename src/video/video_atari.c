@@ -14,6 +14,7 @@
 #include "../gfx.h"
 #include "../input/input.h"
 #include "../input/mouse.h"
+#include "../profile.h"
 #include "../os/error.h"
 
 /* ATARI IKBD doc : https://www.kernel.org/doc/Documentation/input/atarikbd.txt
@@ -206,10 +207,12 @@ void Video_Tick(void)
 		                   s_mouse_left_btn, s_mouse_right_btn);
 	}
 
+	Profile_Frame();
 	if (s_showFPS) {
 		Video_ShowFPS(data);
 	}
 
+	Profile_Section_Begin(PROFILE_SECTION_VIDEO);
 	data += (s_screenOffset << 2);
 	/* chunky to planar conversion */
 	if(s_machine_type == MCH_TT) {
@@ -217,6 +220,7 @@ void Video_Tick(void)
 	} else {
 		c2p1x1_8_falcon(screen, data, SCREEN_HEIGHT*SCREEN_WIDTH);
 	}
+	Profile_Section_End(PROFILE_SECTION_VIDEO);
 }
 
 /**
@@ -284,6 +288,30 @@ void Video_Mouse_SetRegion(uint16 minX, uint16 maxX, uint16 minY, uint16 maxY)
 	}
 }
 
+/**
+ * Let the video driver draw the mouse cursor. This driver cannot.
+ * @return Always false; the cursor is drawn in SCREEN_0 instead.
+ */
+bool Video_Mouse_SetCursor(const uint8 *pixels, uint16 width, uint16 height, uint16 hotSpotX, uint16 hotSpotY)
+{
+	VARIABLE_NOT_USED(pixels);
+	VARIABLE_NOT_USED(width);
+	VARIABLE_NOT_USED(height);
+	VARIABLE_NOT_USED(hotSpotX);
+	VARIABLE_NOT_USED(hotSpotY);
+
+	return false;
+}
+
+/**
+ * Show or hide the mouse cursor drawn by the video driver.
+ * @param show True to show the cursor.
+ */
+void Video_Mouse_ShowCursor(bool show)
+{
+	VARIABLE_NOT_USED(show);
+}
+
 /*
  * change the screen offset, equivalent to changing the
  * Start Address Register on a VGA card.
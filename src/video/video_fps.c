@@ -1,37 +1,119 @@
+/** @file src/video/video_fps.c display the frame profile in top right of the screen */
+
 #include "types.h"
-#include "../timer.h"
+#include "../profile.h"
 
 #include "video_fps.h"
 
-void Video_ShowFPS(uint8 *screen)
+#define FPS_CHAR_WIDTH  4                                   /*!< Width of a character including spacing. */
+#define FPS_CHAR_HEIGHT 6                                   /*!< Height of a character including spacing. */
+#define FPS_COLUMNS     22                                  /*!< Amount of characters on a line. */
+
+/* 3x5 font; every octal digit is a line of 3 pixels, from top to bottom */
+static const uint16 s_fontDigits[10] = {
+	075557, 026227, 071747, 071717, 055711, 074717, 074757, 071111, 075757, 075717
+};
+static const uint16 s_fontLetters[26] = {
+	025755, 065656, 034443, 065556, 074647, 074644, 034553, 055755, 072227, 011152, 055655, 044447, 057755,
+	065555, 025552, 065644, 025563, 065655, 034216, 072222, 055557, 055552, 055775, 055255, 055222, 071247
+};
+
+/* Label of every ProfileSection on the screen */
+static const char * const s_sectionLabels[PROFILE_SECTION_MAX] = {
+	"TEAM", "UNIT", "STRC", "HOUS", "SCRN", "VIEW", "SCAL", "FRAM"
+};
+
+/**
+ * Draw a line of text, padded to FPS_COLUMNS characters.
+ * @param screen The screen to draw on.
+ * @param x The left of the text.
+ * @param y The top of the text.
+ * @param text The text to draw: digits, capitals, dots and spaces.
+ */
+static void Video_FPS_DrawLine(uint8 *screen, int x, int y, const char *text)
 {
-	uint32 timeStamp;
-	static uint32 s_previousTimeStamps[16] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
-	static uint8 s_previousTimeStampsIndex = 0;
-
-	timeStamp = Timer_GetTime();
-	if(s_previousTimeStamps[s_previousTimeStampsIndex] > 0
-			&& timeStamp != s_previousTimeStamps[s_previousTimeStampsIndex]) {
-		int x, i;
-		/* calculate average frames per 1000sec on the 16 last time measures */
-		uint32 kfps = 16000000 / (timeStamp - s_previousTimeStamps[s_previousTimeStampsIndex]);
-		for(x = 320 - 4; kfps > 0; kfps /= 10, x -= 4) {
-			/* draw the digits */
-			static const uint8 fontdigits[10] = {0167,044,0135,0155,056,0153,0173,045,0177,0157};
-			static const uint8 fonttestsegments[15] = {03,01,05, 02,0,04, 032,010,054, 020,0,040, 0120,0100,0140};
-			uint8 segments = fontdigits[kfps % 10];
-			int offset = 0;
-			for(i=0; i<15; i++) {
-				screen[x+offset] = (segments & fonttestsegments[i]) ? 15 : 0;
-				offset++;
-				if((i % 3) == 2) {
-					screen[x+offset] = 0;
-					offset += 317;
-				}
+	int column;
+
+	for (column = 0; column < FPS_COLUMNS; column++, x += FPS_CHAR_WIDTH) {
+		uint16 glyph = 0;
+		int i, j;
+
+		if (*text >= '0' && *text <= '9') glyph = s_fontDigits[*text - '0'];
+		if (*text >= 'A' && *text <= 'Z') glyph = s_fontLetters[*text - 'A'];
+		if (*text == '.') glyph = 000002;
+		if (*text != '\0') text++;
+
+		for (j = 0; j < FPS_CHAR_HEIGHT; j++) {
+			uint8 *p = screen + (y + j) * 320 + x;
+			uint8 line = (j < 5) ? (glyph >> ((4 - j) * 3)) & 07 : 0;
+
+			for (i = 0; i < FPS_CHAR_WIDTH; i++) {
+				p[i] = (i < 3 && (line & (04 >> i)) != 0) ? 15 : 0;
 			}
 		}
-		for (i=0; i<5; i++) screen[x+2+i*320] = 0;
 	}
-	s_previousTimeStamps[s_previousTimeStampsIndex] = timeStamp;
-	s_previousTimeStampsIndex = (s_previousTimeStampsIndex + 1) & 0x0f;
+}
+
+/**
+ * Write a value as 5 characters: "dd.dd" below 100, "ddd.d" above.
+ * @param buffer Where to write the value to.
+ * @param value The value in hundredths.
+ */
+static void Video_FPS_FormatValue(char *buffer, uint32 value)
+{
+	int decimals = 2;
+	int i;
+
+	if (value >= 10000) {
+		value /= 10;
+		if (value > 9999) value = 9999;
+		decimals = 1;
+	}
+
+	for (i = 4; i >= 0; i--) {
+		if (i == 4 - decimals) {
+			buffer[i] = '.';
+			continue;
+		}
+		buffer[i] = (value == 0 && i < 3 - decimals) ? ' ' : '0' + value % 10;
+		value /= 10;
+	}
+}
+
+/**
+ * Draw the frame profile: the frames per second, and per section of the frame
+ *  the minimum, average and 99th percentile of the time it took in ms.
+ * @param screen The screen to draw on.
+ */
+void Video_ShowFPS(uint8 *screen)
+{
+	const int x = 320 - FPS_COLUMNS * FPS_CHAR_WIDTH;
+	ProfileStats stats;
+	char line[FPS_COLUMNS + 1];
+	int i;
+
+	for (i = 0; i < FPS_COLUMNS; i++) line[i] = ' ';
+	line[FPS_COLUMNS] = '\0';
+
+	line[0] = 'F'; line[1] = 'P'; line[2] = 'S';
+	if (Profile_GetStats(PROFILE_SECTION_FRAME, &stats) && stats.avg != 0) {
+		Video_FPS_FormatValue(line + 5, 100000000 / stats.avg);
+	}
+	Video_FPS_DrawLine(screen, x, 0, line);
+	Video_FPS_DrawLine(screen, x, FPS_CHAR_HEIGHT, "MS     MIN   AVG   P99");
+
+	for (i = 0; i < PROFILE_SECTION_MAX; i++) {
+		int j;
+
+		for (j = 0; j < FPS_COLUMNS; j++) line[j] = ' ';
+		for (j = 0; j < 4; j++) line[j] = s_sectionLabels[i][j];
+
+		if (Profile_GetStats((ProfileSection)i, &stats)) {
+			Video_FPS_FormatValue(line + 5,  stats.min / 10);
+			Video_FPS_FormatValue(line + 11, stats.avg / 10);
+			Video_FPS_FormatValue(line + 17, stats.p99 / 10);
+		}
+
+		Video_FPS_DrawLine(screen, x, (i + 2) * FPS_CHAR_HEIGHT, line);
+	}
 }
@@ -26,6 +26,7 @@
 #include "../input/input.h"
 #include "../input/mouse.h"
 #include "../opendune.h"
+#include "../profile.h"
 
 #include "video_fps.h"
 #include "scalebit.h"
@@ -250,7 +251,9 @@ bool Video_Init(int screen_magnification, VideoScaleFilter filter)
 	s_scale_filter = filter;
 	s_screen_magnification = screen_magnification;
 	if (filter == FILTER_HQX) {
+		Profile_Begin("hqxInit");
 		hqxInit();
+		Profile_End();
 	}
 
 	if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -485,6 +488,7 @@ void Video_Tick(void)
 	if (s_video_lock) return;
 	s_video_lock = true;
 
+	Profile_Frame();
 	if (s_showFPS) {
 		Video_ShowFPS(Get_Page(SCREEN_0));
 	}
@@ -572,7 +576,9 @@ void Video_Tick(void)
 	}
 	memcpy(s_gfx_screen8, Get_Page(SCREEN_0), SCREEN_WIDTH * SCREEN_HEIGHT);
 
+	Profile_Section_Begin(PROFILE_SECTION_VIDEO);
 	Video_DrawScreen();
+	Profile_Section_End(PROFILE_SECTION_VIDEO);
 
 	SDL_UpdateRect(s_gfx_surface, 0, 0, 0, 0);
 	s_screen_needrepaint = false;
@@ -616,6 +622,30 @@ void Video_SetPalette(void *palette, int from, int length)
 	s_video_lock = false;
 }
 
+/**
+ * Let the video driver draw the mouse cursor. This driver cannot.
+ * @return Always false; the cursor is drawn in SCREEN_0 instead.
+ */
+bool Video_Mouse_SetCursor(const uint8 *pixels, uint16 width, uint16 height, uint16 hotSpotX, uint16 hotSpotY)
+{
+	VARIABLE_NOT_USED(pixels);
+	VARIABLE_NOT_USED(width);
+	VARIABLE_NOT_USED(height);
+	VARIABLE_NOT_USED(hotSpotX);
+	VARIABLE_NOT_USED(hotSpotY);
+
+	return false;
+}
+
+/**
+ * Show or hide the mouse cursor drawn by the video driver.
+ * @param show True to show the cursor.
+ */
+void Video_Mouse_ShowCursor(bool show)
+{
+	VARIABLE_NOT_USED(show);
+}
+
 /*
  * change the screen offset, equivalent to changing the
  * Start Address Register on a VGA card.
@@ -12,6 +12,7 @@
 #include "../input/input.h"
 #include "../input/mouse.h"
 #include "../opendune.h"
+#include "../profile.h"
 
 #include "video_fps.h"
 #include "scalebit.h"
@@ -56,6 +57,15 @@ static uint16 s_mouseMaxY = 0;
 
 static uint16 s_screenOffset = 0;	/* VGA Start Address Register */
 
+static SDL_Texture *s_cursorTexture = NULL;	/* mouse cursor drawn over the screen, if the driver draws it */
+static uint8 *s_cursorPixels = NULL;	/* palette indexes of the mouse cursor, 0 is transparent */
+static uint16 s_cursorWidth = 0;
+static uint16 s_cursorHeight = 0;
+static uint16 s_cursorHotSpotX = 0;
+static uint16 s_cursorHotSpotY = 0;
+static bool s_cursorVisible = false;
+static bool s_cursorDirty = false;	/* s_cursorTexture has to be redone from s_cursorPixels and s_palette */
+
 /* Partly copied from http://webster.cs.ucr.edu/AoA/DOS/pdf/apndxc.pdf */
 static const uint8 s_SDL_keymap[] = {
            0,    0,    0,    0,    0,    0,    0,    0, 0x0E, 0x0F,    0,    0,    0, 0x1C,    0,    0, /*  0x00 -  0x0F */
@@ -214,6 +224,120 @@ void Video_Mouse_SetRegion(uint16 minX, uint16 maxX, uint16 minY, uint16 maxY)
 	}
 }
 
+/**
+ * Let the video driver draw the mouse cursor over the screen, instead of the
+ *  game drawing it in SCREEN_0.
+ * @param pixels The palette indexes of the cursor, 0 is transparent.
+ * @param width The width of the cursor.
+ * @param height The height of the cursor.
+ * @param hotSpotX The X-position in the cursor that points at the mouse position.
+ * @param hotSpotY The Y-position in the cursor that points at the mouse position.
+ * @return True if the driver draws the cursor.
+ */
+bool Video_Mouse_SetCursor(const uint8 *pixels, uint16 width, uint16 height, uint16 hotSpotX, uint16 hotSpotY)
+{
+	if (!s_video_initialized) return false;
+
+	s_video_lock = true;
+
+	if (s_cursorTexture == NULL || width != s_cursorWidth || height != s_cursorHeight) {
+		uint8 *cursorPixels;
+
+		if (s_cursorTexture != NULL) SDL_DestroyTexture(s_cursorTexture);
+		s_cursorTexture = NULL;
+		s_cursorWidth = 0;
+		s_cursorHeight = 0;
+
+		cursorPixels = (width == 0 || height == 0) ? NULL : realloc(s_cursorPixels, width * height);
+		if (cursorPixels != NULL) {
+			s_cursorPixels = cursorPixels;
+
+			s_cursorTexture = SDL_CreateTexture(s_renderer,
+					SDL_PIXELFORMAT_ARGB8888,
+					SDL_TEXTUREACCESS_STREAMING,
+					width, height);
+
+			if (s_cursorTexture == NULL) {
+				Warning("Could not create cursor texture: %s\n", SDL_GetError());
+			} else {
+				SDL_SetTextureBlendMode(s_cursorTexture, SDL_BLENDMODE_BLEND);
+			}
+		}
+
+		if (s_cursorTexture == NULL) {
+			s_video_lock = false;
+			return false;
+		}
+	}
+
+	memcpy(s_cursorPixels, pixels, width * height);
+	s_cursorWidth = width;
+	s_cursorHeight = height;
+	s_cursorHotSpotX = hotSpotX;
+	s_cursorHotSpotY = hotSpotY;
+	s_cursorDirty = true;
+
+	s_video_lock = false;
+
+	return true;
+}
+
+/**
+ * Show or hide the mouse cursor drawn by the video driver.
+ * @param show True to show the cursor.
+ */
+void Video_Mouse_ShowCursor(bool show)
+{
+	s_cursorVisible = show;
+}
+
+/**
+ * Draw the mouse cursor over the screen, at the position the game has for
+ *  the mouse.
+ */
+static void Video_Mouse_DrawCursor(void)
+{
+	SDL_Rect dst;
+	int scale;
+
+	if (s_cursorTexture == NULL || !s_cursorVisible) return;
+
+	if (s_cursorDirty) {
+		const uint8 *src = s_cursorPixels;
+		uint8 *pixels;
+		int pitch;
+		int x, y;
+		uint32 *p;
+
+		if (SDL_LockTexture(s_cursorTexture, NULL, (void **)&pixels, &pitch) != 0) {
+			Error("Could not set lock texture: %s\n", SDL_GetError());
+			return;
+		}
+		for (y = 0; y < s_cursorHeight; y++) {
+			p = (uint32 *)pixels;
+			for (x = 0; x < s_cursorWidth; x++) {
+				*p++ = (*src == 0) ? 0 : s_palette[*src];
+				src++;
+			}
+			pixels += pitch;
+		}
+		SDL_UnlockTexture(s_cursorTexture);
+
+		s_cursorDirty = false;
+	}
+
+	scale = (s_scale_filter == FILTER_NEAREST_NEIGHBOR) ? 1 : s_screen_magnification;
+
+	dst.x = ((int)g_mouseX - s_cursorHotSpotX) * scale;
+	dst.y = ((int)g_mouseY - s_cursorHotSpotY) * scale;
+	dst.w = s_cursorWidth * scale;
+	dst.h = s_cursorHeight * scale;
+
+	if (SDL_RenderCopy(s_renderer, s_cursorTexture, NULL, &dst)) {
+		Error("SDL_RenderCopy failed : %s\n", SDL_GetError());
+	}
+}
+
 /**
  * Initialize the video driver.
  */
@@ -233,7 +357,9 @@ bool Video_Init(int screen_magnification, VideoScaleFilter filter)
 	s_scale_filter = filter;
 	s_screen_magnification = screen_magnification;
 	if (filter == FILTER_HQX) {
+		Profile_Begin("hqxInit");
 		hqxInit();
+		Profile_End();
 	}
 
 	err = SDL_Init(SDL_INIT_VIDEO);
@@ -322,6 +448,14 @@ void Video_Uninit(void)
 		s_fullsize_buffer = NULL;
 	}
 
+	if (s_cursorTexture) {
+		SDL_DestroyTexture(s_cursorTexture);
+		s_cursorTexture = NULL;
+	}
+
+	free(s_cursorPixels);
+	s_cursorPixels = NULL;
+
 	if (s_texture) {
 		SDL_DestroyTexture(s_texture);
 		s_texture = NULL;
@@ -470,6 +604,7 @@ void Video_Tick(void)
 
 	s_video_lock = true;
 
+	Profile_Frame();
 	if (s_showFPS) {
 		Video_ShowFPS(Get_Page(SCREEN_0));
 	}
@@ -534,7 +669,10 @@ void Video_Tick(void)
 		}
 	}
 
+	Profile_Section_Begin(PROFILE_SECTION_VIDEO);
 	Video_DrawScreen();
+	Video_Mouse_DrawCursor();
+	Profile_Section_End(PROFILE_SECTION_VIDEO);
 	SDL_RenderPresent(s_renderer);
 
 	s_video_lock = false;
@@ -560,6 +698,7 @@ void Video_SetPalette(void *palette, int from, int length)
 		             |  (((p[2] & 0x3F) * 0x41) >> 4); /* b */
 		p += 3;
 	}
+	s_cursorDirty = true;
 
 	s_video_lock = false;
 }
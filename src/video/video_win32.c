@@ -14,6 +14,7 @@
 
 #include "../gfx.h"
 #include "../opendune.h"
+#include "../profile.h"
 #include "../input/input.h"
 #include "../input/mouse.h"
 
@@ -250,9 +251,11 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM l
 			HBITMAP old_bmp;
 
 			if (!GetUpdateRect(hwnd, NULL, FALSE)) return 0;
+			Profile_Frame();
 			if (s_showFPS) {
 				Video_ShowFPS(s_screen);
 			}
+			Profile_Section_Begin(PROFILE_SECTION_VIDEO);
 			if (s_scale_filter == FILTER_SCALE2X) {
 				scale(s_screen_magnification, s_screen2, s_screen_magnification * SCREEN_WIDTH, s_screen, SCREEN_WIDTH, 1, SCREEN_WIDTH, SCREEN_HEIGHT);
 			} else if(s_scale_filter == FILTER_HQX) {
@@ -285,6 +288,7 @@ static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM l
 			SelectObject(dc2, old_bmp);
 			DeleteDC(dc2);
 			EndPaint(hwnd, &ps);
+			Profile_Section_End(PROFILE_SECTION_VIDEO);
 			return 0;
 		}
 
@@ -433,7 +437,9 @@ bool Video_Init(int screen_magnification, VideoScaleFilter filter)
 	s_scale_filter = filter;
 
 	if (filter == FILTER_HQX) {
+		Profile_Begin("hqxInit");
 		hqxInit();
+		Profile_End();
 	}
 
 	hInstance = GetModuleHandle(NULL);
@@ -735,6 +741,30 @@ void Video_Mouse_SetRegion(uint16 minX, uint16 maxX, uint16 minY, uint16 maxY)
 	s_mouseMaxY = maxY * s_screen_magnification;
 }
 
+/**
+ * Let the video driver draw the mouse cursor. This driver cannot.
+ * @return Always false; the cursor is drawn in SCREEN_0 instead.
+ */
+bool Video_Mouse_SetCursor(const uint8 *pixels, uint16 width, uint16 height, uint16 hotSpotX, uint16 hotSpotY)
+{
+	VARIABLE_NOT_USED(pixels);
+	VARIABLE_NOT_USED(width);
+	VARIABLE_NOT_USED(height);
+	VARIABLE_NOT_USED(hotSpotX);
+	VARIABLE_NOT_USED(hotSpotY);
+
+	return false;
+}
+
+/**
+ * Show or hide the mouse cursor drawn by the video driver.
+ * @param show True to show the cursor.
+ */
+void Video_Mouse_ShowCursor(bool show)
+{
+	VARIABLE_NOT_USED(show);
+}
+
 /*
  * change the screen offset, equivalent to changing the
  * Start Address Register on a VGA card.